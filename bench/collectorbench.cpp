@@ -0,0 +1,304 @@
+// Times each SystemMonitor collector and counts its heap allocations against
+// synthetic /proc trees of increasing size, or against an existing tree.
+// With --replay it instead runs every tick of a capture file through the
+// collectors and the wire encoder as fast as possible.
+//
+//   collector_bench [--sizes 1000,10000,100000] [--iterations N]
+//                   [--proc-root dir --sys-root dir] [--keep dir] [--json out.json]
+//   collector_bench --replay capture.syscap [--json out.json]
+//
+// Allocations are counted by interposing malloc/calloc/realloc and the
+// aligned allocators, so they include Qt containers as well as operator new.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <atomic>
+#include <cerrno>
+#include <functional>
+#include "common/latencyhistogram.h"
+#include "common/wireprotocol.h"
+#include "core/systemmonitor.h"
+#include "procfixture.h"
+
+namespace {
+
+std::atomic<quint64> g_allocations{0};
+std::atomic<quint64> g_allocatedBytes{0};
+
+}
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(count * size, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+// Aligned allocations all go through __libc_memalign, so they are counted
+// once and freed by the free() above.
+void *memalign(size_t alignment, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void *result = memalign(alignment, size);
+    if (!result && size != 0) return ENOMEM;
+    *ptr = result;
+    return 0;
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+}
+#endif
+
+namespace {
+
+struct Target
+{
+    QString label;
+    QString procRoot;
+    QString sysRoot;
+};
+
+struct CollectorResult
+{
+    QString name;
+    LatencyHistogram time;
+    quint64 allocations = 0;
+    quint64 allocatedBytes = 0;
+    int calls = 0;
+};
+
+CollectorResult makeResult(const QString &name)
+{
+    CollectorResult result;
+    result.name = name;
+    return result;
+}
+
+// Time and allocations from construction to addTo().
+class Measurement
+{
+public:
+    Measurement()
+        : m_allocations(g_allocations.load(std::memory_order_relaxed)),
+          m_allocatedBytes(g_allocatedBytes.load(std::memory_order_relaxed))
+    {
+        m_timer.start();
+    }
+
+    void addTo(CollectorResult &result) const
+    {
+        result.time.record(m_timer.nsecsElapsed());
+        result.allocations += g_allocations.load(std::memory_order_relaxed) - m_allocations;
+        result.allocatedBytes += g_allocatedBytes.load(std::memory_order_relaxed) - m_allocatedBytes;
+        ++result.calls;
+    }
+
+private:
+    QElapsedTimer m_timer;
+    quint64 m_allocations;
+    quint64 m_allocatedBytes;
+};
+
+template <typename Function>
+auto timed(CollectorResult &result, Function function)
+{
+    const Measurement measurement;
+    auto value = function();
+    measurement.addTo(result);
+    return value;
+}
+
+QList<CollectorResult> runCollectors(SystemMonitor &monitor, int iterations)
+{
+    const QList<QPair<QString, std::function<void()>>> collectors = {
+        {"cpu", [&monitor]() { monitor.readCpuUsage(); }},
+        {"memory", [&monitor]() { monitor.readMemoryUsage(); }},
+        {"network", [&monitor]() { monitor.readNetworkUsage(); }},
+        {"disk stats", [&monitor]() { monitor.readDiskStats(); }},
+        {"mounts", [&monitor]() { monitor.readMounts(); }},
+        {"cgroups", [&monitor]() { monitor.readCgroups(); }},
+        {"sensors", [&monitor]() { monitor.readSensors(); }},
+        {"processes", [&monitor]() { monitor.readProcessList(); }},
+        {"sockets", [&monitor]() { monitor.readSockets(); }},
+        {"full tick", [&monitor]() { monitor.readDynamicData(); }},
+    };
+    QList<CollectorResult> results;
+    for (const auto &collector : collectors) {
+        CollectorResult result = makeResult(collector.first);
+        // Each call gets a frame of its own, as in a tick, so the rate paths
+        // see a timestamp; frames are at least 1 ms apart so rates have an
+        // interval. readDynamicData() brackets itself.
+        const bool framed = collector.first != "full tick";
+        auto call = [&](bool measure) {
+            QThread::msleep(1);
+            if (framed) monitor.beginFrame();
+            if (measure) timed(result, [&collector]() { collector.second(); return true; });
+            else collector.second();
+            if (framed) monitor.endFrame();
+        };
+        call(false); // warm-up: first-tick state, buffer growth, name decoding
+        for (int i = 0; i < iterations; ++i) call(true);
+        results.append(result);
+    }
+    return results;
+}
+
+// Every recorded tick through the parsers and the agent encoder.
+QList<CollectorResult> runReplay(SystemMonitor &monitor, qint64 *wireBytes)
+{
+    CollectorResult parse = makeResult("tick parse");
+    CollectorResult encode = makeResult("wire encode");
+    WireEncoder encoder;
+    monitor.readStaticData();
+    for (;;) {
+        const Measurement measurement;
+        // The final call finds no frame left; it is not a tick.
+        if (!monitor.readDynamicData()) break;
+        measurement.addTo(parse);
+        const SystemData data = monitor.getSystemData();
+        *wireBytes += timed(encode, [&encoder, &data]() { return encoder.encodeDelta(data); }).size();
+    }
+    return {parse, encode};
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma-separated process counts for synthetic trees.", "list", "1000,10000,100000");
+    QCommandLineOption iterationsOption("iterations", "Calls per collector.", "n", "20");
+    QCommandLineOption procRootOption("proc-root", "Benchmark an existing procfs tree instead.", "dir");
+    QCommandLineOption sysRootOption("sys-root", "sysfs root to use with --proc-root.", "dir", "/sys");
+    QCommandLineOption keepOption("keep", "Generate the synthetic trees under this directory and keep them.", "dir");
+    QCommandLineOption replayOption("replay", "Replay a capture file through the collectors instead.", "file");
+    QCommandLineOption jsonOption("json", "Write the results to this file.", "file");
+    parser.addOptions({sizesOption, iterationsOption, procRootOption, sysRootOption, keepOption, replayOption, jsonOption});
+    parser.process(app);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    QList<Target> targets;
+    QTemporaryDir tempDir;
+    if (parser.isSet(replayOption)) {
+        targets.append({parser.value(replayOption), QString(), QString()});
+    } else if (parser.isSet(procRootOption)) {
+        targets.append({parser.value(procRootOption), parser.value(procRootOption), parser.value(sysRootOption)});
+    } else {
+        const QString base = parser.isSet(keepOption) ? parser.value(keepOption) : tempDir.path();
+        for (const QString &size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+            ProcFixtureSpec spec;
+            spec.processes = size.toInt();
+            const QString root = QString("%1/procs-%2").arg(base).arg(spec.processes);
+            QString error;
+            QElapsedTimer timer;
+            timer.start();
+            if (!writeProcFixture(root, spec, &error)) {
+                qCritical("Could not generate fixture: %s", qPrintable(error));
+                return 1;
+            }
+            qInfo("generated %d processes in %lld ms", spec.processes, timer.elapsed());
+            targets.append({QString("%1 processes").arg(spec.processes), root + "/proc", root + "/sys"});
+        }
+    }
+
+    QTextStream out(stdout);
+    QJsonArray json;
+    auto us = [](quint64 ns) { return QString::number(ns / 1e3, 'f', 1); };
+    for (const Target &target : targets) {
+        QList<CollectorResult> results;
+        if (parser.isSet(replayOption)) {
+            SystemMonitor monitor;
+            QString error;
+            if (!monitor.startReplay(target.label, SystemMonitor::MaximumSpeed, &error)) {
+                qCritical("%s", qPrintable(error));
+                return 1;
+            }
+            qint64 wireBytes = 0;
+            results = runReplay(monitor, &wireBytes);
+            out << "\n" << target.label << " (" << results.first().calls << " ticks, "
+                << (results.first().calls ? wireBytes / results.first().calls : 0) << " wire bytes/tick)\n";
+        } else {
+            SystemMonitor monitor(target.procRoot, target.sysRoot);
+            results = runCollectors(monitor, iterations);
+            out << "\n" << target.label << " (" << monitor.getSystemData().processes.size() << " parsed)\n";
+        }
+        out << QString("%1 %2 %3 %4 %5 %6\n").arg("collector", -12).arg("p50 us", 12).arg("p99 us", 12)
+                   .arg("max us", 12).arg("allocs/call", 12).arg("bytes/call", 12);
+        QJsonArray collectors;
+        for (const CollectorResult &result : results) {
+            const double allocationsPerCall = double(result.allocations) / result.calls;
+            const double bytesPerCall = double(result.allocatedBytes) / result.calls;
+            out << QString("%1 %2 %3 %4 %5 %6\n").arg(result.name, -12).arg(us(result.time.percentile(50)), 12)
+                       .arg(us(result.time.percentile(99)), 12).arg(us(result.time.max()), 12)
+                       .arg(allocationsPerCall, 12, 'f', 1).arg(bytesPerCall, 12, 'f', 0);
+            QJsonObject entry = result.time.toJson();
+            entry["name"] = result.name;
+            entry["allocations_per_call"] = allocationsPerCall;
+            entry["bytes_per_call"] = bytesPerCall;
+            collectors.append(entry);
+        }
+        out.flush();
+        QJsonObject targetJson;
+        targetJson["target"] = target.label;
+        targetJson["collectors"] = collectors;
+        json.append(targetJson);
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Could not write %s", qPrintable(parser.value(jsonOption)));
+            return 1;
+        }
+        file.write(QJsonDocument(json).toJson());
+    }
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Replays recorded copilot conversations against a local mock Gemini endpoint
+// and reports per-stage latency percentiles.
+//
+//   copilot_bench [--conversations file.json] [--iterations N]
+//                 [--processes N] [--server-delay-ms N] [--json out.json]
+//
+// A conversation file is a JSON array of {"user": "...", "responses": [...]}
+// objects, where each response is a raw generateContent reply body served in
+// order for that conversation.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include "copilot.h"
+
+namespace {
+
+class MockEndpoint : public QObject
+{
+public:
+    explicit MockEndpoint(int delayMs, QObject *parent = nullptr)
+        : QObject(parent), m_delayMs(delayMs)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+                connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+                    m_buffers.remove(socket);
+                    socket->deleteLater();
+                });
+            }
+        });
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost, 0); }
+    quint16 port() const { return m_server.serverPort(); }
+    void setResponses(const QList<QByteArray> &responses) { m_queue = responses; }
+
+private:
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        for (;;) {
+            const int headerEnd = buffer.indexOf("\r\n\r\n");
+            if (headerEnd < 0) return;
+            int contentLength = 0;
+            const QList<QByteArray> headers = buffer.left(headerEnd).split('\n');
+            for (const QByteArray &header : headers) {
+                if (header.toLower().startsWith("content-length:"))
+                    contentLength = header.mid(15).trimmed().toInt();
+            }
+            const int total = headerEnd + 4 + contentLength;
+            if (buffer.size() < total) return;
+            buffer.remove(0, total);
+            respond(socket);
+        }
+    }
+
+    void respond(QTcpSocket *socket)
+    {
+        QByteArray body = m_queue.isEmpty()
+            ? QByteArray(R"({"candidates":[{"content":{"parts":[{"text":"(mock exhausted)"}]}}]})")
+            : m_queue.takeFirst();
+        QByteArray response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: keep-alive\r\n";
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+        if (m_delayMs > 0) {
+            QTimer::singleShot(m_delayMs, socket, [socket, response]() { socket->write(response); });
+        } else {
+            socket->write(response);
+        }
+    }
+
+    QTcpServer m_server;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QList<QByteArray> m_queue;
+    int m_delayMs;
+};
+
+struct Conversation
+{
+    QString user;
+    QList<QByteArray> responses;
+};
+
+QByteArray textReply(const QString &text)
+{
+    QJsonObject part; part["text"] = text;
+    QJsonObject content; content["role"] = "model"; content["parts"] = QJsonArray({part});
+    QJsonObject candidate; candidate["content"] = content;
+    QJsonObject root; root["candidates"] = QJsonArray({candidate});
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QByteArray toolCallReply(const QString &name, const QJsonObject &args)
+{
+    QJsonObject call; call["name"] = name; call["args"] = args;
+    QJsonObject part; part["functionCall"] = call;
+    QJsonObject content; content["role"] = "model"; content["parts"] = QJsonArray({part});
+    QJsonObject candidate; candidate["content"] = content;
+    QJsonObject root; root["candidates"] = QJsonArray({candidate});
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QList<Conversation> builtinConversations()
+{
+    QJsonObject findArgs; findArgs["name"] = "proc-17";
+    return {
+        {"Hello", {textReply("Hi! How can I help with your system?")}},
+        {"What is using the most memory?",
+         {toolCallReply("getSystemInfo", QJsonObject()), textReply("proc-42 is using the most memory.")}},
+        {"What is the PID of proc-17?",
+         {toolCallReply("findProcessPid", findArgs), textReply("proc-17 has PID 1017.")}},
+    };
+}
+
+// Replayed calls go through the real tool dispatch: these would signal real
+// processes (the synthetic pids may exist on this host) or block on a
+// confirmation dialog, so scripts that call them are refused.
+bool isUnsafeTool(const QString &name)
+{
+    return name == "run_shell_command" || name == "killProcess" || name == "stopProcess" || name == "resumeProcess";
+}
+
+bool loadConversations(const QString &path, QList<Conversation> *out, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    QJsonArray array = doc.isArray() ? doc.array() : doc.object()["conversations"].toArray();
+    for (const QJsonValue &value : array) {
+        QJsonObject obj = value.toObject();
+        Conversation c;
+        c.user = obj["user"].toString();
+        for (const QJsonValue &response : obj["responses"].toArray()) {
+            for (const QJsonValue &candidate : response.toObject()["candidates"].toArray()) {
+                for (const QJsonValue &part : candidate.toObject()["content"].toObject()["parts"].toArray()) {
+                    const QString tool = part.toObject()["functionCall"].toObject()["name"].toString();
+                    if (isUnsafeTool(tool)) {
+                        *error = QString("\"%1\" calls %2, which is not replayed").arg(c.user, tool);
+                        return false;
+                    }
+                }
+            }
+            c.responses.append(QJsonDocument(response.toObject()).toJson(QJsonDocument::Compact));
+        }
+        out->append(c);
+    }
+    if (out->isEmpty()) *error = "no conversations";
+    return !out->isEmpty();
+}
+
+SystemData syntheticSystemData(int processCount)
+{
+    SystemData data;
+    data.hostname = "bench-host";
+    data.kernelVersion = "Linux version 6.0.0-bench";
+    data.cpuModel = "Synthetic CPU";
+    data.totalSystemMemoryMB = 65536;
+    data.cpuPercentage = 42.0;
+    data.memPercentage = 61.5;
+    data.diskPercentage = 70.1;
+    data.netDownSpeed_KBps = 1234.5;
+    data.netUpSpeed_KBps = 321.0;
+    for (int i = 0; i < processCount; ++i) {
+        ProcessData p;
+        p.pid = 1000 + i;
+        p.name = QString("proc-%1").arg(i);
+        p.memUsageMB = (i % 97) * 10.5;
+        data.processes.append(p);
+    }
+    return data;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption conversationsOption("conversations", "Recorded conversations (JSON).", "file");
+    QCommandLineOption iterationsOption("iterations", "Replays of the whole set.", "n", "50");
+    QCommandLineOption processesOption("processes", "Processes in the synthetic system snapshot.", "n", "300");
+    QCommandLineOption delayOption("server-delay-ms", "Artificial mock server latency.", "ms", "0");
+    QCommandLineOption jsonOption("json", "Write the latency histograms to this file.", "file");
+    parser.addOptions({conversationsOption, iterationsOption, processesOption, delayOption, jsonOption});
+    parser.process(app);
+
+    QList<Conversation> conversations;
+    if (parser.isSet(conversationsOption)) {
+        QString error;
+        if (!loadConversations(parser.value(conversationsOption), &conversations, &error)) {
+            qCritical("Could not load conversations from %s: %s", qPrintable(parser.value(conversationsOption)), qPrintable(error));
+            return 1;
+        }
+    } else {
+        conversations = builtinConversations();
+    }
+
+    MockEndpoint endpoint(parser.value(delayOption).toInt());
+    if (!endpoint.listen()) {
+        qCritical("Could not start the mock endpoint");
+        return 1;
+    }
+
+    Copilot copilot;
+    copilot.setEndpoint(QUrl(QString("http://127.0.0.1:%1/v1beta/models/mock:generateContent").arg(endpoint.port())));
+    copilot.onSystemDataUpdated(syntheticSystemData(parser.value(processesOption).toInt()));
+
+    const int iterations = parser.value(iterationsOption).toInt();
+    for (int i = 0; i < iterations; ++i) {
+        for (const Conversation &conversation : conversations) {
+            copilot.resetConversation();
+            endpoint.setResponses(conversation.responses);
+            QEventLoop loop;
+            bool done = false;
+            QMetaObject::Connection connection = QObject::connect(&copilot, &Copilot::turnFinished, &loop, [&]() {
+                done = true;
+                loop.quit();
+            });
+            copilot.sendMessage(conversation.user);
+            if (!done) loop.exec();
+            QObject::disconnect(connection);
+        }
+    }
+
+    QTextStream out(stdout);
+    const CopilotLatency &latency = copilot.latency();
+    auto ms = [](quint64 ns) { return QString::number(ns / 1e6, 'f', 3); };
+    out << QString("%1 %2 %3 %4 %5\n").arg("stage", -16).arg("count", 8).arg("p50 ms", 10).arg("p99 ms", 10).arg("max ms", 10);
+    for (int i = 0; i < CopilotLatency::StageCount; ++i) {
+        const auto stage = static_cast<CopilotLatency::Stage>(i);
+        const LatencyHistogram &h = latency.stage(stage);
+        out << QString("%1 %2 %3 %4 %5\n").arg(CopilotLatency::stageName(stage), -16).arg(h.count(), 8)
+                   .arg(ms(h.percentile(50)), 10).arg(ms(h.percentile(99)), 10).arg(ms(h.max()), 10);
+    }
+    for (auto it = latency.tools().constBegin(); it != latency.tools().constEnd(); ++it) {
+        out << QString("%1 %2 %3 %4 %5\n").arg("tool:" + it.key(), -16).arg(it.value().count(), 8)
+                   .arg(ms(it.value().percentile(50)), 10).arg(ms(it.value().percentile(99)), 10).arg(ms(it.value().max()), 10);
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Could not write %s", qPrintable(parser.value(jsonOption)));
+            return 1;
+        }
+        file.write(QJsonDocument(latency.toJson()).toJson());
+    }
+    return 0;
+}
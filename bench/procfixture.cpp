@@ -0,0 +1,297 @@
+#include "procfixture.h"
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+
+namespace {
+
+const char *const kProcessNames[] = {
+    "systemd", "kworker/0:1", "sshd", "nginx", "postgres", "java", "python3",
+    "node", "containerd-shim", "chrome", "Web Content", "bash", "rsyslogd", "redis-server",
+};
+
+bool writeFile(const QString &path, const QByteArray &contents, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size()) {
+        *error = QString("%1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool makeDir(const QString &path, QString *error)
+{
+    if (QDir().mkpath(path)) return true;
+    *error = QString("%1: cannot create directory").arg(path);
+    return false;
+}
+
+QByteArray statFile(const ProcFixtureSpec &spec, QRandomGenerator &random)
+{
+    auto cpuLine = [&random](const QByteArray &label, int scale) {
+        const quint64 user = random.bounded(1000000) * scale, nice = random.bounded(1000) * scale;
+        const quint64 system = random.bounded(300000) * scale, idle = random.bounded(10000000) * scale;
+        const quint64 iowait = random.bounded(5000) * scale, irq = 0, softirq = random.bounded(2000) * scale;
+        return label + QString::asprintf(" %llu %llu %llu %llu %llu %llu %llu 0 0 0\n",
+                                         user, nice, system, idle, iowait, irq, softirq).toUtf8();
+    };
+    QByteArray out = cpuLine("cpu ", spec.cpus);
+    for (int cpu = 0; cpu < spec.cpus; ++cpu) out += cpuLine("cpu" + QByteArray::number(cpu), 1);
+    out += "intr 123456789 0 9 0 0 0 0 0 0 0 0 0\n";
+    out += "ctxt 987654321\nbtime 1700000000\n";
+    out += "processes " + QByteArray::number(spec.processes * 4) + "\n";
+    out += "procs_running 3\nprocs_blocked 0\nsoftirq 12345 0 1 2 3 4 5 6 7 8 9\n";
+    return out;
+}
+
+QByteArray meminfoFile()
+{
+    static const char *const lines[] = {
+        "MemTotal:       32768000 kB", "MemFree:         4096000 kB", "MemAvailable:   16384000 kB",
+        "Buffers:          512000 kB", "Cached:          9000000 kB", "SwapCached:            0 kB",
+        "Active:         12000000 kB", "Inactive:        8000000 kB", "Active(anon):    7000000 kB",
+        "Inactive(anon):   100000 kB", "Active(file):    5000000 kB", "Inactive(file):  7900000 kB",
+        "Unevictable:       64000 kB", "Mlocked:               0 kB", "SwapTotal:       8388604 kB",
+        "SwapFree:        8388604 kB", "Dirty:               512 kB", "Writeback:             0 kB",
+        "AnonPages:       7100000 kB", "Mapped:          1200000 kB", "Shmem:            400000 kB",
+        "KReclaimable:     600000 kB", "Slab:             900000 kB", "SReclaimable:     600000 kB",
+        "SUnreclaim:       300000 kB", "KernelStack:       20000 kB", "PageTables:        60000 kB",
+        "CommitLimit:    24772604 kB", "Committed_AS:   20000000 kB", "VmallocTotal:   34359738367 kB",
+        "VmallocUsed:       80000 kB", "Percpu:             9000 kB", "HugePages_Total:       0",
+        "HugePages_Free:        0", "Hugepagesize:       2048 kB", "DirectMap4k:      500000 kB",
+        "DirectMap2M:    20000000 kB", "DirectMap1G:    13000000 kB",
+    };
+    QByteArray out;
+    for (const char *line : lines) out += QByteArray(line) + "\n";
+    return out;
+}
+
+QByteArray netDevFile(const ProcFixtureSpec &spec, QRandomGenerator &random)
+{
+    QByteArray out = "Inter-|   Receive                                                |  Transmit\n"
+                     " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n";
+    auto line = [&random](const QByteArray &name) {
+        const quint64 rxBytes = random.generate64() % 100000000000ULL, txBytes = random.generate64() % 10000000000ULL;
+        return QString::asprintf("%6s: %llu %llu 0 0 0 0 0 0 %llu %llu 0 0 0 0 0 0\n", name.constData(),
+                                 rxBytes, rxBytes / 900, txBytes, txBytes / 900).toUtf8();
+    };
+    out += line("lo");
+    for (int i = 0; i < spec.interfaces; ++i) out += line("eth" + QByteArray::number(i));
+    return out;
+}
+
+QByteArray diskName(int disk)
+{
+    return "sd" + QByteArray(1, char('a' + disk % 26)) + (disk >= 26 ? QByteArray::number(disk / 26) : QByteArray());
+}
+
+QByteArray diskstatsFile(const ProcFixtureSpec &spec, QRandomGenerator &random)
+{
+    QByteArray out;
+    auto line = [&random, &out](int major, int minor, const QByteArray &name) {
+        const quint64 reads = random.bounded(10000000u), writes = random.bounded(10000000u);
+        out += QString::asprintf("%4d %7d %s %llu %llu %llu %llu %llu %llu %llu %llu 0 %llu %llu 0 0 0 0 0 0\n",
+                                 major, minor, name.constData(), reads, reads / 10, reads * 16, reads / 4,
+                                 writes, writes / 5, writes * 24, writes / 2, (reads + writes) / 6,
+                                 (reads + writes) / 3).toUtf8();
+    };
+    for (int i = 0; i < spec.disks; ++i) {
+        line(8, i * 16, diskName(i));
+        line(8, i * 16 + 1, diskName(i) + "1");
+        line(8, i * 16 + 2, diskName(i) + "2");
+    }
+    return out;
+}
+
+QByteArray mountinfoFile(const ProcFixtureSpec &spec)
+{
+    // Host paths, since usage comes from statvfs(); the pseudo filesystems
+    // are there to be filtered out.
+    QByteArray out = "22 1 8:1 / / rw,relatime shared:1 - ext4 /dev/sda1 rw\n"
+                     "23 22 0:21 / /proc rw,nosuid,nodev,noexec,relatime shared:12 - proc proc rw\n"
+                     "24 22 0:22 / /sys rw,nosuid,nodev,noexec,relatime shared:2 - sysfs sysfs rw\n"
+                     "25 22 0:5 / /dev rw,nosuid,relatime shared:8 - devtmpfs udev rw,size=16384000k\n"
+                     "26 22 0:25 / /run rw,nosuid,nodev,noexec,relatime shared:5 - tmpfs tmpfs rw,size=3276800k\n"
+                     "27 22 8:1 /var/lib/docker /var/lib/docker rw,relatime shared:1 - ext4 /dev/sda1 rw\n"
+                     "28 22 7:0 / /snap/core/1 ro,nodev,relatime shared:9 - squashfs /dev/loop0 ro\n";
+    for (int i = 1; i < spec.disks; ++i) {
+        out += QString::asprintf("%d 22 8:%d / /tmp rw,relatime shared:%d - xfs /dev/%s1 rw\n",
+                                 30 + i, i * 16 + 1, 20 + i, diskName(i).constData()).toUtf8();
+    }
+    return out;
+}
+
+bool writeCgroup(const QString &dir, QRandomGenerator &random, QString *error)
+{
+    const quint64 usage = random.generate64() % 10000000000ULL, memory = random.generate64() % 8000000000ULL;
+    auto pressure = [&random]() {
+        return QString::asprintf("some avg10=%.2f avg60=0.50 avg300=0.25 total=%u\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n",
+                                 random.bounded(1000u) / 100.0, random.bounded(100000000u)).toUtf8();
+    };
+    return makeDir(dir, error)
+           && writeFile(dir + "/cgroup.procs", "", error)
+           && writeFile(dir + "/cpu.stat", QString::asprintf("usage_usec %llu\nuser_usec %llu\nsystem_usec %llu\nnr_periods 0\nnr_throttled 0\nthrottled_usec 0\n",
+                                                             usage, usage * 2 / 3, usage / 3).toUtf8(), error)
+           && writeFile(dir + "/memory.current", QByteArray::number(memory) + "\n", error)
+           && writeFile(dir + "/memory.stat", QString::asprintf("anon %llu\nfile %llu\nkernel 1048576\nkernel_stack 65536\npagetables 131072\nshmem 0\nsock 0\n",
+                                                                memory * 2 / 3, memory / 3).toUtf8(), error)
+           && writeFile(dir + "/io.stat", QString::asprintf("8:0 rbytes=%llu wbytes=%llu rios=%llu wios=%llu dbytes=0 dios=0\n",
+                                                            usage * 3, usage, usage / 4096, usage / 8192).toUtf8(), error)
+           && writeFile(dir + "/cpu.pressure", pressure(), error)
+           && writeFile(dir + "/memory.pressure", pressure(), error)
+           && writeFile(dir + "/io.pressure", pressure(), error);
+}
+
+bool writeCgroupTree(const QString &root, const ProcFixtureSpec &spec, QRandomGenerator &random, QString *error)
+{
+    static const char *const slices[] = {"system.slice", "user.slice", "machine.slice"};
+    static const char *const leafFormats[] = {"unit-%d.service", "session-%d.scope", "container-%d.scope"};
+    if (!writeCgroup(root, random, error) || !writeFile(root + "/cgroup.controllers", "cpuset cpu io memory pids\n", error)) return false;
+    for (const char *slice : slices) {
+        if (!writeCgroup(root + "/" + slice, random, error)) return false;
+    }
+    for (int i = 0; i < spec.cgroups; ++i) {
+        const QString leaf = root + "/" + slices[i % 3] + "/" + QString::asprintf(leafFormats[i % 3], i);
+        if (!writeCgroup(leaf, random, error)) return false;
+    }
+    return true;
+}
+
+// A coretemp chip with a package and one sensor per core, a board chip with
+// fans, and cpufreq plus throttle counters for every CPU.
+bool writeSensors(const QString &sys, const ProcFixtureSpec &spec, QRandomGenerator &random, QString *error)
+{
+    const QString coretemp = sys + "/class/hwmon/hwmon0";
+    const QString board = sys + "/class/hwmon/hwmon1";
+    if (!makeDir(coretemp, error) || !makeDir(board, error)) return false;
+    if (!writeFile(coretemp + "/name", "coretemp\n", error) || !writeFile(board + "/name", "nct6798\n", error)) return false;
+    for (int i = 1; i <= spec.cpus / 2 + 1; ++i) {
+        const QString prefix = coretemp + QString("/temp%1").arg(i);
+        const QByteArray label = i == 1 ? QByteArray("Package id 0") : "Core " + QByteArray::number(i - 2);
+        if (!writeFile(prefix + "_input", QByteArray::number(40000 + random.bounded(40000u)) + "\n", error)
+            || !writeFile(prefix + "_label", label + "\n", error)
+            || !writeFile(prefix + "_crit", "100000\n", error)) {
+            return false;
+        }
+    }
+    for (int i = 1; i <= 3; ++i) {
+        if (!writeFile(board + QString("/fan%1_input").arg(i), QByteArray::number(600 + random.bounded(1800u)) + "\n", error)) return false;
+    }
+    for (int cpu = 0; cpu < spec.cpus; ++cpu) {
+        const QString dir = sys + QString("/devices/system/cpu/cpu%1").arg(cpu);
+        if (!makeDir(dir + "/cpufreq", error) || !makeDir(dir + "/thermal_throttle", error)
+            || !writeFile(dir + "/cpufreq/cpuinfo_max_freq", "4200000\n", error)
+            || !writeFile(dir + "/cpufreq/scaling_cur_freq", QByteArray::number(800000 + random.bounded(3400000u)) + "\n", error)
+            || !writeFile(dir + "/thermal_throttle/core_throttle_count", QByteArray::number(random.bounded(10u)) + "\n", error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QByteArray cpuinfoFile(const ProcFixtureSpec &spec)
+{
+    QByteArray out;
+    for (int cpu = 0; cpu < spec.cpus; ++cpu) {
+        out += "processor\t: " + QByteArray::number(cpu) + "\n";
+        out += "vendor_id\t: GenuineIntel\ncpu family\t: 6\nmodel\t\t: 85\n";
+        out += "model name\t: Synthetic Xeon(R) CPU @ 2.50GHz\n";
+        out += "physical id\t: 0\ncore id\t\t: " + QByteArray::number(cpu / 2) + "\n";
+        out += "cpu MHz\t\t: 2500.000\ncache size\t: 36608 KB\n";
+        out += "flags\t\t: fpu vme de pse tsc msr pae mce cx8 apic sep mtrr pge mca cmov pat pse36 clflush mmx fxsr sse sse2 ss ht syscall nx pdpe1gb rdtscp lm constant_tsc\n\n";
+    }
+    return out;
+}
+
+QByteArray statusFile(int pid, int ppid, const QByteArray &name, quint64 rssKB, int threads)
+{
+    return QString::asprintf(
+        "Name:\t%s\nUmask:\t0022\nState:\tS (sleeping)\nTgid:\t%d\nNgid:\t0\nPid:\t%d\nPPid:\t%d\n"
+        "TracerPid:\t0\nUid:\t1000\t1000\t1000\t1000\nGid:\t1000\t1000\t1000\t1000\nFDSize:\t64\n"
+        "Groups:\t4 24 27 1000 \nNStgid:\t%d\nNSpid:\t%d\nNSpgid:\t%d\nNSsid:\t%d\nKthread:\t0\n"
+        "VmPeak:\t%8llu kB\nVmSize:\t%8llu kB\nVmLck:\t       0 kB\nVmPin:\t       0 kB\n"
+        "VmHWM:\t%8llu kB\nVmRSS:\t%8llu kB\nRssAnon:\t%8llu kB\nRssFile:\t%8llu kB\nRssShmem:\t       0 kB\n"
+        "VmData:\t%8llu kB\nVmStk:\t     132 kB\nVmExe:\t     900 kB\nVmLib:\t    8000 kB\nVmPTE:\t     200 kB\n"
+        "VmSwap:\t       0 kB\nHugetlbPages:\t       0 kB\nCoreDumping:\t0\nTHP_enabled:\t1\n"
+        "untag_mask:\t0xffffffffffffffff\nThreads:\t%d\nSigQ:\t0/127556\n"
+        "SigPnd:\t0000000000000000\nShdPnd:\t0000000000000000\nSigBlk:\t0000000000000000\n"
+        "SigIgn:\t0000000000001000\nSigCgt:\t0000000180004a02\nCapInh:\t0000000000000000\n"
+        "CapPrm:\t0000000000000000\nCapEff:\t0000000000000000\nCapBnd:\t000001ffffffffff\n"
+        "CapAmb:\t0000000000000000\nNoNewPrivs:\t0\nSeccomp:\t0\nSeccomp_filters:\t0\n"
+        "Speculation_Store_Bypass:\tthread vulnerable\nSpeculationIndirectBranch:\tconditional enabled\n"
+        "Cpus_allowed:\tff\nCpus_allowed_list:\t0-7\nMems_allowed:\t00000001\nMems_allowed_list:\t0\n"
+        "voluntary_ctxt_switches:\t%d\nnonvoluntary_ctxt_switches:\t%d\n",
+        name.constData(), pid, pid, ppid, pid, pid, pid, pid,
+        rssKB * 3, rssKB * 2, rssKB, rssKB, rssKB * 3 / 4, rssKB / 4, rssKB,
+        threads, pid % 5000, pid % 300).toUtf8();
+}
+
+QByteArray pidStatFile(int pid, int ppid, const QByteArray &name, quint64 rssKB, int threads, QRandomGenerator &random)
+{
+    return QString::asprintf(
+        "%d (%s) S %d %d %d 0 -1 4194560 %u 0 %u 0 %u %u 0 0 20 0 %d 0 %u %llu %llu "
+        "18446744073709551615 1 1 0 0 0 0 0 4096 17920 0 0 0 17 %d 0 0 0 0 0\n",
+        pid, name.constData(), ppid, pid, pid, random.bounded(100000u), random.bounded(100u),
+        random.bounded(500000u), random.bounded(100000u), threads, random.bounded(10000000u),
+        rssKB * 3 * 1024, rssKB / 4, pid % 8).toUtf8();
+}
+
+}
+
+bool writeProcFixture(const QString &root, const ProcFixtureSpec &spec, QString *error)
+{
+    QRandomGenerator random(spec.seed);
+    const QString proc = root + "/proc";
+    const QString sys = root + "/sys";
+    if (!makeDir(proc + "/net", error) || !makeDir(proc + "/sys/kernel", error) || !makeDir(proc + "/self", error)) return false;
+    if (!makeDir(sys + "/devices/system/cpu", error)) return false;
+
+    if (!writeFile(proc + "/stat", statFile(spec, random), error)
+        || !writeFile(proc + "/meminfo", meminfoFile(), error)
+        || !writeFile(proc + "/net/dev", netDevFile(spec, random), error)
+        || !writeFile(proc + "/diskstats", diskstatsFile(spec, random), error)
+        || !writeFile(proc + "/self/mountinfo", mountinfoFile(spec), error)
+        || !writeFile(proc + "/cpuinfo", cpuinfoFile(spec), error)
+        || !writeFile(proc + "/version", "Linux version 6.1.0-synthetic (fixture@bench) #1 SMP PREEMPT_DYNAMIC\n", error)
+        || !writeFile(proc + "/sys/kernel/hostname", "fixture-" + QByteArray::number(spec.processes) + "\n", error)
+        || !writeFile(proc + "/uptime", "123456.78 987654.32\n", error)
+        || !writeFile(proc + "/loadavg", "1.25 1.10 0.98 3/" + QByteArray::number(spec.processes) + " 99999\n", error)) {
+        return false;
+    }
+    if (!writeFile(sys + "/devices/system/cpu/online", "0-" + QByteArray::number(spec.cpus - 1) + "\n", error))
+        return false;
+    if (spec.cgroups > 0 && !writeCgroupTree(sys + "/fs/cgroup", spec, random, error)) return false;
+    if (!writeSensors(sys, spec, random, error)) return false;
+    for (int i = 0; i < spec.disks; ++i) {
+        const QString block = sys + "/block/" + QString::fromLatin1(diskName(i));
+        if (!makeDir(block, error) || !writeFile(block + "/dev", "8:" + QByteArray::number(i * 16) + "\n", error)) return false;
+    }
+
+    const int nameCount = int(sizeof(kProcessNames) / sizeof(kProcessNames[0]));
+    int pid = 1;
+    for (int i = 0; i < spec.processes; ++i) {
+        const QByteArray name = kProcessNames[random.bounded(nameCount)];
+        const int ppid = i == 0 ? 0 : 1 + int(random.bounded(quint32(pid)));
+        const quint64 rssKB = random.bounded(2u) ? random.bounded(4000000u) : random.bounded(20000u);
+        const int threads = 1 + int(random.bounded(random.bounded(10u) ? 8u : 200u));
+
+        const QString dir = proc + "/" + QString::number(pid);
+        if (!makeDir(dir, error)
+            || !writeFile(dir + "/status", statusFile(pid, ppid, name, rssKB, threads), error)
+            || !writeFile(dir + "/stat", pidStatFile(pid, ppid, name, rssKB, threads, random), error)
+            || !writeFile(dir + "/comm", name + "\n", error)
+            || !writeFile(dir + "/cmdline", "/usr/bin/" + name + QByteArray("\0--worker\0", 10) + QByteArray::number(i) + QByteArray(1, '\0'), error)
+            || !writeFile(dir + "/io", QString::asprintf("rchar: %llu\nwchar: %llu\nsyscr: 100\nsyscw: 50\nread_bytes: %llu\nwrite_bytes: %llu\ncancelled_write_bytes: 0\n",
+                                                         random.generate64() % 1000000000, random.generate64() % 1000000000,
+                                                         random.generate64() % 100000000, random.generate64() % 100000000).toUtf8(), error)
+            || !writeFile(dir + "/smaps_rollup", QString::asprintf("00400000-7fffffffffff ---p 00000000 00:00 0 [rollup]\nRss: %llu kB\nPss: %llu kB\nPrivate_Clean: %llu kB\nPrivate_Dirty: %llu kB\nSwap: 0 kB\n",
+                                                                   rssKB, rssKB * 3 / 4, rssKB / 8, rssKB / 2).toUtf8(), error)) {
+            return false;
+        }
+        // Leave gaps in the pid space like a real, long-running host.
+        pid += 1 + int(random.bounded(4u));
+    }
+    return true;
+}
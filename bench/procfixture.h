@@ -0,0 +1,23 @@
+#ifndef PROCFIXTURE_H
+#define PROCFIXTURE_H
+
+#include <QString>
+
+// Shape of a synthetic procfs/sysfs tree. The same spec and seed always
+// produce byte-identical trees, so timings are comparable across runs and
+// machines.
+struct ProcFixtureSpec
+{
+    int processes = 1000;
+    int cpus = 8;
+    int interfaces = 4;
+    int disks = 4;
+    int cgroups = 1000; // leaf cgroups, spread over three slices
+    quint32 seed = 1;
+};
+
+// Writes <root>/proc and <root>/sys. Point ProcFs (or SYS_COPILOT_PROC_ROOT
+// and SYS_COPILOT_SYS_ROOT) at them to run the collectors against the tree.
+bool writeProcFixture(const QString &root, const ProcFixtureSpec &spec, QString *error);
+
+#endif // PROCFIXTURE_H
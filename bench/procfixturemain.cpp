@@ -0,0 +1,43 @@
+// Writes a synthetic procfs/sysfs tree for running the monitor, the agent or
+// collector_bench against a reproducible workload.
+//
+//   proc_fixture <dir> [--processes N] [--cpus N] [--interfaces N] [--disks N] [--cgroups N] [--seed N]
+//
+// then e.g. SYS_COPILOT_PROC_ROOT=<dir>/proc SYS_COPILOT_SYS_ROOT=<dir>/sys SystemMonitor
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "procfixture.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addPositionalArgument("dir", "Directory to create the proc and sys trees in.");
+    QCommandLineOption processesOption("processes", "Number of processes.", "n", "1000");
+    QCommandLineOption cpusOption("cpus", "Number of CPUs.", "n", "8");
+    QCommandLineOption interfacesOption("interfaces", "Number of non-loopback network interfaces.", "n", "4");
+    QCommandLineOption seedOption("seed", "Random seed.", "n", "1");
+    QCommandLineOption disksOption("disks", "Number of block devices, each with two partitions.", "n", "4");
+    QCommandLineOption cgroupsOption("cgroups", "Number of leaf cgroups under the cgroup v2 root.", "n", "1000");
+    parser.addOptions({processesOption, cpusOption, interfacesOption, disksOption, cgroupsOption, seedOption});
+    parser.process(app);
+    if (parser.positionalArguments().size() != 1) parser.showHelp(1);
+
+    ProcFixtureSpec spec;
+    spec.processes = parser.value(processesOption).toInt();
+    spec.cpus = qMax(1, parser.value(cpusOption).toInt());
+    spec.interfaces = parser.value(interfacesOption).toInt();
+    spec.disks = parser.value(disksOption).toInt();
+    spec.cgroups = parser.value(cgroupsOption).toInt();
+    spec.seed = parser.value(seedOption).toUInt();
+
+    QString error;
+    if (!writeProcFixture(parser.positionalArguments().first(), spec, &error)) {
+        qCritical("%s", qPrintable(error));
+        return 1;
+    }
+    return 0;
+}
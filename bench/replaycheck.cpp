@@ -0,0 +1,119 @@
+// Records a few ticks of this host while a child process sleeps, then
+// replays the capture with rules that kill and stop that child, and checks
+// that the replay only reports what it would have done: the child must
+// still be running and unstopped afterwards.
+//
+//   replay_check [--ticks N]
+//
+// Exits non-zero if the child was signalled or the rules did not fire.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "core/systemmonitor.h"
+
+namespace {
+
+bool record(const QString &path, int ticks, QString *error)
+{
+    SystemMonitor recorder;
+    if (!recorder.startRecording(path, error)) return false;
+    recorder.readStaticData();
+    for (int tick = 0; tick < ticks; ++tick) recorder.readDynamicData();
+    return true;
+}
+
+// Fired alerts mentioning `needle`.
+int countAlerts(const QList<MonitorAlert> &alerts, const QString &needle)
+{
+    int count = 0;
+    for (const MonitorAlert &alert : alerts) {
+        if (alert.source == MonitorAlert::Rule && alert.message.contains(needle)) ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Before QCoreApplication, so the child holds no Qt state.
+    const pid_t child = ::fork();
+    if (child < 0) {
+        qCritical("fork failed");
+        return 1;
+    }
+    if (child == 0) {
+        for (;;) ::pause();
+    }
+
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption ticksOption("ticks", "Ticks to record.", "n", "3");
+    parser.addOptions({ticksOption});
+    parser.process(app);
+    const int ticks = qMax(1, parser.value(ticksOption).toInt());
+
+    auto finish = [child](int status) {
+        ::kill(child, SIGKILL);
+        ::waitpid(child, nullptr, 0);
+        return status;
+    };
+
+    QTemporaryDir dir;
+    const QString capturePath = dir.filePath("check.syscap");
+    const QString rulesPath = dir.filePath("check.rules");
+    QString error;
+    if (!record(capturePath, ticks, &error)) {
+        qCritical("record failed: %s", qPrintable(error));
+        return finish(1);
+    }
+    QFile rules(rulesPath);
+    if (!rules.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCritical("cannot write %s", qPrintable(rulesPath));
+        return finish(1);
+    }
+    rules.write(QString("victim_kill: process pid == %1 then kill\nvictim_stop: process pid == %1 then stop\n").arg(child).toUtf8());
+    rules.close();
+    qputenv("SYS_COPILOT_RULES", QFile::encodeName(rulesPath));
+
+    SystemMonitor monitor;
+    SystemMonitor::CaptureOptions options;
+    options.replayPath = capturePath;
+    options.replaySpeed = SystemMonitor::MaximumSpeed;
+    if (!monitor.applyCaptureOptions(options, &error)) {
+        qCritical("replay failed: %s", qPrintable(error));
+        return finish(1);
+    }
+    QList<MonitorAlert> alerts;
+    QObject::connect(&monitor, &SystemMonitor::alertsRaised, [&alerts](const QList<MonitorAlert> &raised) { alerts += raised; });
+    QObject::connect(&monitor, &SystemMonitor::replayFinished, &app, &QCoreApplication::quit);
+    QTimer::singleShot(0, &monitor, &SystemMonitor::startMonitoring);
+    QTimer::singleShot(30000, &app, [&app]() { app.exit(2); });
+    if (app.exec() != 0) {
+        qCritical("replay did not finish");
+        return finish(1);
+    }
+
+    int status = 0;
+    const pid_t changed = ::waitpid(child, &status, WNOHANG | WUNTRACED);
+    if (changed != 0) {
+        qCritical("replayed kill/stop rule signalled live pid %d", int(child));
+        return finish(1);
+    }
+    const int wouldKill = countAlerts(alerts, "would kill");
+    const int wouldStop = countAlerts(alerts, "would stop");
+    if (wouldKill != 1 || wouldStop != 1) {
+        qCritical("expected one 'would kill' and one 'would stop' alert, got %d and %d", wouldKill, wouldStop);
+        return finish(1);
+    }
+    QTextStream(stdout) << QString("replay: kill and stop rules for live pid %1 reported, not applied\n").arg(child);
+    return finish(0);
+}
@@ -0,0 +1,239 @@
+// Round-trips synthetic samples through the agent wire protocol and checks
+// that every decoded sample matches what was encoded: the Hello, a Delta per
+// tick, and a Snapshot for a decoder that joins mid-stream. With --agents N
+// it then runs N AgentServers on localhost, connects a client to each and
+// checks that every client ends up with the final sample.
+//
+//   wire_check [--ticks N] [--processes N] [--agents N]
+//
+// Exits non-zero on the first mismatch.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "common/wireprotocol.h"
+#include "core/agentserver.h"
+
+namespace {
+
+// Values are generated on the protocol's grid (hundredths, whole KB), so a
+// correct round trip is exact.
+class SampleGenerator
+{
+public:
+    SampleGenerator(int processes, quint32 seed) : m_random(seed)
+    {
+        m_data.hostname = "wire-check";
+        m_data.kernelVersion = "Linux version 6.0.0-check";
+        m_data.cpuModel = "Synthetic CPU";
+        m_data.totalSystemMemoryMB = 32768;
+        for (int i = 0; i < processes; ++i) m_data.processes.append(makeProcess());
+    }
+
+    const SystemData &data() const { return m_data; }
+
+    // Some processes exit, some start, some change memory; scalars all move.
+    void advance()
+    {
+        double *scalars[] = {&m_data.cpuPercentage, &m_data.memPercentage, &m_data.diskPercentage,
+                             &m_data.netDownSpeed_KBps, &m_data.netUpSpeed_KBps};
+        for (double *scalar : scalars) *scalar = m_random.bounded(1000000) / 100.0;
+        QList<ProcessData> &processes = m_data.processes;
+        for (int i = processes.size() - 1; i >= 0; --i) {
+            const int roll = m_random.bounded(100);
+            if (roll < 3) processes.removeAt(i);
+            else if (roll < 20) processes[i].memUsageMB = m_random.bounded(4 * 1024 * 1024) / 1024.0;
+        }
+        const int started = m_random.bounded(static_cast<int>(processes.size() / 20) + 2);
+        for (int i = 0; i < started; ++i) processes.append(makeProcess());
+    }
+
+private:
+    ProcessData makeProcess()
+    {
+        ProcessData process;
+        process.pid = ++m_lastPid;
+        // Few distinct names, so the name table is shared and reused.
+        process.name = QString("worker-%1").arg(m_random.bounded(40));
+        process.memUsageMB = m_random.bounded(4 * 1024 * 1024) / 1024.0;
+        return process;
+    }
+
+    QRandomGenerator m_random;
+    SystemData m_data;
+    int m_lastPid = 100;
+};
+
+bool same(const SystemData &expected, const SystemData &actual, QString *difference)
+{
+    auto near = [](double a, double b) { return std::fabs(a - b) < 0.005; };
+    if (actual.hostname != expected.hostname || actual.kernelVersion != expected.kernelVersion
+        || actual.cpuModel != expected.cpuModel || actual.totalSystemMemoryMB != expected.totalSystemMemoryMB) {
+        *difference = "static data";
+        return false;
+    }
+    if (!near(actual.cpuPercentage, expected.cpuPercentage) || !near(actual.memPercentage, expected.memPercentage)
+        || !near(actual.diskPercentage, expected.diskPercentage) || !near(actual.netDownSpeed_KBps, expected.netDownSpeed_KBps)
+        || !near(actual.netUpSpeed_KBps, expected.netUpSpeed_KBps)) {
+        *difference = "scalars";
+        return false;
+    }
+    if (actual.processes.size() != expected.processes.size()) {
+        *difference = QString("%1 processes, expected %2").arg(actual.processes.size()).arg(expected.processes.size());
+        return false;
+    }
+    for (int i = 0; i < expected.processes.size(); ++i) {
+        const ProcessData &e = expected.processes[i];
+        const ProcessData &a = actual.processes[i];
+        if (a.pid != e.pid || a.name != e.name || std::llround(a.memUsageMB * 1024) != std::llround(e.memUsageMB * 1024)) {
+            *difference = QString("process %1 (%2, %3 KB) decoded as %4 (%5, %6 KB)")
+                              .arg(e.pid).arg(e.name).arg(std::llround(e.memUsageMB * 1024))
+                              .arg(a.pid).arg(a.name).arg(std::llround(a.memUsageMB * 1024));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool expectFrame(WireDecoder &decoder, WireDecoder::Result expected, const char *what, QString *error)
+{
+    const WireDecoder::Result result = decoder.next();
+    if (result == expected) return true;
+    *error = QString("%1: decoder returned %2 (%3)").arg(what).arg(static_cast<int>(result)).arg(decoder.errorString());
+    return false;
+}
+
+bool checkRoundTrip(int ticks, int processes, QString *error)
+{
+    SampleGenerator generator(processes, 1);
+    WireEncoder encoder;
+    WireDecoder decoder;
+    decoder.append(encoder.encodeHello(generator.data()));
+    if (!expectFrame(decoder, WireDecoder::HelloFrame, "hello", error)) return false;
+
+    QString difference;
+    for (int tick = 0; tick < ticks; ++tick) {
+        decoder.append(encoder.encodeDelta(generator.data()));
+        if (!expectFrame(decoder, WireDecoder::SampleFrame, "delta", error)) return false;
+        if (!same(generator.data(), decoder.data(), &difference)) {
+            *error = QString("delta of tick %1: %2").arg(tick).arg(difference);
+            return false;
+        }
+        // A client joining now gets Hello + Snapshot and must see the same.
+        if (tick % 10 == 0) {
+            WireDecoder late;
+            late.append(encoder.encodeHello(generator.data()) + encoder.encodeSnapshot());
+            if (!expectFrame(late, WireDecoder::HelloFrame, "late hello", error)
+                || !expectFrame(late, WireDecoder::SampleFrame, "snapshot", error)) return false;
+            if (!same(generator.data(), late.data(), &difference)) {
+                *error = QString("snapshot of tick %1: %2").arg(tick).arg(difference);
+                return false;
+            }
+        }
+        generator.advance();
+    }
+    return true;
+}
+
+// Each client connects to its own agent, as the Remote Hosts tab does.
+bool checkAgents(int agents, int ticks, int processes, QString *error)
+{
+    struct Agent
+    {
+        std::unique_ptr<AgentServer> server;
+        std::unique_ptr<QTcpSocket> client;
+        WireDecoder decoder;
+        std::unique_ptr<SampleGenerator> generator;
+    };
+    std::vector<Agent> hosts(agents);
+    for (int i = 0; i < agents; ++i) {
+        Agent &agent = hosts[i];
+        agent.server.reset(new AgentServer);
+        if (!agent.server->listen(QHostAddress::LocalHost, 0)) {
+            *error = "listen: " + agent.server->errorString();
+            return false;
+        }
+        agent.generator.reset(new SampleGenerator(processes, 100 + i));
+        agent.server->onStaticDataReady(agent.generator->data());
+        agent.client.reset(new QTcpSocket);
+        QTcpSocket *socket = agent.client.get();
+        WireDecoder *decoder = &agent.decoder;
+        QObject::connect(socket, &QTcpSocket::readyRead, [socket, decoder]() { decoder->append(socket->readAll()); });
+        socket->connectToHost(QHostAddress::LocalHost, agent.server->serverPort());
+        if (!socket->waitForConnected(5000)) {
+            *error = QString("agent %1: %2").arg(i).arg(socket->errorString());
+            return false;
+        }
+    }
+
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (Agent &agent : hosts) {
+            agent.generator->advance();
+            agent.server->onDynamicDataUpdated(agent.generator->data());
+        }
+        QCoreApplication::processEvents();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QString difference;
+    for (int i = 0; i < agents; ++i) {
+        Agent &agent = hosts[i];
+        // Drain every frame received so far; the last one must be the final sample.
+        for (;;) {
+            const WireDecoder::Result result = agent.decoder.next();
+            if (result == WireDecoder::ProtocolError) {
+                *error = QString("agent %1: %2").arg(i).arg(agent.decoder.errorString());
+                return false;
+            }
+            if (result != WireDecoder::NeedMoreData) continue;
+            if (same(agent.generator->data(), agent.decoder.data(), &difference)) break;
+            if (timer.elapsed() > 10000) {
+                *error = QString("agent %1 never caught up: %2").arg(i).arg(difference);
+                return false;
+            }
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption ticksOption("ticks", "Samples to encode.", "n", "200");
+    QCommandLineOption processesOption("processes", "Processes in the first sample.", "n", "500");
+    QCommandLineOption agentsOption("agents", "Local agents to stream through (0 to skip).", "n", "3");
+    parser.addOptions({ticksOption, processesOption, agentsOption});
+    parser.process(app);
+
+    const int ticks = parser.value(ticksOption).toInt();
+    const int processes = parser.value(processesOption).toInt();
+    const int agents = parser.value(agentsOption).toInt();
+    QTextStream out(stdout);
+    QString error;
+    if (!checkRoundTrip(ticks, processes, &error)) {
+        qCritical("round trip failed: %s", qPrintable(error));
+        return 1;
+    }
+    out << QString("round trip: %1 deltas and %2 snapshots OK\n").arg(ticks).arg((ticks + 9) / 10);
+    if (agents > 0) {
+        if (!checkAgents(agents, ticks, processes, &error)) {
+            qCritical("agents failed: %s", qPrintable(error));
+            return 1;
+        }
+        out << QString("agents: %1 local agents streamed %2 ticks OK\n").arg(agents).arg(ticks);
+    }
+    return 0;
+}
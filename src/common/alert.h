@@ -0,0 +1,20 @@
+#ifndef ALERT_H
+#define ALERT_H
+
+#include <QString>
+#include <QList>
+
+struct MonitorAlert
+{
+    enum Source { Anomaly, Rule, Pressure, Sensor };
+
+    Source source = Anomaly;
+    qint64 timestampMs = 0;
+    QString series;   // e.g. "cpu", "mem", "process.rss"
+    QString message;
+    int pid = -1;     // -1 for system-wide alerts
+    double value = 0.0;
+    double score = 0.0;
+};
+
+#endif // ALERT_H
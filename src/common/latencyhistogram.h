@@ -0,0 +1,121 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+#include <array>
+#include <limits>
+
+// Log-linear latency histogram: every power of two is split into eight
+// sub-buckets, so recording is O(1), memory is fixed and percentiles are
+// accurate to within ~12% of the true value.
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 3;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+    static int bucketFor(quint64 value)
+    {
+        if (value < static_cast<quint64>(SubBuckets)) return static_cast<int>(value);
+        const int exponent = 63 - __builtin_clzll(value);
+        const int sub = static_cast<int>((value >> (exponent - SubBucketBits)) & (SubBuckets - 1));
+        return (exponent - SubBucketBits + 1) * SubBuckets + sub;
+    }
+
+    static quint64 bucketLowerBound(int bucket)
+    {
+        if (bucket < SubBuckets) return static_cast<quint64>(bucket);
+        const int exponent = bucket / SubBuckets + SubBucketBits - 1;
+        const quint64 sub = static_cast<quint64>(bucket % SubBuckets);
+        return (SubBuckets + sub) << (exponent - SubBucketBits);
+    }
+
+    static quint64 bucketMidpoint(int bucket)
+    {
+        const quint64 lower = bucketLowerBound(bucket);
+        if (bucket + 1 >= BucketCount) return lower;
+        return lower + (bucketLowerBound(bucket + 1) - lower) / 2;
+    }
+
+    void record(qint64 value)
+    {
+        const quint64 v = value > 0 ? static_cast<quint64>(value) : 0;
+        ++m_buckets[bucketFor(v)];
+        ++m_count;
+        m_sum += v;
+        if (v < m_min) m_min = v;
+        if (v > m_max) m_max = v;
+    }
+
+    void merge(const LatencyHistogram &other)
+    {
+        for (int i = 0; i < BucketCount; ++i) m_buckets[i] += other.m_buckets[i];
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        if (other.m_min < m_min) m_min = other.m_min;
+        if (other.m_max > m_max) m_max = other.m_max;
+    }
+
+    // Adds bucket counts accumulated elsewhere (SelfProfiler's atomics).
+    void addBuckets(const quint64 *buckets, quint64 sum, quint64 min, quint64 max)
+    {
+        quint64 count = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            m_buckets[i] += buckets[i];
+            count += buckets[i];
+        }
+        if (count == 0) return;
+        m_count += count;
+        m_sum += sum;
+        if (min < m_min) m_min = min;
+        if (max > m_max) m_max = max;
+    }
+
+    void reset() { *this = LatencyHistogram(); }
+
+    quint64 count() const { return m_count; }
+    quint64 min() const { return m_count ? m_min : 0; }
+    quint64 max() const { return m_max; }
+    double mean() const { return m_count ? static_cast<double>(m_sum) / m_count : 0.0; }
+
+    // p in [0, 100]. Returns the midpoint of the bucket holding the p-th
+    // sample, clamped to the observed min/max.
+    quint64 percentile(double p) const
+    {
+        if (m_count == 0) return 0;
+        quint64 rank = static_cast<quint64>(p / 100.0 * m_count + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > m_count) rank = m_count;
+        quint64 seen = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            seen += m_buckets[i];
+            if (seen >= rank) return qBound(min(), bucketMidpoint(i), m_max);
+        }
+        return m_max;
+    }
+
+    // Values are assumed to be nanoseconds; the dump is in microseconds.
+    QJsonObject toJson() const
+    {
+        QJsonObject obj;
+        obj["count"] = static_cast<double>(m_count);
+        obj["min_us"] = min() / 1000.0;
+        obj["mean_us"] = mean() / 1000.0;
+        obj["p50_us"] = percentile(50) / 1000.0;
+        obj["p90_us"] = percentile(90) / 1000.0;
+        obj["p99_us"] = percentile(99) / 1000.0;
+        obj["max_us"] = m_max / 1000.0;
+        return obj;
+    }
+
+private:
+    std::array<quint64, BucketCount> m_buckets{};
+    quint64 m_count = 0;
+    quint64 m_sum = 0;
+    quint64 m_min = std::numeric_limits<quint64>::max();
+    quint64 m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
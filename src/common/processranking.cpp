@@ -0,0 +1,122 @@
+#include "processranking.h"
+#include "systemdata.h"
+#include <algorithm>
+
+namespace {
+
+bool ranksAbove(const ProcessRanking::Entry &a, const ProcessRanking::Entry &b)
+{
+    return a.value != b.value ? a.value > b.value : a.pid < b.pid;
+}
+
+}
+
+double ProcessRanking::value(const ProcessData &process, Metric metric)
+{
+    switch (metric) {
+    case Memory: return process.memUsageMB;
+    case Cpu: return process.cpuPercentage;
+    case Threads: return process.threads;
+    case MetricCount: break;
+    }
+    return 0.0;
+}
+
+bool ProcessRanking::metricFromName(const QString &name, Metric *metric)
+{
+    static const char *const names[MetricCount] = {"memory", "cpu", "threads"};
+    for (int i = 0; i < MetricCount; ++i) {
+        if (name.compare(QLatin1String(names[i]), Qt::CaseInsensitive) == 0) {
+            *metric = static_cast<Metric>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const ProcessData *ProcessRanking::find(const QList<ProcessData> &processes, int pid)
+{
+    auto it = std::lower_bound(processes.begin(), processes.end(), pid,
+                               [](const ProcessData &process, int value) { return process.pid < value; });
+    return it != processes.end() && it->pid == pid ? &*it : nullptr;
+}
+
+void ProcessRanking::rebuild(const QList<ProcessData> &processes)
+{
+    for (int metric = 0; metric < MetricCount; ++metric) {
+        List &list = m_lists[metric];
+        list.entries.resize(0);
+        list.entries.reserve(Capacity);
+        list.exhaustive = processes.size() <= Capacity;
+        // Max-heap under ranksAbove, so the front is the weakest kept entry.
+        for (const ProcessData &process : processes) {
+            const Entry entry = {process.pid, value(process, static_cast<Metric>(metric))};
+            if (list.entries.size() < Capacity) {
+                list.entries.append(entry);
+                std::push_heap(list.entries.begin(), list.entries.end(), ranksAbove);
+            } else if (ranksAbove(entry, list.entries.front())) {
+                std::pop_heap(list.entries.begin(), list.entries.end(), ranksAbove);
+                list.entries.back() = entry;
+                std::push_heap(list.entries.begin(), list.entries.end(), ranksAbove);
+            }
+        }
+        std::sort_heap(list.entries.begin(), list.entries.end(), ranksAbove);
+    }
+}
+
+void ProcessRanking::update(const ProcessData &process)
+{
+    for (int metric = 0; metric < MetricCount; ++metric) {
+        List &list = m_lists[metric];
+        const Entry entry = {process.pid, value(process, static_cast<Metric>(metric))};
+        for (int i = 0; i < list.entries.size(); ++i) {
+            if (list.entries[i].pid == process.pid) {
+                list.entries.remove(i);
+                break;
+            }
+        }
+        // Unless the list holds everything, only values at or above its last
+        // entry are known to rank there.
+        if (!list.exhaustive && (list.entries.isEmpty() || ranksAbove(list.entries.last(), entry))) continue;
+        list.entries.insert(std::upper_bound(list.entries.begin(), list.entries.end(), entry, ranksAbove) - list.entries.begin(), entry);
+        if (list.entries.size() > Capacity) {
+            list.entries.removeLast();
+            list.exhaustive = false;
+        }
+    }
+}
+
+void ProcessRanking::remove(int pid)
+{
+    for (List &list : m_lists) {
+        for (int i = 0; i < list.entries.size(); ++i) {
+            if (list.entries[i].pid == pid) {
+                list.entries.remove(i);
+                break;
+            }
+        }
+    }
+}
+
+bool ProcessRanking::needsRebuild() const
+{
+    for (const List &list : m_lists) {
+        if (!list.exhaustive && list.entries.size() < Depth) return true;
+    }
+    return false;
+}
+
+QVector<ProcessRanking::Entry> ProcessRanking::top(Metric metric, int n) const
+{
+    const QVector<Entry> &entries = m_lists[metric].entries;
+    return entries.mid(0, qBound(0, qMin(n, int(Depth)), static_cast<int>(entries.size())));
+}
+
+int ProcessRanking::rank(Metric metric, int pid) const
+{
+    const QVector<Entry> &entries = m_lists[metric].entries;
+    for (int i = 0; i < entries.size(); ++i) {
+        if (entries[i].pid == pid) return i + 1;
+    }
+    return 0;
+}
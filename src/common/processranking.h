@@ -0,0 +1,59 @@
+#ifndef PROCESSRANKING_H
+#define PROCESSRANKING_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+struct ProcessData;
+
+// The top processes per metric, maintained by the monitor and carried with
+// every sample, so the process view, the copilot, alert rules and remote
+// panels can ask for the top N in O(N) instead of sorting every process.
+//
+// rebuild() selects the top Capacity per metric from a full scan with a
+// bounded heap, O(n log Capacity). Between scans, update() and remove()
+// patch one process in O(Capacity). Each list stays an exact prefix of the
+// true ranking: a member that falls below the last entry or exits is just
+// dropped, since nothing outside the list can rank above it. needsRebuild()
+// reports when a list has shrunk below Depth, the guaranteed query depth.
+class ProcessRanking
+{
+public:
+    enum Metric { Memory, Cpu, Threads, MetricCount };
+    enum { Depth = 64, Capacity = 2 * Depth };
+
+    struct Entry
+    {
+        int pid;
+        double value;
+    };
+
+    void rebuild(const QList<ProcessData> &processes);
+    void update(const ProcessData &process);
+    void remove(int pid);
+    bool needsRebuild() const;
+
+    // Highest first, ties by pid; min(n, Depth) entries, fewer only if there
+    // are fewer processes.
+    QVector<Entry> top(Metric metric, int n) const;
+    // 1-based position of pid, or 0 if it is not among the ranked entries.
+    int rank(Metric metric, int pid) const;
+
+    static double value(const ProcessData &process, Metric metric);
+    // "memory", "cpu" or "threads".
+    static bool metricFromName(const QString &name, Metric *metric);
+    // In a pid-sorted list such as SystemData::processes; nullptr if absent.
+    static const ProcessData *find(const QList<ProcessData> &processes, int pid);
+
+private:
+    struct List
+    {
+        QVector<Entry> entries;
+        bool exhaustive = true; // holds every process, not just the top
+    };
+
+    List m_lists[MetricCount];
+};
+
+#endif // PROCESSRANKING_H
@@ -3,12 +3,116 @@
 
 #include <QString>
 #include <QList>
+#include "processranking.h"
 
 struct ProcessData
 {
     int pid;
     QString name;
     double memUsageMB;
+    double cpuPercentage = 0.0; // 100 = one CPU
+    quint64 cpuTicks = 0;       // utime + stime, for the next rate
+    quint64 startTime = 0;      // clock ticks after boot; 0 if unknown (remote hosts)
+    uint uid = 0;
+    QString user;
+    char state = 0;  // R, S, D, Z, T, ...; 0 if unknown (remote hosts)
+    int threads = 0;
+    QString commandLine; // arguments joined by spaces; "[name]" for kernel threads
+    int sockets = 0;     // TCP, UDP and unix sockets it holds open
+    int connections = 0; // established TCP and connected UDP
+    double netRxKBps = 0.0, netTxKBps = 0.0; // TCP payload only
+};
+
+struct NetworkInterfaceData
+{
+    QString name;
+    quint64 rxBytes, rxPackets, rxErrors, rxDrops;
+    quint64 txBytes, txPackets, txErrors, txDrops;
+    double rxKBps;
+    double txKBps;
+};
+
+struct DiskDeviceData
+{
+    QString name;
+    double readIops, writeIops;
+    double readKBps, writeKBps;
+    // Mean time per completed request over the last interval.
+    double readLatencyMs, writeLatencyMs;
+    double busyPercentage;
+};
+
+struct MountData
+{
+    QString mountPoint;
+    QString device;
+    QString fsType;
+    quint64 totalBytes, freeBytes;
+    double usedPercentage;
+};
+
+// One hwmon temperature or fan input.
+struct SensorData
+{
+    enum Kind { Temperature, Fan };
+
+    Kind kind;
+    QString chip;    // hwmon "name", e.g. coretemp, k10temp, nvme
+    QString label;   // from <input>_label, else "temp1", "fan2", ...
+    double value;    // degrees C or RPM
+    double critical; // degrees C from _crit, else _max; 0 if unknown
+};
+
+struct CpuFrequencyData
+{
+    int cpu;
+    double currentMHz;
+    double maxMHz;
+    quint64 throttleCount; // thermal throttle events since boot, 0 if not reported
+};
+
+struct SocketData
+{
+    enum Protocol : quint8 { Tcp, Udp, Unix };
+
+    Protocol protocol;
+    bool ipv6;
+    quint8 state;         // kernel TCP_* numbering, also used for UDP and unix
+    quint8 local[16];     // network byte order; the first 4 bytes for IPv4
+    quint8 remote[16];
+    quint16 localPort;
+    quint16 remotePort;
+    QString path;         // unix sockets: bound path, "@name" if abstract
+    quint64 inode;        // 0 for sockets no file refers to, e.g. TIME_WAIT
+    quint64 peerInode;    // unix sockets: the other end
+    int pid;              // owner, 0 if unknown
+    quint32 receiveQueue; // bytes
+    quint32 sendQueue;
+    double rxKBps;        // TCP only
+    double txKBps;
+};
+
+struct ThreadData
+{
+    int tid;
+    QString name;
+    char state;           // R, S, D, Z, T, ...
+    double cpuPercentage; // 100 = one CPU
+    int processor;        // CPU it last ran on
+};
+
+// One cgroup v2 group. Counters are hierarchical, so a slice includes
+// everything below it.
+struct CgroupData
+{
+    QString path; // relative to the cgroup root, "/" for the root itself
+    int parent;   // index into SystemData::cgroups, -1 for the root
+    double cpuPercentage; // 100 = one CPU
+    quint64 memoryBytes;
+    quint64 anonBytes, fileBytes;
+    double ioReadKBps, ioWriteKBps;
+    // "some" avg10 from the pressure files, in percent.
+    double cpuPressure, memoryPressure, ioPressure;
 };
 
 struct SystemData
@@ -19,12 +123,26 @@ struct SystemData
     double diskPercentage;
     double netDownSpeed_KBps;
     double netUpSpeed_KBps;
-    QList<ProcessData> processes;
+    QList<NetworkInterfaceData> interfaces; // including lo; the totals above exclude it
+    QList<DiskDeviceData> disks;
+    QList<MountData> mounts;
+    QList<CgroupData> cgroups; // parents before children
+    QList<SensorData> sensors;
+    QList<CpuFrequencyData> cpuFrequencies;
+    double cpuTemperature = 0.0;  // hottest CPU sensor, 0 if none
+    double cpuFrequencyMHz = 0.0; // mean over CPUs, 0 without cpufreq
+    QList<SocketData> sockets; // live only; inet sockets first, then unix
+    QList<ProcessData> processes; // ascending pid
+    ProcessRanking ranking;       // top processes by memory, CPU and threads
+    qint64 sampledAtNs = 0; // SelfProfiler::now() when collected, for delivery lag
 
     // Static Data
     QString hostname;
     QString kernelVersion;
     QString cpuModel;
+    int logicalCpus = 0;
+    int physicalCores = 0;
+    double cpuMaxMHz = 0.0;
     long long totalSystemMemoryMB;
 };
 
@@ -0,0 +1,360 @@
+#include "wireprotocol.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Wire {
+
+void putVarint(QByteArray &out, quint64 value)
+{
+    char buffer[10];
+    int n = 0;
+    while (value >= 0x80) {
+        buffer[n++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer[n++] = static_cast<char>(value);
+    out.append(buffer, n);
+}
+
+void putZigzag(QByteArray &out, qint64 value)
+{
+    putVarint(out, (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+}
+
+void putString(QByteArray &out, const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    putVarint(out, static_cast<quint64>(utf8.size()));
+    out.append(utf8);
+}
+
+bool getVarint(const char *&p, const char *end, quint64 *value)
+{
+    quint64 result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const quint8 byte = static_cast<quint8>(*p++);
+        result |= static_cast<quint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getZigzag(const char *&p, const char *end, qint64 *value)
+{
+    quint64 raw;
+    if (!getVarint(p, end, &raw)) return false;
+    *value = static_cast<qint64>(raw >> 1) ^ -static_cast<qint64>(raw & 1);
+    return true;
+}
+
+bool getString(const char *&p, const char *end, QString *value)
+{
+    quint64 size;
+    if (!getVarint(p, end, &size) || size > static_cast<quint64>(end - p)) return false;
+    *value = QString::fromUtf8(p, static_cast<qsizetype>(size));
+    p += size;
+    return true;
+}
+
+}
+
+namespace {
+
+const char kMagic[4] = {'S', 'Y', 'S', 'C'};
+
+void scalarsOf(const SystemData &data, qint64 *out)
+{
+    const double values[] = {data.cpuPercentage, data.memPercentage, data.diskPercentage,
+                             data.netDownSpeed_KBps, data.netUpSpeed_KBps};
+    for (int i = 0; i < 5; ++i) out[i] = std::llround(values[i] * 100.0);
+}
+
+}
+
+// --- Encoder ---
+
+QByteArray WireEncoder::frame(Wire::FrameType type, const QByteArray &body)
+{
+    QByteArray out;
+    out.reserve(body.size() + 6);
+    Wire::putVarint(out, static_cast<quint64>(body.size()) + 1);
+    out.append(static_cast<char>(type));
+    out.append(body);
+    return out;
+}
+
+quint32 WireEncoder::internName(const QString &name)
+{
+    auto it = m_nameIds.constFind(name);
+    if (it != m_nameIds.constEnd()) return it.value();
+    const quint32 id = static_cast<quint32>(m_names.size());
+    m_nameIds.insert(name, id);
+    m_names.append(name);
+    return id;
+}
+
+QByteArray WireEncoder::encodeHello(const SystemData &data) const
+{
+    QByteArray body(kMagic, 4);
+    Wire::putVarint(body, Wire::Version);
+    Wire::putString(body, data.hostname);
+    Wire::putString(body, data.kernelVersion);
+    Wire::putString(body, data.cpuModel);
+    Wire::putVarint(body, static_cast<quint64>(qMax(0LL, data.totalSystemMemoryMB)));
+    return frame(Wire::Hello, body);
+}
+
+QByteArray WireEncoder::encodeSnapshot() const
+{
+    QByteArray body;
+    body.reserve(m_processes.size() * 6 + m_namesSent * 12 + 64);
+    Wire::putVarint(body, static_cast<quint64>(m_namesSent));
+    for (int i = 0; i < m_namesSent; ++i) Wire::putString(body, m_names[i]);
+    for (qint64 scalar : m_scalars) Wire::putZigzag(body, scalar);
+    Wire::putVarint(body, static_cast<quint64>(m_processes.size()));
+    qint32 previousPid = 0;
+    for (const ProcessEntry &entry : m_processes) {
+        Wire::putVarint(body, static_cast<quint64>(entry.pid - previousPid));
+        Wire::putVarint(body, entry.nameId);
+        Wire::putVarint(body, entry.memKB);
+        previousPid = entry.pid;
+    }
+    return frame(Wire::Snapshot, body);
+}
+
+QByteArray WireEncoder::encodeDelta(const SystemData &data)
+{
+    m_next.resize(0);
+    m_next.reserve(data.processes.size());
+    for (const ProcessData &process : data.processes) {
+        const quint64 memKB = static_cast<quint64>(std::llround(qMax(0.0, process.memUsageMB) * 1024.0));
+        m_next.append({process.pid, internName(process.name), memKB});
+    }
+    std::sort(m_next.begin(), m_next.end(), [](const ProcessEntry &a, const ProcessEntry &b) { return a.pid < b.pid; });
+
+    // Merge the previous and current pid-sorted lists.
+    m_removed.resize(0);
+    m_added.resize(0);
+    m_changed.resize(0);
+    quint64 removedCount = 0, addedCount = 0, changedCount = 0;
+    qint32 lastRemoved = 0, lastAdded = 0, lastChanged = 0;
+    auto remove = [&](const ProcessEntry &e) {
+        Wire::putVarint(m_removed, static_cast<quint64>(e.pid - lastRemoved));
+        lastRemoved = e.pid;
+        ++removedCount;
+    };
+    auto add = [&](const ProcessEntry &e) {
+        Wire::putVarint(m_added, static_cast<quint64>(e.pid - lastAdded));
+        Wire::putVarint(m_added, e.nameId);
+        Wire::putVarint(m_added, e.memKB);
+        lastAdded = e.pid;
+        ++addedCount;
+    };
+    int i = 0, j = 0;
+    while (i < m_processes.size() || j < m_next.size()) {
+        if (j >= m_next.size() || (i < m_processes.size() && m_processes[i].pid < m_next[j].pid)) {
+            remove(m_processes[i++]);
+        } else if (i >= m_processes.size() || m_next[j].pid < m_processes[i].pid) {
+            add(m_next[j++]);
+        } else {
+            const ProcessEntry &before = m_processes[i++];
+            const ProcessEntry &after = m_next[j++];
+            if (before.nameId != after.nameId) {
+                // exec() under the same pid: replace the entry.
+                remove(before);
+                add(after);
+            } else if (before.memKB != after.memKB) {
+                Wire::putVarint(m_changed, static_cast<quint64>(after.pid - lastChanged));
+                Wire::putZigzag(m_changed, static_cast<qint64>(after.memKB) - static_cast<qint64>(before.memKB));
+                lastChanged = after.pid;
+                ++changedCount;
+            }
+        }
+    }
+    m_processes.swap(m_next);
+
+    QByteArray body;
+    body.reserve(m_removed.size() + m_added.size() + m_changed.size() + 64);
+    Wire::putVarint(body, static_cast<quint64>(m_names.size() - m_namesSent));
+    for (int n = m_namesSent; n < m_names.size(); ++n) Wire::putString(body, m_names[n]);
+    m_namesSent = m_names.size();
+
+    qint64 scalars[ScalarCount];
+    scalarsOf(data, scalars);
+    quint64 mask = 0;
+    for (int s = 0; s < ScalarCount; ++s) {
+        if (scalars[s] != m_scalars[s]) mask |= 1u << s;
+    }
+    Wire::putVarint(body, mask);
+    for (int s = 0; s < ScalarCount; ++s) {
+        if (mask & (1u << s)) Wire::putZigzag(body, scalars[s] - m_scalars[s]);
+        m_scalars[s] = scalars[s];
+    }
+
+    Wire::putVarint(body, removedCount);
+    body.append(m_removed);
+    Wire::putVarint(body, addedCount);
+    body.append(m_added);
+    Wire::putVarint(body, changedCount);
+    body.append(m_changed);
+    return frame(Wire::Delta, body);
+}
+
+// --- Decoder ---
+
+void WireDecoder::reset()
+{
+    m_buffer.clear();
+    m_names.clear();
+    m_processes.clear();
+    std::fill(std::begin(m_scalars), std::end(m_scalars), 0);
+    m_data = SystemData();
+    m_error.clear();
+}
+
+WireDecoder::Result WireDecoder::next()
+{
+    const char *begin = m_buffer.constData();
+    const char *end = begin + m_buffer.size();
+    const char *p = begin;
+    quint64 length;
+    if (!Wire::getVarint(p, end, &length)) {
+        if (m_buffer.size() >= 10) { m_error = "malformed frame header"; return ProtocolError; }
+        return NeedMoreData;
+    }
+    if (length == 0 || length > static_cast<quint64>(Wire::MaxFrameSize)) { m_error = "invalid frame length"; return ProtocolError; }
+    if (static_cast<quint64>(end - p) < length) return NeedMoreData;
+
+    const quint8 type = static_cast<quint8>(*p);
+    const char *bodyEnd = p + length;
+    bool ok = false;
+    Result result = ProtocolError;
+    switch (type) {
+    case Wire::Hello: ok = parseHello(p + 1, bodyEnd); result = HelloFrame; break;
+    case Wire::Snapshot: ok = parseSnapshot(p + 1, bodyEnd); result = SampleFrame; break;
+    case Wire::Delta: ok = parseDelta(p + 1, bodyEnd); result = SampleFrame; break;
+    default: m_error = QString("unknown frame type %1").arg(type); break;
+    }
+    m_buffer.remove(0, static_cast<qsizetype>(bodyEnd - begin));
+    if (!ok) return ProtocolError;
+    if (result == SampleFrame) materialize();
+    return result;
+}
+
+bool WireDecoder::parseHello(const char *p, const char *end)
+{
+    if (end - p < 4 || std::memcmp(p, kMagic, 4) != 0) return fail("bad magic");
+    p += 4;
+    quint64 version, totalMemory;
+    if (!Wire::getVarint(p, end, &version)) return fail("truncated hello");
+    if (version != Wire::Version) return fail(QString("unsupported protocol version %1").arg(version));
+    if (!Wire::getString(p, end, &m_data.hostname) || !Wire::getString(p, end, &m_data.kernelVersion)
+        || !Wire::getString(p, end, &m_data.cpuModel) || !Wire::getVarint(p, end, &totalMemory))
+        return fail("truncated hello");
+    m_data.totalSystemMemoryMB = static_cast<long long>(totalMemory);
+    return true;
+}
+
+bool WireDecoder::readNames(const char *&p, const char *end, quint64 count)
+{
+    if (count > static_cast<quint64>(end - p)) return fail("bad name count");
+    for (quint64 i = 0; i < count; ++i) {
+        QString name;
+        if (!Wire::getString(p, end, &name)) return fail("truncated name table");
+        m_names.append(name);
+    }
+    return true;
+}
+
+bool WireDecoder::readProcess(const char *&p, const char *end, qint64 *pid)
+{
+    quint64 pidDelta, nameId, memKB;
+    if (!Wire::getVarint(p, end, &pidDelta) || !Wire::getVarint(p, end, &nameId) || !Wire::getVarint(p, end, &memKB))
+        return fail("truncated process entry");
+    if (nameId >= static_cast<quint64>(m_names.size())) return fail("unknown name id");
+    *pid += static_cast<qint64>(pidDelta);
+    m_processes.insert(static_cast<qint32>(*pid), {static_cast<quint32>(nameId), memKB});
+    return true;
+}
+
+bool WireDecoder::parseSnapshot(const char *p, const char *end)
+{
+    m_names.clear();
+    m_processes.clear();
+    quint64 nameCount, processCount;
+    if (!Wire::getVarint(p, end, &nameCount) || !readNames(p, end, nameCount)) return fail("truncated snapshot");
+    for (qint64 &scalar : m_scalars) {
+        if (!Wire::getZigzag(p, end, &scalar)) return fail("truncated snapshot");
+    }
+    if (!Wire::getVarint(p, end, &processCount)) return fail("truncated snapshot");
+    qint64 pid = 0;
+    for (quint64 i = 0; i < processCount; ++i) {
+        if (!readProcess(p, end, &pid)) return false;
+    }
+    return true;
+}
+
+bool WireDecoder::parseDelta(const char *p, const char *end)
+{
+    quint64 nameCount, mask, count;
+    if (!Wire::getVarint(p, end, &nameCount) || !readNames(p, end, nameCount)) return fail("truncated delta");
+    if (!Wire::getVarint(p, end, &mask)) return fail("truncated delta");
+    for (int s = 0; s < 5; ++s) {
+        if (!(mask & (1u << s))) continue;
+        qint64 diff;
+        if (!Wire::getZigzag(p, end, &diff)) return fail("truncated delta");
+        m_scalars[s] += diff;
+    }
+
+    if (!Wire::getVarint(p, end, &count)) return fail("truncated delta");
+    qint64 pid = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 pidDelta;
+        if (!Wire::getVarint(p, end, &pidDelta)) return fail("truncated delta");
+        pid += static_cast<qint64>(pidDelta);
+        m_processes.remove(static_cast<qint32>(pid));
+    }
+
+    if (!Wire::getVarint(p, end, &count)) return fail("truncated delta");
+    pid = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        if (!readProcess(p, end, &pid)) return false;
+    }
+
+    if (!Wire::getVarint(p, end, &count)) return fail("truncated delta");
+    pid = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 pidDelta;
+        qint64 memDiff;
+        if (!Wire::getVarint(p, end, &pidDelta) || !Wire::getZigzag(p, end, &memDiff)) return fail("truncated delta");
+        pid += static_cast<qint64>(pidDelta);
+        auto it = m_processes.find(static_cast<qint32>(pid));
+        if (it == m_processes.end()) return fail("delta for unknown pid");
+        it->memKB = static_cast<quint64>(static_cast<qint64>(it->memKB) + memDiff);
+    }
+    return true;
+}
+
+void WireDecoder::materialize()
+{
+    m_data.cpuPercentage = m_scalars[0] / 100.0;
+    m_data.memPercentage = m_scalars[1] / 100.0;
+    m_data.diskPercentage = m_scalars[2] / 100.0;
+    m_data.netDownSpeed_KBps = m_scalars[3] / 100.0;
+    m_data.netUpSpeed_KBps = m_scalars[4] / 100.0;
+
+    m_data.processes.clear();
+    m_data.processes.reserve(m_processes.size());
+    for (auto it = m_processes.constBegin(); it != m_processes.constEnd(); ++it) {
+        ProcessData process;
+        process.pid = it.key();
+        process.name = m_names[it->nameId];
+        process.memUsageMB = it->memKB / 1024.0;
+        m_data.processes.append(process);
+    }
+    m_data.ranking.rebuild(m_data.processes);
+}
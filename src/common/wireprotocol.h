@@ -0,0 +1,108 @@
+#ifndef WIREPROTOCOL_H
+#define WIREPROTOCOL_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "systemdata.h"
+
+// Binary agent protocol. Every frame is `varint length, u8 type, body`:
+//
+//   Hello     magic "SYSC", varint version, hostname, kernel, cpu model,
+//             varint total memory MB (static data)
+//   Snapshot  full name table, absolute scalars, every process
+//   Delta     names interned since the last frame, changed scalars, and the
+//             removed / added / changed processes relative to the last frame
+//
+// Strings are varint length + UTF-8. Scalars are fixed-point hundredths, sent
+// as zigzag varints; process pids are delta-coded in ascending order and
+// names are sent once and then referenced by id. Unchanged processes cost
+// nothing in a delta.
+namespace Wire {
+
+constexpr quint32 Version = 1;
+constexpr quint16 DefaultPort = 7878;
+constexpr int MaxFrameSize = 64 * 1024 * 1024;
+
+enum FrameType : quint8 { Hello = 1, Snapshot = 2, Delta = 3 };
+
+void putVarint(QByteArray &out, quint64 value);
+void putZigzag(QByteArray &out, qint64 value);
+void putString(QByteArray &out, const QString &value);
+
+bool getVarint(const char *&p, const char *end, quint64 *value);
+bool getZigzag(const char *&p, const char *end, qint64 *value);
+bool getString(const char *&p, const char *end, QString *value);
+
+}
+
+class WireEncoder
+{
+public:
+    QByteArray encodeHello(const SystemData &data) const;
+    // Full state as of the last encodeDelta(); lets a client join mid-stream.
+    QByteArray encodeSnapshot() const;
+    // Encodes `data` relative to the previous call and advances the state.
+    QByteArray encodeDelta(const SystemData &data);
+
+private:
+    enum { ScalarCount = 5 };
+
+    struct ProcessEntry
+    {
+        qint32 pid;
+        quint32 nameId;
+        quint64 memKB;
+    };
+
+    quint32 internName(const QString &name);
+    static QByteArray frame(Wire::FrameType type, const QByteArray &body);
+
+    QVector<ProcessEntry> m_processes; // sorted by pid
+    QVector<ProcessEntry> m_next;
+    qint64 m_scalars[ScalarCount] = {};
+    QHash<QString, quint32> m_nameIds;
+    QStringList m_names;
+    int m_namesSent = 0;
+    QByteArray m_removed, m_added, m_changed;
+};
+
+class WireDecoder
+{
+public:
+    enum Result { NeedMoreData, HelloFrame, SampleFrame, ProtocolError };
+
+    void append(const QByteArray &bytes) { m_buffer += bytes; }
+    // Consumes at most one frame from the buffered bytes.
+    Result next();
+    const SystemData &data() const { return m_data; }
+    QString errorString() const { return m_error; }
+    void reset();
+
+private:
+    struct ProcessEntry
+    {
+        quint32 nameId;
+        quint64 memKB;
+    };
+
+    bool parseHello(const char *p, const char *end);
+    bool parseSnapshot(const char *p, const char *end);
+    bool parseDelta(const char *p, const char *end);
+    bool readNames(const char *&p, const char *end, quint64 count);
+    bool readProcess(const char *&p, const char *end, qint64 *pid);
+    void materialize();
+    bool fail(const QString &error) { m_error = error; return false; }
+
+    QByteArray m_buffer;
+    QStringList m_names;
+    QMap<qint32, ProcessEntry> m_processes;
+    qint64 m_scalars[5] = {};
+    SystemData m_data;
+    QString m_error;
+};
+
+#endif // WIREPROTOCOL_H
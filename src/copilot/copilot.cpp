@@ -1,5 +1,8 @@
 #include "copilot.h"
 #include "../common/systemdata.h"
+#include "../core/cgroupcollector.h"
+#include "../core/selfprofiler.h"
+#include "../core/socketcollector.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QJsonDocument>
@@ -8,24 +11,48 @@
 #include <QTextStream>
 #include <QMessageBox>
 #include <QProcess>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
 
 Copilot::Copilot(QObject *parent)
     : QObject(parent),
       m_networkManager(new QNetworkAccessManager(this)),
       m_chatHistory(new QTextEdit(nullptr)),
       m_chatInput(new QLineEdit(nullptr)),
-      m_sendButton(new QPushButton("Send", nullptr))
+      m_sendButton(new QPushButton("Send", nullptr)),
+      m_autoExplainCheck(new QCheckBox("Auto-explain alerts", nullptr))
 {
     m_chatHistory->setReadOnly(true);
+    const QByteArray endpoint = qgetenv("COPILOT_ENDPOINT");
+    if (!endpoint.isEmpty()) m_endpoint = QUrl(QString::fromUtf8(endpoint));
     connect(m_sendButton, &QPushButton::clicked, this, &Copilot::onSendMessageClicked);
     connect(m_chatInput, &QLineEdit::returnPressed, this, &Copilot::onSendMessageClicked);
 }
 
 void Copilot::onSystemDataUpdated(const SystemData &data)
 {
+    static const int hopProbe = SelfProfiler::probe("hop.monitor-to-copilot");
+    if (data.sampledAtNs > 0) SelfProfiler::record(hopProbe, data.sampledAtNs, SelfProfiler::now());
     m_lastSystemData = data;
 }
 
+void Copilot::onAlertsRaised(const QList<MonitorAlert> &alerts)
+{
+    // One automatic explanation per minute at most, and never on top of a turn in flight.
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (!m_autoExplainCheck->isChecked() || m_turnStartNs >= 0 || now - m_lastAutoExplainMs < 60000) return;
+    m_lastAutoExplainMs = now;
+
+    QString prompt = "The system monitor just raised these alerts:\n";
+    for (const MonitorAlert &alert : alerts) prompt += "- " + alert.message + "\n";
+    prompt += "Briefly explain the likely cause and what I should check. Use the available tools if needed.";
+    sendMessage(prompt);
+}
+
 QWidget* Copilot::createAssistantTab()
 {
     QWidget *assistantTab = new QWidget();
@@ -35,16 +62,107 @@ QWidget* Copilot::createAssistantTab()
     inputLayout->addWidget(m_chatInput);
     inputLayout->addWidget(m_sendButton);
     layout->addLayout(inputLayout);
+
+    m_latencyPanel = new QWidget();
+    QVBoxLayout *latencyLayout = new QVBoxLayout(m_latencyPanel);
+    latencyLayout->setContentsMargins(0, 0, 0, 0);
+    m_latencyTable = new QTableWidget(CopilotLatency::StageCount, 6);
+    m_latencyTable->setHorizontalHeaderLabels({"Stage", "Count", "p50 (ms)", "p90 (ms)", "p99 (ms)", "Max (ms)"});
+    m_latencyTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_latencyTable->verticalHeader()->setVisible(false);
+    m_latencyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    latencyLayout->addWidget(m_latencyTable);
+    QHBoxLayout *latencyButtons = new QHBoxLayout();
+    QPushButton *resetButton = new QPushButton("Reset");
+    QPushButton *dumpButton = new QPushButton("Dump JSON...");
+    connect(resetButton, &QPushButton::clicked, this, &Copilot::resetLatency);
+    connect(dumpButton, &QPushButton::clicked, this, &Copilot::onDumpLatencyClicked);
+    latencyButtons->addStretch();
+    latencyButtons->addWidget(resetButton);
+    latencyButtons->addWidget(dumpButton);
+    latencyLayout->addLayout(latencyButtons);
+    m_latencyPanel->setVisible(false);
+    layout->addWidget(m_latencyPanel);
+
+    QPushButton *latencyToggle = new QPushButton("Latency");
+    latencyToggle->setCheckable(true);
+    connect(latencyToggle, &QPushButton::toggled, this, [this](bool checked) {
+        m_latencyPanel->setVisible(checked);
+        if (checked) refreshLatencyTable();
+    });
+    inputLayout->addWidget(latencyToggle);
+    inputLayout->addWidget(m_autoExplainCheck);
+    refreshLatencyTable();
     return assistantTab;
 }
 
+void Copilot::refreshLatencyTable()
+{
+    if (!m_latencyTable || !m_latencyPanel->isVisible()) return;
+    auto ms = [](quint64 ns) { return QString::number(ns / 1e6, 'f', 2); };
+    for (int i = 0; i < CopilotLatency::StageCount; ++i) {
+        const auto stage = static_cast<CopilotLatency::Stage>(i);
+        const LatencyHistogram &h = m_latency.stage(stage);
+        const QStringList cells = {CopilotLatency::stageName(stage), QString::number(h.count()),
+                                   ms(h.percentile(50)), ms(h.percentile(90)), ms(h.percentile(99)), ms(h.max())};
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = m_latencyTable->item(i, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_latencyTable->setItem(i, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+}
+
+void Copilot::resetLatency()
+{
+    m_latency.reset();
+    refreshLatencyTable();
+}
+
+void Copilot::onDumpLatencyClicked()
+{
+    QString path = QFileDialog::getSaveFileName(nullptr, "Dump Copilot Latency", "copilot-latency.json", "JSON (*.json)");
+    if (path.isEmpty()) return;
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(nullptr, "Error", "Could not write " + path);
+        return;
+    }
+    file.write(QJsonDocument(m_latency.toJson()).toJson());
+}
+
+void Copilot::resetConversation()
+{
+    m_chatConversationHistory = QJsonArray();
+    m_chatHistory->clear();
+    m_turnStartNs = -1;
+}
+
+void Copilot::finishTurn()
+{
+    if (m_turnStartNs >= 0) {
+        m_latency.record(CopilotLatency::EndToEnd, m_turnStartNs);
+        m_turnStartNs = -1;
+    }
+    refreshLatencyTable();
+    emit turnFinished();
+}
+
 void Copilot::onSendMessageClicked()
 {
     QString userInput = m_chatInput->text().trimmed();
     if (userInput.isEmpty()) return;
+    m_chatInput->clear();
+    sendMessage(userInput);
+}
 
+void Copilot::sendMessage(const QString &userInput)
+{
+    m_turnStartNs = m_latency.now();
     appendToChatHistory("User", userInput);
-    m_chatInput->clear();
 
     QJsonObject userPart;
     userPart["text"] = userInput;
@@ -56,16 +174,23 @@ void Copilot::onSendMessageClicked()
     sendChatRequest();
 }
 
+QUrl Copilot::endpointUrl(const QString &apiKey) const
+{
+    if (m_endpoint.isValid()) return m_endpoint;
+    return QUrl("https://generativelanguage.googleapis.com/v1beta/models/gemini-1.5-flash-latest:generateContent?key=" + apiKey);
+}
+
 void Copilot::sendChatRequest()
 {
+    const qint64 buildStart = m_latency.now();
     QString apiKey = getApiKey();
-    if (apiKey.isEmpty()) {
+    if (apiKey.isEmpty() && !m_endpoint.isValid()) {
         appendToChatHistory("System", "API Key not found. Please check your .env file.");
+        finishTurn();
         return;
     }
 
-    QString url = "https://generativelanguage.googleapis.com/v1beta/models/gemini-1.5-flash-latest:generateContent?key=" + apiKey;
-    QNetworkRequest request(url);
+    QNetworkRequest request(endpointUrl(apiKey));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
     QJsonObject functionDeclaration;
@@ -83,7 +208,7 @@ void Copilot::sendChatRequest()
 
     QJsonObject functionDeclarationSystemInfo;
     functionDeclarationSystemInfo["name"] = "getSystemInfo";
-    functionDeclarationSystemInfo["description"] = "Retrieves comprehensive system information including CPU, memory, disk, network usage, and process list.";
+    functionDeclarationSystemInfo["description"] = "Retrieves comprehensive system information including CPU, memory, disk, network usage, per-interface network counters, per-device disk I/O, usage of every mounted filesystem, the busiest cgroups (slices, services, containers), temperature and fan sensors, CPU clock, the process count and the 25 largest processes by memory and by CPU.";
     QJsonObject parametersSystemInfo;
     parametersSystemInfo["type"] = "OBJECT";
     parametersSystemInfo["properties"] = QJsonObject(); // No properties for this function
@@ -141,28 +266,94 @@ void Copilot::sendChatRequest()
     parametersFind["properties"] = propertiesFind;
     functionDeclarationFindProcessPid["parameters"] = parametersFind;
 
+    QJsonObject functionDeclarationProcessDetails;
+    functionDeclarationProcessDetails["name"] = "getProcessDetails";
+    functionDeclarationProcessDetails["description"] = "Returns the owner, state, thread count and full command line, and proportional (PSS) and unique (USS) memory, swap and disk I/O counters and rates for a process given its PID.";
+    QJsonObject pidParamDetails;
+    pidParamDetails["type"] = "NUMBER";
+    pidParamDetails["description"] = "The PID of the process to inspect.";
+    QJsonObject propertiesDetails;
+    propertiesDetails["pid"] = pidParamDetails;
+    QJsonObject parametersDetails;
+    parametersDetails["type"] = "OBJECT";
+    parametersDetails["properties"] = propertiesDetails;
+    functionDeclarationProcessDetails["parameters"] = parametersDetails;
+
+    QJsonObject functionDeclarationTopProcesses;
+    functionDeclarationTopProcesses["name"] = "getTopProcesses";
+    functionDeclarationTopProcesses["description"] = "Returns the processes using the most memory, CPU or threads, highest first, with PID, name, owner, CPU percentage, memory, thread count and command line.";
+    QJsonObject metricParamTop;
+    metricParamTop["type"] = "STRING";
+    metricParamTop["description"] = "What to rank by: \"memory\", \"cpu\" or \"threads\". Defaults to \"memory\".";
+    QJsonObject countParamTop;
+    countParamTop["type"] = "NUMBER";
+    countParamTop["description"] = QString("How many processes to return, at most %1. Defaults to 10.").arg(int(ProcessRanking::Depth));
+    QJsonObject propertiesTop;
+    propertiesTop["metric"] = metricParamTop;
+    propertiesTop["count"] = countParamTop;
+    QJsonObject parametersTop;
+    parametersTop["type"] = "OBJECT";
+    parametersTop["properties"] = propertiesTop;
+    functionDeclarationTopProcesses["parameters"] = parametersTop;
+
+    QJsonObject functionDeclarationConnections;
+    functionDeclarationConnections["name"] = "getConnections";
+    functionDeclarationConnections["description"] = "Lists TCP and UDP sockets (or unix sockets) with state, local and remote address, owning process, queue sizes and TCP throughput, plus the processes holding the most connections. Use this instead of running ss or netstat, e.g. to find which process owns a port or opens many connections.";
+    QJsonObject pidParamConnections;
+    pidParamConnections["type"] = "NUMBER";
+    pidParamConnections["description"] = "Only sockets owned by this PID.";
+    QJsonObject portParamConnections;
+    portParamConnections["type"] = "NUMBER";
+    portParamConnections["description"] = "Only sockets whose local or remote port is this.";
+    QJsonObject stateParamConnections;
+    stateParamConnections["type"] = "STRING";
+    stateParamConnections["description"] = "Only sockets in this state, e.g. LISTEN, ESTAB, TIME-WAIT, UNCONN.";
+    QJsonObject protocolParamConnections;
+    protocolParamConnections["type"] = "STRING";
+    protocolParamConnections["description"] = "\"tcp\", \"udp\" or \"unix\". Defaults to TCP and UDP.";
+    QJsonObject limitParamConnections;
+    limitParamConnections["type"] = "NUMBER";
+    limitParamConnections["description"] = "Maximum number of sockets to list, at most 200. Defaults to 50.";
+    QJsonObject propertiesConnections;
+    propertiesConnections["pid"] = pidParamConnections;
+    propertiesConnections["port"] = portParamConnections;
+    propertiesConnections["state"] = stateParamConnections;
+    propertiesConnections["protocol"] = protocolParamConnections;
+    propertiesConnections["limit"] = limitParamConnections;
+    QJsonObject parametersConnections;
+    parametersConnections["type"] = "OBJECT";
+    parametersConnections["properties"] = propertiesConnections;
+    functionDeclarationConnections["parameters"] = parametersConnections;
+
     QJsonObject tool;
-    tool["function_declarations"] = QJsonArray({functionDeclaration, functionDeclarationSystemInfo, functionDeclarationKillProcess, functionDeclarationStopProcess, functionDeclarationResumeProcess, functionDeclarationFindProcessPid});
+    tool["function_declarations"] = QJsonArray({functionDeclaration, functionDeclarationSystemInfo, functionDeclarationKillProcess, functionDeclarationStopProcess, functionDeclarationResumeProcess, functionDeclarationFindProcessPid, functionDeclarationProcessDetails, functionDeclarationTopProcesses, functionDeclarationConnections});
 
     QJsonObject payload;
     payload["contents"] = m_chatConversationHistory;
     payload["tools"] = QJsonArray({tool});
+    m_latency.record(CopilotLatency::RequestBuild, buildStart);
 
+    const qint64 serializeStart = m_latency.now();
     QJsonDocument doc(payload);
     QByteArray data = doc.toJson();
+    m_latency.record(CopilotLatency::Serialize, serializeStart);
 
     QNetworkReply *reply = m_networkManager->post(request, data);
+    reply->setProperty("sentAtNs", m_latency.now());
     connect(reply, &QNetworkReply::finished, this, [this, reply]() { onChatReplyFinished(reply); });
 }
 
 void Copilot::onChatReplyFinished(QNetworkReply* reply)
 {
+    m_latency.record(CopilotLatency::Network, reply->property("sentAtNs").toLongLong());
     if (reply->error() != QNetworkReply::NoError) {
         appendToChatHistory("System", "Network Error: " + reply->errorString() + "\n" + reply->readAll());
         reply->deleteLater();
+        finishTurn();
         return;
     }
 
+    const qint64 parseStart = m_latency.now();
     QByteArray response_data = reply->readAll();
     reply->deleteLater();
     QJsonDocument jsonDoc = QJsonDocument::fromJson(response_data);
@@ -170,6 +361,7 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
 
     if (!jsonObj.contains("candidates") || !jsonObj["candidates"].isArray()) {
         appendToChatHistory("System", "Invalid API response format.");
+        finishTurn();
         return;
     }
 
@@ -182,18 +374,15 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
     modelTurn["role"] = "model";
     modelTurn["parts"] = parts;
     m_chatConversationHistory.append(modelTurn);
+    m_latency.record(CopilotLatency::Parse, parseStart);
 
     if (firstPart.contains("functionCall")) {
+        const qint64 toolStart = m_latency.now();
         QJsonObject functionCall = firstPart["functionCall"].toObject();
         QString functionName = functionCall["name"].toString();
         QJsonObject args = functionCall["args"].toObject();
         QString command = args["command"].toString();
 
-        QMessageBox::StandardButton confirmation;
-        confirmation = QMessageBox::question(nullptr, "Confirm Command Execution",
-            QString("The AI assistant wants to run the following command:\n\n%1\n\nDo you approve?").arg(command),
-            QMessageBox::Yes | QMessageBox::No);
-
         if (functionName == "run_shell_command") {
             QMessageBox::StandardButton confirmation;
             confirmation = QMessageBox::question(nullptr, "Confirm Command Execution",
@@ -202,7 +391,7 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
 
             if (confirmation == QMessageBox::Yes) {
                 QProcess *process = new QProcess(this);
-                connect(process, &QProcess::finished, this, [this, process, functionName](int exitCode, QProcess::ExitStatus exitStatus){
+                connect(process, &QProcess::finished, this, [this, process, functionName, toolStart](int exitCode, QProcess::ExitStatus exitStatus){
                     QString output = process->readAllStandardOutput();
                     if (exitStatus != QProcess::NormalExit || exitCode != 0) {
                         output += "\nError: " + process->readAllStandardError();
@@ -223,10 +412,12 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
                     toolTurn["parts"] = QJsonArray({toolPart});
 
                     m_chatConversationHistory.append(toolTurn);
+                    m_latency.recordTool(functionName, toolStart);
 
                     sendChatRequest();
                     process->deleteLater();
                 });
+                process->setChildProcessModifier(&CgroupCollector::restoreFileLimit);
                 process->start("bash", {"-c", command});
             } else {
                 appendToChatHistory("System", "Command execution denied by user.");
@@ -241,6 +432,7 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
                 toolTurn["role"] = "tool";
                 toolTurn["parts"] = QJsonArray({toolPart});
                 m_chatConversationHistory.append(toolTurn);
+                m_latency.recordTool(functionName, toolStart);
                 sendChatRequest();
             }
         } else if (functionName == "getSystemInfo") {
@@ -248,21 +440,124 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
             systemInfoJson["hostname"] = m_lastSystemData.hostname;
             systemInfoJson["kernelVersion"] = m_lastSystemData.kernelVersion;
             systemInfoJson["cpuModel"] = m_lastSystemData.cpuModel;
+            systemInfoJson["logicalCpus"] = m_lastSystemData.logicalCpus;
+            systemInfoJson["physicalCores"] = m_lastSystemData.physicalCores;
             systemInfoJson["cpuPercentage"] = m_lastSystemData.cpuPercentage;
+            if (m_lastSystemData.cpuTemperature > 0) systemInfoJson["cpuTemperatureC"] = m_lastSystemData.cpuTemperature;
+            if (m_lastSystemData.cpuFrequencyMHz > 0) {
+                systemInfoJson["cpuFrequencyMHz"] = m_lastSystemData.cpuFrequencyMHz;
+                systemInfoJson["cpuMaxFrequencyMHz"] = m_lastSystemData.cpuMaxMHz;
+            }
             systemInfoJson["memPercentage"] = m_lastSystemData.memPercentage;
             systemInfoJson["totalSystemMemoryMB"] = m_lastSystemData.totalSystemMemoryMB;
             systemInfoJson["diskPercentage"] = m_lastSystemData.diskPercentage;
             systemInfoJson["netDownSpeed_KBps"] = m_lastSystemData.netDownSpeed_KBps;
             systemInfoJson["netUpSpeed_KBps"] = m_lastSystemData.netUpSpeed_KBps;
 
+            QJsonArray interfacesArray;
+            for (const NetworkInterfaceData &iface : m_lastSystemData.interfaces) {
+                QJsonObject ifaceObject;
+                ifaceObject["name"] = iface.name;
+                ifaceObject["rxKBps"] = iface.rxKBps;
+                ifaceObject["txKBps"] = iface.txKBps;
+                ifaceObject["rxBytes"] = static_cast<double>(iface.rxBytes);
+                ifaceObject["txBytes"] = static_cast<double>(iface.txBytes);
+                ifaceObject["rxPackets"] = static_cast<double>(iface.rxPackets);
+                ifaceObject["txPackets"] = static_cast<double>(iface.txPackets);
+                ifaceObject["rxErrors"] = static_cast<double>(iface.rxErrors);
+                ifaceObject["txErrors"] = static_cast<double>(iface.txErrors);
+                ifaceObject["rxDrops"] = static_cast<double>(iface.rxDrops);
+                ifaceObject["txDrops"] = static_cast<double>(iface.txDrops);
+                interfacesArray.append(ifaceObject);
+            }
+            systemInfoJson["interfaces"] = interfacesArray;
+
+            QJsonArray disksArray;
+            for (const DiskDeviceData &disk : m_lastSystemData.disks) {
+                QJsonObject diskObject;
+                diskObject["name"] = disk.name;
+                diskObject["readIops"] = disk.readIops;
+                diskObject["writeIops"] = disk.writeIops;
+                diskObject["readKBps"] = disk.readKBps;
+                diskObject["writeKBps"] = disk.writeKBps;
+                diskObject["readLatencyMs"] = disk.readLatencyMs;
+                diskObject["writeLatencyMs"] = disk.writeLatencyMs;
+                diskObject["busyPercentage"] = disk.busyPercentage;
+                disksArray.append(diskObject);
+            }
+            systemInfoJson["disks"] = disksArray;
+
+            QJsonArray mountsArray;
+            for (const MountData &mount : m_lastSystemData.mounts) {
+                QJsonObject mountObject;
+                mountObject["mountPoint"] = mount.mountPoint;
+                mountObject["device"] = mount.device;
+                mountObject["fsType"] = mount.fsType;
+                mountObject["totalMB"] = static_cast<double>(mount.totalBytes / (1024 * 1024));
+                mountObject["freeMB"] = static_cast<double>(mount.freeBytes / (1024 * 1024));
+                mountObject["usedPercentage"] = mount.usedPercentage;
+                mountsArray.append(mountObject);
+            }
+            systemInfoJson["mounts"] = mountsArray;
+
+            // Hosts can have thousands of cgroups; send the busiest slices and
+            // the services or containers directly below them.
+            QList<const CgroupData *> cgroups;
+            for (const CgroupData &cgroup : m_lastSystemData.cgroups) {
+                if (cgroup.path != "/" && cgroup.path.count('/') <= 2) cgroups.append(&cgroup);
+            }
+            std::sort(cgroups.begin(), cgroups.end(), [](const CgroupData *a, const CgroupData *b) {
+                return a->cpuPercentage != b->cpuPercentage ? a->cpuPercentage > b->cpuPercentage : a->memoryBytes > b->memoryBytes;
+            });
+            QJsonArray cgroupsArray;
+            for (int i = 0; i < cgroups.size() && i < 30; ++i) {
+                const CgroupData &cgroup = *cgroups[i];
+                QJsonObject cgroupObject;
+                cgroupObject["path"] = cgroup.path;
+                cgroupObject["cpuPercentage"] = cgroup.cpuPercentage;
+                cgroupObject["memoryMB"] = static_cast<double>(cgroup.memoryBytes / (1024 * 1024));
+                cgroupObject["anonMB"] = static_cast<double>(cgroup.anonBytes / (1024 * 1024));
+                cgroupObject["fileMB"] = static_cast<double>(cgroup.fileBytes / (1024 * 1024));
+                cgroupObject["ioReadKBps"] = cgroup.ioReadKBps;
+                cgroupObject["ioWriteKBps"] = cgroup.ioWriteKBps;
+                cgroupObject["cpuPressure"] = cgroup.cpuPressure;
+                cgroupObject["memoryPressure"] = cgroup.memoryPressure;
+                cgroupObject["ioPressure"] = cgroup.ioPressure;
+                cgroupsArray.append(cgroupObject);
+            }
+            systemInfoJson["cgroups"] = cgroupsArray;
+            systemInfoJson["cgroupCount"] = static_cast<int>(m_lastSystemData.cgroups.size());
+
+            QJsonArray sensorsArray;
+            for (const SensorData &sensor : m_lastSystemData.sensors) {
+                QJsonObject sensorObject;
+                sensorObject["chip"] = sensor.chip;
+                sensorObject["label"] = sensor.label;
+                sensorObject[sensor.kind == SensorData::Temperature ? "celsius" : "rpm"] = sensor.value;
+                if (sensor.critical > 0) sensorObject["limitCelsius"] = sensor.critical;
+                sensorsArray.append(sensorObject);
+            }
+            systemInfoJson["sensors"] = sensorsArray;
+
+            // The heaviest processes only; getTopProcesses goes deeper.
             QJsonArray processesArray;
-            for (const ProcessData &p_data : m_lastSystemData.processes) {
-                QJsonObject processObject;
-                processObject["pid"] = p_data.pid;
-                processObject["name"] = p_data.name;
-                processObject["memUsageMB"] = p_data.memUsageMB;
-                processesArray.append(processObject);
+            QSet<int> listed;
+            for (ProcessRanking::Metric metric : {ProcessRanking::Memory, ProcessRanking::Cpu}) {
+                for (const ProcessRanking::Entry &entry : m_lastSystemData.ranking.top(metric, 25)) {
+                    const ProcessData *p_data = ProcessRanking::find(m_lastSystemData.processes, entry.pid);
+                    if (!p_data || listed.contains(entry.pid)) continue;
+                    listed.insert(entry.pid);
+                    QJsonObject processObject;
+                    processObject["pid"] = p_data->pid;
+                    processObject["name"] = p_data->name;
+                    processObject["memUsageMB"] = p_data->memUsageMB;
+                    processObject["cpuPercentage"] = p_data->cpuPercentage;
+                    if (!p_data->user.isEmpty()) processObject["user"] = p_data->user;
+                    if (p_data->threads > 0) processObject["threads"] = p_data->threads;
+                    processesArray.append(processObject);
+                }
             }
+            systemInfoJson["processCount"] = m_lastSystemData.processes.size();
             systemInfoJson["processes"] = processesArray;
 
             QJsonObject functionResponse;
@@ -277,6 +572,7 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
             toolTurn["parts"] = QJsonArray({toolPart});
 
             m_chatConversationHistory.append(toolTurn);
+            m_latency.recordTool(functionName, toolStart);
 
             sendChatRequest();
         } else if (functionName == "killProcess" || functionName == "stopProcess" || functionName == "resumeProcess") {
@@ -286,8 +582,31 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
             else if (functionName == "stopProcess") command = QString("kill -STOP %1").arg(pid);
             else if (functionName == "resumeProcess") command = QString("kill -CONT %1").arg(pid);
 
+            // The request can come from a turn nobody typed (auto-explain), and
+            // alert text quotes process names anyone can pick.
+            if (functionName != "resumeProcess") {
+                QString processName = "unknown process";
+                for (const ProcessData &p_data : m_lastSystemData.processes) {
+                    if (p_data.pid == pid) {
+                        processName = p_data.name;
+                        break;
+                    }
+                }
+                const QMessageBox::StandardButton confirmation = QMessageBox::question(nullptr, "Confirm Process Signal",
+                    QString("The AI assistant wants to %1 %2 (PID %3).\n\nDo you approve?")
+                        .arg(functionName == "killProcess" ? "kill" : "stop", processName).arg(pid),
+                    QMessageBox::Yes | QMessageBox::No);
+                if (confirmation != QMessageBox::Yes) {
+                    appendToChatHistory("System", "Process signal denied by user.");
+                    QJsonObject responseContent;
+                    responseContent["content"] = "User denied the action.";
+                    sendToolResponse(functionName, responseContent, toolStart);
+                    return;
+                }
+            }
+
             QProcess *process = new QProcess(this);
-            connect(process, &QProcess::finished, this, [this, process, functionName, pid](int exitCode, QProcess::ExitStatus exitStatus){
+            connect(process, &QProcess::finished, this, [this, process, functionName, pid, toolStart](int exitCode, QProcess::ExitStatus exitStatus){
                 QString output;
                 if (exitStatus == QProcess::NormalExit && exitCode == 0) {
                     QString funcNameCopy = functionName; // Create a non-const copy
@@ -312,9 +631,11 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
                 toolTurn["parts"] = QJsonArray({toolPart});
 
                 m_chatConversationHistory.append(toolTurn);
+                m_latency.recordTool(functionName, toolStart);
                 sendChatRequest();
                 process->deleteLater();
             });
+            process->setChildProcessModifier(&CgroupCollector::restoreFileLimit);
             process->start("bash", {"-c", command});
         } else if (functionName == "findProcessPid") {
             QString processName = args["name"].toString();
@@ -348,18 +669,210 @@ void Copilot::onChatReplyFinished(QNetworkReply* reply)
             toolTurn["parts"] = QJsonArray({toolPart});
 
             m_chatConversationHistory.append(toolTurn);
+            m_latency.recordTool(functionName, toolStart);
             sendChatRequest();
+        } else if (functionName == "getProcessDetails") {
+            const int pid = args["pid"].toInt();
+            if (!m_detailCache || !m_detailContext) {
+                QJsonObject responseContent;
+                responseContent["error"] = "Process details are not available.";
+                sendToolResponse(functionName, responseContent, toolStart);
+            } else {
+                // smaps_rollup of a large process takes milliseconds, so it is read
+                // in the monitor's thread; the turn continues when it is back.
+                ProcessDetailCache *cache = m_detailCache;
+                QMetaObject::invokeMethod(m_detailContext, [this, cache, pid, functionName, toolStart]() {
+                    const ProcessDetail detail = cache->get(pid, 2000);
+                    QMetaObject::invokeMethod(this, [this, pid, detail, functionName, toolStart]() {
+                        sendToolResponse(functionName, processDetailsResponse(pid, detail), toolStart);
+                    }, Qt::QueuedConnection);
+                }, Qt::QueuedConnection);
+            }
+        } else if (functionName == "getTopProcesses") {
+            ProcessRanking::Metric metric = ProcessRanking::Memory;
+            QJsonObject responseContent;
+            if (args.contains("metric") && !ProcessRanking::metricFromName(args["metric"].toString(), &metric)) {
+                responseContent["error"] = QString("Unknown metric '%1'; use memory, cpu or threads.").arg(args["metric"].toString());
+            } else {
+                const int count = args.contains("count") ? args["count"].toInt() : 10;
+                QJsonArray processesArray;
+                for (const ProcessRanking::Entry &entry : m_lastSystemData.ranking.top(metric, count)) {
+                    const ProcessData *p_data = ProcessRanking::find(m_lastSystemData.processes, entry.pid);
+                    if (!p_data) continue;
+                    QJsonObject processObject;
+                    processObject["pid"] = p_data->pid;
+                    processObject["name"] = p_data->name;
+                    processObject["user"] = p_data->user;
+                    processObject["cpuPercentage"] = p_data->cpuPercentage;
+                    processObject["memUsageMB"] = p_data->memUsageMB;
+                    processObject["threads"] = p_data->threads;
+                    processObject["commandLine"] = p_data->commandLine;
+                    processesArray.append(processObject);
+                }
+                responseContent["processCount"] = m_lastSystemData.processes.size();
+                responseContent["processes"] = processesArray;
+            }
+
+            QJsonObject functionResponse;
+            functionResponse["name"] = functionName;
+            functionResponse["response"] = responseContent;
+
+            QJsonObject toolPart;
+            toolPart["functionResponse"] = functionResponse;
+
+            QJsonObject toolTurn;
+            toolTurn["role"] = "tool";
+            toolTurn["parts"] = QJsonArray({toolPart});
+
+            m_chatConversationHistory.append(toolTurn);
+            m_latency.recordTool(functionName, toolStart);
+            sendChatRequest();
+        } else if (functionName == "getConnections") {
+            const int pid = args["pid"].toInt();
+            const int port = args["port"].toInt();
+            const QString state = args["state"].toString().toUpper();
+            const QString protocol = args["protocol"].toString().toLower();
+            const int limit = qBound(1, args.contains("limit") ? args["limit"].toInt() : 50, 200);
+            QJsonObject responseContent;
+            if (m_lastSystemData.sockets.isEmpty()) {
+                responseContent["error"] = "Socket data is not available (replaying a capture, or sock_diag is not supported).";
+            } else {
+                int matched = 0;
+                QHash<int, int> connectionsByPid;
+                QJsonArray socketsArray;
+                for (const SocketData &socket : m_lastSystemData.sockets) {
+                    if (protocol.isEmpty() ? socket.protocol == SocketData::Unix
+                                           : !QString(SocketCollector::protocolName(socket)).startsWith(protocol)) {
+                        continue;
+                    }
+                    if (pid > 0 && socket.pid != pid) continue;
+                    if (port > 0 && socket.localPort != port && socket.remotePort != port) continue;
+                    if (!state.isEmpty() && state != QLatin1String(SocketCollector::stateName(socket))) continue;
+                    ++matched;
+                    if (socket.pid > 0) ++connectionsByPid[socket.pid];
+                    if (socketsArray.size() >= limit) continue;
+                    QJsonObject socketObject;
+                    socketObject["protocol"] = SocketCollector::protocolName(socket);
+                    socketObject["state"] = SocketCollector::stateName(socket);
+                    socketObject["local"] = SocketCollector::localText(socket);
+                    socketObject["remote"] = SocketCollector::remoteText(socket);
+                    if (socket.pid > 0) {
+                        socketObject["pid"] = socket.pid;
+                        if (const ProcessData *owner = ProcessRanking::find(m_lastSystemData.processes, socket.pid))
+                            socketObject["process"] = owner->name;
+                    }
+                    if (socket.receiveQueue || socket.sendQueue) {
+                        socketObject["recvQueue"] = static_cast<double>(socket.receiveQueue);
+                        socketObject["sendQueue"] = static_cast<double>(socket.sendQueue);
+                    }
+                    if (socket.rxKBps > 0 || socket.txKBps > 0) {
+                        socketObject["rxKBps"] = socket.rxKBps;
+                        socketObject["txKBps"] = socket.txKBps;
+                    }
+                    socketsArray.append(socketObject);
+                }
+                QList<QPair<int, int>> owners;
+                for (auto it = connectionsByPid.constBegin(); it != connectionsByPid.constEnd(); ++it) owners.append({it.value(), it.key()});
+                std::sort(owners.begin(), owners.end(), std::greater<QPair<int, int>>());
+                QJsonArray ownersArray;
+                for (int i = 0; i < owners.size() && i < 10; ++i) {
+                    QJsonObject ownerObject;
+                    ownerObject["pid"] = owners[i].second;
+                    ownerObject["sockets"] = owners[i].first;
+                    if (const ProcessData *owner = ProcessRanking::find(m_lastSystemData.processes, owners[i].second)) {
+                        ownerObject["name"] = owner->name;
+                        ownerObject["rxKBps"] = owner->netRxKBps;
+                        ownerObject["txKBps"] = owner->netTxKBps;
+                    }
+                    ownersArray.append(ownerObject);
+                }
+                responseContent["matched"] = matched;
+                responseContent["sockets"] = socketsArray;
+                responseContent["topOwners"] = ownersArray;
+            }
+
+            QJsonObject functionResponse;
+            functionResponse["name"] = functionName;
+            functionResponse["response"] = responseContent;
+
+            QJsonObject toolPart;
+            toolPart["functionResponse"] = functionResponse;
+
+            QJsonObject toolTurn;
+            toolTurn["role"] = "tool";
+            toolTurn["parts"] = QJsonArray({toolPart});
+
+            m_chatConversationHistory.append(toolTurn);
+            m_latency.recordTool(functionName, toolStart);
+            sendChatRequest();
+        } else {
+            appendToChatHistory("System", "Unknown tool requested: " + functionName);
+            finishTurn();
         }
 
     } else if (firstPart.contains("text")) {
         QString responseText = firstPart["text"].toString();
         appendToChatHistory("AI Assistant", responseText);
+        finishTurn();
+    } else {
+        finishTurn();
     }
 }
 
+QJsonObject Copilot::processDetailsResponse(int pid, const ProcessDetail &detail) const
+{
+    QJsonObject responseContent;
+    if (!detail.memoryValid && !detail.ioValid) {
+        responseContent["error"] = QString("Could not read details for PID %1 (process gone or permission denied).").arg(pid);
+        return responseContent;
+    }
+    responseContent["pid"] = pid;
+    if (const ProcessData *p_data = ProcessRanking::find(m_lastSystemData.processes, pid)) {
+        responseContent["name"] = p_data->name;
+        responseContent["rss_mb"] = p_data->memUsageMB;
+        responseContent["cpu_percentage"] = p_data->cpuPercentage;
+        responseContent["user"] = p_data->user;
+        responseContent["state"] = QString(QChar(p_data->state));
+        responseContent["threads"] = p_data->threads;
+        responseContent["command_line"] = p_data->commandLine;
+    }
+    if (detail.memoryValid) {
+        responseContent["pss_mb"] = detail.pssMB;
+        responseContent["uss_mb"] = detail.ussMB;
+        responseContent["swap_mb"] = detail.swapMB;
+    }
+    if (detail.ioValid) {
+        responseContent["read_bytes"] = static_cast<double>(detail.readBytes);
+        responseContent["write_bytes"] = static_cast<double>(detail.writeBytes);
+        responseContent["read_kbps"] = detail.readKBps;
+        responseContent["write_kbps"] = detail.writeKBps;
+    }
+    return responseContent;
+}
+
+void Copilot::sendToolResponse(const QString &functionName, const QJsonObject &responseContent, qint64 toolStart)
+{
+    QJsonObject functionResponse;
+    functionResponse["name"] = functionName;
+    functionResponse["response"] = responseContent;
+
+    QJsonObject toolPart;
+    toolPart["functionResponse"] = functionResponse;
+
+    QJsonObject toolTurn;
+    toolTurn["role"] = "tool";
+    toolTurn["parts"] = QJsonArray({toolPart});
+
+    m_chatConversationHistory.append(toolTurn);
+    m_latency.recordTool(functionName, toolStart);
+    sendChatRequest();
+}
+
 void Copilot::appendToChatHistory(const QString& author, const QString& text)
 {
+    const qint64 appendStart = m_latency.now();
     m_chatHistory->append(QString("<b>%1:</b><br>%2<br>").arg(author, text.toHtmlEscaped().replace("\n", "<br>")));
+    m_latency.record(CopilotLatency::UiAppend, appendStart);
 }
 
 QString Copilot::getApiKey()
@@ -377,13 +890,12 @@ QString Copilot::getApiKey()
 void Copilot::onExplainClicked(const QString& processName)
 {
     QString apiKey = getApiKey();
-    if (apiKey.isEmpty()) {
+    if (apiKey.isEmpty() && !m_endpoint.isValid()) {
         QMessageBox::critical(nullptr, "API Key Error", "Could not find GEMINI_API_KEY in the embedded .env file.");
         return;
     }
 
-    QString url = "https://generativelanguage.googleapis.com/v1beta/models/gemini-1.5-flash-latest:generateContent?key=" + apiKey;
-    QNetworkRequest request(url);
+    QNetworkRequest request(endpointUrl(apiKey));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
     QJsonObject textPart; textPart["text"] = QString("Explain the purpose of the Linux process named '%1'. What does it typically do, and is it safe? Keep the explanation concise and easy to understand for a non-expert.").arg(processName);
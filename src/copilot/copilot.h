@@ -5,12 +5,18 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QJsonArray>
+#include <QJsonObject>
 #include <QWidget>
 #include <QLineEdit>
 #include <QTextEdit>
 #include <QPushButton>
+#include <QTableWidget>
+#include <QUrl>
+#include <QCheckBox>
 #include "../common/systemdata.h"
+#include "../common/alert.h"
 #include "../core/systemmonitor.h"
+#include "copilotlatency.h"
 
 class Copilot : public QObject
 {
@@ -20,23 +26,43 @@ public:
     explicit Copilot(QObject *parent = nullptr);
     QWidget* createAssistantTab();
 
+    // Overrides the Gemini endpoint (e.g. a local mock); no API key is needed then.
+    void setEndpoint(const QUrl &endpoint) { m_endpoint = endpoint; }
+    void resetConversation();
+    const CopilotLatency &latency() const { return m_latency; }
+    void resetLatency();
+    // Details are read in `context`'s thread (the monitor's), never in the GUI thread.
+    void setProcessDetailCache(ProcessDetailCache *cache, QObject *context)
+    {
+        m_detailCache = cache;
+        m_detailContext = context;
+    }
+
 public slots:
+    void sendMessage(const QString &text);
     void onExplainClicked(const QString& processName);
     void onSystemDataUpdated(const SystemData &data);
+    void onAlertsRaised(const QList<MonitorAlert> &alerts);
 
 signals: // New signal for requesting system data
     void requestSystemData();
+    void turnFinished();
 
 private slots:
     void onSendMessageClicked();
     void onChatReplyFinished(QNetworkReply* reply);
     void onExplainReplyFinished(QNetworkReply* reply);
-
+    void onDumpLatencyClicked();
 
 private:
     QString getApiKey();
+    QUrl endpointUrl(const QString &apiKey) const;
     void sendChatRequest();
+    void finishTurn();
     void appendToChatHistory(const QString& author, const QString& text);
+    QJsonObject processDetailsResponse(int pid, const ProcessDetail &detail) const;
+    void sendToolResponse(const QString &functionName, const QJsonObject &responseContent, qint64 toolStart);
+    void refreshLatencyTable();
 
     QNetworkAccessManager *m_networkManager;
     QTextEdit *m_chatHistory;
@@ -44,6 +70,16 @@ private:
     QPushButton *m_sendButton;
     QJsonArray m_chatConversationHistory;
     SystemData m_lastSystemData;
+
+    ProcessDetailCache *m_detailCache = nullptr;
+    QObject *m_detailContext = nullptr;
+    QUrl m_endpoint;
+    CopilotLatency m_latency;
+    qint64 m_turnStartNs = -1;
+    QWidget *m_latencyPanel = nullptr;
+    QTableWidget *m_latencyTable = nullptr;
+    QCheckBox *m_autoExplainCheck;
+    qint64 m_lastAutoExplainMs = 0;
 };
 
 #endif // COPILOT_H
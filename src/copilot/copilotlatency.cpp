@@ -0,0 +1,50 @@
+#include "copilotlatency.h"
+
+CopilotLatency::CopilotLatency()
+{
+    m_clock.start();
+}
+
+void CopilotLatency::recordTool(const QString &toolName, qint64 startNs)
+{
+    const qint64 elapsed = now() - startNs;
+    m_stages[ToolExecution].record(elapsed);
+    m_tools[toolName].record(elapsed);
+}
+
+QString CopilotLatency::stageName(Stage stage)
+{
+    switch (stage) {
+    case RequestBuild: return "request_build";
+    case Serialize: return "serialize";
+    case Network: return "network";
+    case Parse: return "parse";
+    case ToolExecution: return "tool_execution";
+    case UiAppend: return "ui_append";
+    case EndToEnd: return "end_to_end";
+    case StageCount: break;
+    }
+    return QString();
+}
+
+QJsonObject CopilotLatency::toJson() const
+{
+    QJsonObject stages;
+    for (int i = 0; i < StageCount; ++i) {
+        stages[stageName(static_cast<Stage>(i))] = m_stages[i].toJson();
+    }
+    QJsonObject tools;
+    for (auto it = m_tools.constBegin(); it != m_tools.constEnd(); ++it) {
+        tools[it.key()] = it.value().toJson();
+    }
+    QJsonObject root;
+    root["stages"] = stages;
+    root["tools"] = tools;
+    return root;
+}
+
+void CopilotLatency::reset()
+{
+    for (LatencyHistogram &h : m_stages) h.reset();
+    m_tools.clear();
+}
@@ -0,0 +1,45 @@
+#ifndef COPILOTLATENCY_H
+#define COPILOTLATENCY_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include "../common/latencyhistogram.h"
+
+// Per-stage latency histograms for the copilot request/response cycle.
+// All timestamps come from a single monotonic QElapsedTimer.
+class CopilotLatency
+{
+public:
+    enum Stage {
+        RequestBuild,   // tool declarations + payload object
+        Serialize,      // QJsonDocument::toJson
+        Network,        // post() until QNetworkReply::finished
+        Parse,          // readAll + fromJson + candidate extraction
+        ToolExecution,  // functionCall dispatch until the tool turn is appended
+        UiAppend,       // appendToChatHistory
+        EndToEnd,       // user message until the final model text is shown
+        StageCount
+    };
+
+    CopilotLatency();
+
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+    void record(Stage stage, qint64 startNs) { m_stages[stage].record(now() - startNs); }
+    void recordTool(const QString &toolName, qint64 startNs);
+
+    const LatencyHistogram &stage(Stage stage) const { return m_stages[stage]; }
+    const QMap<QString, LatencyHistogram> &tools() const { return m_tools; }
+
+    static QString stageName(Stage stage);
+    QJsonObject toJson() const;
+    void reset();
+
+private:
+    QElapsedTimer m_clock;
+    LatencyHistogram m_stages[StageCount];
+    QMap<QString, LatencyHistogram> m_tools;
+};
+
+#endif // COPILOTLATENCY_H
@@ -0,0 +1,66 @@
+#include "agentserver.h"
+#include "selfprofiler.h"
+#include <QDebug>
+
+AgentServer::AgentServer(QObject *parent)
+    : QObject(parent),
+      m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &AgentServer::onNewConnection);
+}
+
+bool AgentServer::listen(const QHostAddress &address, quint16 port)
+{
+    return m_server->listen(address, port);
+}
+
+void AgentServer::onStaticDataReady(const SystemData &data)
+{
+    m_hello = m_encoder.encodeHello(data);
+}
+
+void AgentServer::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            for (int i = 0; i < m_clients.size(); ++i) {
+                if (m_clients[i].socket == socket) { m_clients.removeAt(i); break; }
+            }
+            socket->deleteLater();
+        });
+        // A stalled client is resynchronized with a snapshot once its send buffer drains.
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, socket]() {
+            if (socket->bytesToWrite() > 0) return;
+            for (Client &client : m_clients) {
+                if (client.socket == socket && client.stalled) resync(client);
+            }
+        });
+        qInfo() << "Agent client connected from" << socket->peerAddress().toString();
+        m_clients.append({socket, false});
+        resync(m_clients.last());
+    }
+}
+
+void AgentServer::resync(Client &client)
+{
+    if (!m_hello.isEmpty()) client.socket->write(m_hello);
+    if (m_hasSample) client.socket->write(m_encoder.encodeSnapshot());
+    client.stalled = false;
+}
+
+void AgentServer::onDynamicDataUpdated(const SystemData &data)
+{
+    PROFILE_SCOPE("agent.broadcast");
+    // Encoded even without clients so that late joiners get a current snapshot.
+    const QByteArray frame = m_encoder.encodeDelta(data);
+    m_hasSample = true;
+    for (Client &client : m_clients) {
+        if (client.stalled) continue;
+        if (client.socket->bytesToWrite() > MaxPendingBytes) {
+            client.stalled = true;
+            continue;
+        }
+        client.socket->write(frame);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef AGENTSERVER_H
+#define AGENTSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QList>
+#include "../common/systemdata.h"
+#include "../common/wireprotocol.h"
+
+// Streams this host's samples to any number of TCP clients using the wire
+// protocol. Each tick is encoded once and the same delta frame is written to
+// every client; clients that join late (or fall behind) get a snapshot.
+class AgentServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AgentServer(QObject *parent = nullptr);
+    bool listen(const QHostAddress &address, quint16 port);
+    QString errorString() const { return m_server->errorString(); }
+    // The bound port, for listen() on port 0.
+    quint16 serverPort() const { return m_server->serverPort(); }
+
+public slots:
+    void onStaticDataReady(const SystemData &data);
+    void onDynamicDataUpdated(const SystemData &data);
+
+private slots:
+    void onNewConnection();
+
+private:
+    struct Client
+    {
+        QTcpSocket *socket;
+        bool stalled;
+    };
+
+    void resync(Client &client);
+
+    static constexpr qint64 MaxPendingBytes = 1024 * 1024;
+
+    QTcpServer *m_server;
+    QList<Client> m_clients;
+    WireEncoder m_encoder;
+    QByteArray m_hello;
+    bool m_hasSample = false;
+};
+
+#endif // AGENTSERVER_H
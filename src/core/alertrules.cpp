@@ -0,0 +1,538 @@
+#include "alertrules.h"
+#include "procfs.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <signal.h>
+
+namespace {
+
+enum Dimension { Percent, MegaBytes, KiloBytesPerSec, Count };
+
+struct MetricInfo
+{
+    const char *name;
+    Dimension dimension;
+};
+
+const MetricInfo kSystemMetrics[AlertRuleEngine::SystemMetricCount] = {
+    {"cpu", Percent}, {"mem", Percent}, {"disk", Percent},
+    {"net_down", KiloBytesPerSec}, {"net_up", KiloBytesPerSec}, {"processes", Count},
+};
+
+const MetricInfo kProcessMetrics[AlertRuleEngine::ProcessMetricCount] = {
+    {"rss", MegaBytes}, {"pid", Count}, {"cpu", Percent}, {"threads", Count},
+    {"mem_rank", Count}, {"cpu_rank", Count},
+};
+
+struct Token
+{
+    enum Kind { Ident, Number, String, Op, LParen, RParen, Colon, End };
+    Kind kind = End;
+    QString text;
+    double number = 0.0;
+    QString unit;
+};
+
+bool isIdentStart(QChar c) { return c.isLetter() || c == '_'; }
+bool isIdentChar(QChar c) { return c.isLetterOrNumber() || c == '_' || c == '-' || c == '.'; }
+
+bool tokenize(const QString &line, QVector<Token> *tokens, QString *error)
+{
+    int i = 0;
+    const int n = line.size();
+    while (i < n) {
+        const QChar c = line[i];
+        if (c.isSpace()) { ++i; continue; }
+        Token token;
+        if (c.isDigit() || (c == '.' && i + 1 < n && line[i + 1].isDigit())) {
+            int start = i;
+            while (i < n && (line[i].isDigit() || line[i] == '.')) ++i;
+            bool ok = false;
+            token.kind = Token::Number;
+            token.number = line.mid(start, i - start).toDouble(&ok);
+            if (!ok) { *error = "invalid number '" + line.mid(start, i - start) + "'"; return false; }
+            start = i;
+            while (i < n && (line[i].isLetter() || line[i] == '%' || line[i] == '/')) ++i;
+            token.unit = line.mid(start, i - start).toLower();
+        } else if (isIdentStart(c)) {
+            int start = i;
+            while (i < n && isIdentChar(line[i])) ++i;
+            token.kind = Token::Ident;
+            token.text = line.mid(start, i - start);
+        } else if (c == '"') {
+            const int end = line.indexOf('"', i + 1);
+            if (end < 0) { *error = "unterminated string"; return false; }
+            token.kind = Token::String;
+            token.text = line.mid(i + 1, end - i - 1);
+            i = end + 1;
+        } else if (c == '>' || c == '<' || c == '=' || c == '!') {
+            token.kind = Token::Op;
+            token.text = c;
+            ++i;
+            if (i < n && line[i] == '=') { token.text += '='; ++i; }
+            if (token.text == "!") { *error = "unexpected '!'"; return false; }
+        } else if (c == '(') {
+            token.kind = Token::LParen; ++i;
+        } else if (c == ')') {
+            token.kind = Token::RParen; ++i;
+        } else if (c == ':') {
+            token.kind = Token::Colon; ++i;
+        } else {
+            *error = QString("unexpected character '%1'").arg(c);
+            return false;
+        }
+        tokens->append(token);
+    }
+    tokens->append(Token());
+    return true;
+}
+
+bool convertUnit(const QString &unit, Dimension dimension, double *value)
+{
+    double factor = 0.0;
+    switch (dimension) {
+    case Percent:
+        if (unit.isEmpty() || unit == "%") factor = 1.0;
+        break;
+    case MegaBytes:
+        if (unit == "b") factor = 1.0 / (1024.0 * 1024.0);
+        else if (unit == "k" || unit == "kb" || unit == "kib") factor = 1.0 / 1024.0;
+        else if (unit.isEmpty() || unit == "m" || unit == "mb" || unit == "mib") factor = 1.0;
+        else if (unit == "g" || unit == "gb" || unit == "gib") factor = 1024.0;
+        else if (unit == "t" || unit == "tb" || unit == "tib") factor = 1024.0 * 1024.0;
+        break;
+    case KiloBytesPerSec:
+        if (unit == "b/s") factor = 1.0 / 1024.0;
+        else if (unit.isEmpty() || unit == "kb/s") factor = 1.0;
+        else if (unit == "mb/s") factor = 1024.0;
+        else if (unit == "gb/s") factor = 1024.0 * 1024.0;
+        break;
+    case Count:
+        if (unit.isEmpty()) factor = 1.0;
+        else if (unit == "k") factor = 1000.0;
+        break;
+    }
+    if (factor == 0.0) return false;
+    *value *= factor;
+    return true;
+}
+
+// PF_KTHREAD in the flags field of <pid>/stat. Unreadable counts as a kernel
+// thread, so a process that vanished or is hidden is left alone.
+bool isKernelThread(ProcFs *procFs, int pid)
+{
+    constexpr quint64 kKernelThreadFlag = 0x00200000;
+    ProcParse::PidStat stat;
+    const ProcText text = procFs->readPid(pid, "stat");
+    if (text.isNull() || !ProcParse::parsePidStat(text, &stat)) return true;
+    return stat.flags & kKernelThreadFlag;
+}
+
+bool convertDuration(const QString &unit, double value, qint64 *ms)
+{
+    double factor = 0.0;
+    if (unit == "ms") factor = 1.0;
+    else if (unit.isEmpty() || unit == "s") factor = 1000.0;
+    else if (unit == "m" || unit == "min") factor = 60.0 * 1000.0;
+    else if (unit == "h") factor = 3600.0 * 1000.0;
+    if (factor == 0.0) return false;
+    *ms = static_cast<qint64>(value * factor);
+    return true;
+}
+
+} // namespace
+
+class RuleParser
+{
+public:
+    using Rule = AlertRuleEngine::Rule;
+    using Instruction = AlertRuleEngine::Instruction;
+
+    explicit RuleParser(const QVector<Token> &tokens) : m_tokens(tokens) {}
+
+    bool parse(Rule *rule, QString *error)
+    {
+        m_rule = rule;
+        m_error = error;
+        if (peek().kind == Token::Ident && m_tokens.size() > 1 && m_tokens[1].kind == Token::Colon) {
+            rule->name = next().text;
+            next();
+        }
+        if (acceptKeyword("process")) {
+            rule->perProcess = true;
+            if (acceptKeyword("named")) {
+                const Token &name = next();
+                if (name.kind != Token::Ident && name.kind != Token::String) return fail("expected a process name after 'named'");
+                rule->processName = name.text;
+            }
+        }
+        if (!parseOr()) return false;
+        if (acceptKeyword("for")) {
+            const Token &duration = next();
+            if (duration.kind != Token::Number || !convertDuration(duration.unit, duration.number, &rule->forMs))
+                return fail("expected a duration such as 30s or 5m after 'for'");
+        }
+        if (acceptKeyword("on")) {
+            const Token &ifaceToken = next();
+            if (ifaceToken.kind != Token::Ident && ifaceToken.kind != Token::String) return fail("expected an interface name after 'on'");
+            if (rule->perProcess) return fail("'on' only applies to system rules");
+            bool usesNetwork = false;
+            for (const Instruction &instruction : rule->program) {
+                if (instruction.op == Instruction::Compare
+                    && (instruction.metric == AlertRuleEngine::NetDown || instruction.metric == AlertRuleEngine::NetUp))
+                    usesNetwork = true;
+            }
+            if (!usesNetwork) return fail("'on' needs a net_down or net_up condition");
+            rule->interfaceName = ifaceToken.text;
+        }
+        if (acceptKeyword("then")) {
+            const Token &action = next();
+            if (action.kind == Token::Ident && action.text == "notify") rule->action = AlertRuleEngine::Notify;
+            else if (action.kind == Token::Ident && action.text == "kill") rule->action = AlertRuleEngine::Kill;
+            else if (action.kind == Token::Ident && action.text == "stop") rule->action = AlertRuleEngine::Stop;
+            else return fail("expected notify, kill or stop after 'then'");
+            if (rule->action != AlertRuleEngine::Notify && !rule->perProcess)
+                return fail("kill and stop actions need a process rule");
+        }
+        if (peek().kind != Token::End) return fail("unexpected '" + describe(peek()) + "'");
+        return true;
+    }
+
+private:
+    const Token &peek() const { return m_tokens[m_pos]; }
+    const Token &next() { const Token &t = m_tokens[m_pos]; if (t.kind != Token::End) ++m_pos; return t; }
+
+    bool acceptKeyword(const char *keyword)
+    {
+        if (peek().kind == Token::Ident && peek().text == QLatin1String(keyword)) { ++m_pos; return true; }
+        return false;
+    }
+
+    bool fail(const QString &message) { *m_error = message; return false; }
+
+    static QString describe(const Token &token)
+    {
+        switch (token.kind) {
+        case Token::Number: return QString::number(token.number) + token.unit;
+        case Token::LParen: return "(";
+        case Token::RParen: return ")";
+        case Token::Colon: return ":";
+        case Token::End: return "end of line";
+        default: return token.text;
+        }
+    }
+
+    void push(Instruction::Op op, Instruction::Cmp cmp = Instruction::Gt, quint8 metric = 0, double constant = 0.0)
+    {
+        m_rule->program.append({op, cmp, metric, constant});
+        if (op == Instruction::Compare) ++m_height;
+        else if (op != Instruction::Not) --m_height;
+        m_maxHeight = qMax(m_maxHeight, m_height);
+    }
+
+    bool parseOr()
+    {
+        if (!parseAnd()) return false;
+        while (acceptKeyword("or")) {
+            if (!parseAnd()) return false;
+            push(Instruction::Or);
+        }
+        return true;
+    }
+
+    bool parseAnd()
+    {
+        if (!parseUnary()) return false;
+        while (acceptKeyword("and")) {
+            if (!parseUnary()) return false;
+            push(Instruction::And);
+        }
+        return true;
+    }
+
+    bool parseUnary()
+    {
+        if (acceptKeyword("not")) {
+            if (!parseUnary()) return false;
+            push(Instruction::Not);
+            return true;
+        }
+        if (peek().kind == Token::LParen) {
+            next();
+            if (!parseOr()) return false;
+            if (next().kind != Token::RParen) return fail("expected ')'");
+            return true;
+        }
+        return parseComparison();
+    }
+
+    bool parseComparison()
+    {
+        const Token &metricToken = next();
+        if (metricToken.kind != Token::Ident) return fail("expected a metric, got '" + describe(metricToken) + "'");
+
+        const MetricInfo *metrics = m_rule->perProcess ? kProcessMetrics : kSystemMetrics;
+        const int metricCount = m_rule->perProcess ? int(AlertRuleEngine::ProcessMetricCount) : int(AlertRuleEngine::SystemMetricCount);
+        int metric = -1;
+        for (int i = 0; i < metricCount; ++i) {
+            if (metricToken.text == QLatin1String(metrics[i].name)) { metric = i; break; }
+        }
+        if (metric < 0) {
+            return fail(QString("unknown %1 metric '%2'").arg(QString(m_rule->perProcess ? "process" : "system"), metricToken.text));
+        }
+
+        const Token &opToken = next();
+        Instruction::Cmp cmp;
+        if (opToken.kind != Token::Op) return fail("expected a comparison after '" + metricToken.text + "'");
+        if (opToken.text == ">") cmp = Instruction::Gt;
+        else if (opToken.text == ">=") cmp = Instruction::Ge;
+        else if (opToken.text == "<") cmp = Instruction::Lt;
+        else if (opToken.text == "<=") cmp = Instruction::Le;
+        else if (opToken.text == "==" || opToken.text == "=") cmp = Instruction::Eq;
+        else cmp = Instruction::Ne;
+
+        const Token &valueToken = next();
+        if (valueToken.kind != Token::Number) return fail("expected a number after '" + opToken.text + "'");
+        double value = valueToken.number;
+        if (!convertUnit(valueToken.unit, metrics[metric].dimension, &value))
+            return fail(QString("unit '%1' does not fit metric '%2'").arg(valueToken.unit, metricToken.text));
+
+        push(Instruction::Compare, cmp, static_cast<quint8>(metric), value);
+        if (m_maxHeight > AlertRuleEngine::MaxStackDepth) return fail("condition is nested too deeply");
+        return true;
+    }
+
+    const QVector<Token> &m_tokens;
+    int m_pos = 0;
+    int m_height = 0;
+    int m_maxHeight = 0;
+    Rule *m_rule = nullptr;
+    QString *m_error = nullptr;
+};
+
+QString AlertRuleEngine::defaultRulesPath()
+{
+    const QString overridePath = qEnvironmentVariable("SYS_COPILOT_RULES");
+    if (!overridePath.isEmpty()) return overridePath;
+    return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/alerts.rules";
+}
+
+bool AlertRuleEngine::loadFile(const QString &path, QStringList *errors)
+{
+    QFile file(path);
+    if (!file.exists()) {
+        load(QString(), errors);
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        errors->append(path + ": " + file.errorString());
+        return false;
+    }
+    return load(QTextStream(&file).readAll(), errors);
+}
+
+bool AlertRuleEngine::load(const QString &text, QStringList *errors)
+{
+    m_rules.clear();
+    m_systemRules.clear();
+    m_rulesByInterface.clear();
+    m_anyProcessRules.clear();
+    m_rulesByProcessName.clear();
+    m_alerts.clear();
+
+    const QStringList lines = text.split('\n');
+    for (int lineNumber = 1; lineNumber <= lines.size(); ++lineNumber) {
+        QString line = lines[lineNumber - 1];
+        bool inString = false;
+        for (int i = 0; i < line.size(); ++i) {
+            if (line[i] == '"') inString = !inString;
+            else if (line[i] == '#' && !inString) { line.truncate(i); break; }
+        }
+        line = line.trimmed();
+        if (line.isEmpty()) continue;
+
+        QVector<Token> tokens;
+        QString error;
+        Rule rule;
+        if (!tokenize(line, &tokens, &error) || !RuleParser(tokens).parse(&rule, &error)) {
+            errors->append(QString("line %1: %2").arg(lineNumber).arg(error));
+            continue;
+        }
+        if (rule.name.isEmpty()) rule.name = QString("line %1").arg(lineNumber);
+        rule.source = line;
+
+        const int id = m_rules.size();
+        if (!rule.perProcess && !rule.interfaceName.isEmpty()) m_rulesByInterface[rule.interfaceName].append(id);
+        else if (!rule.perProcess) m_systemRules.append(id);
+        else if (rule.processName.isEmpty()) m_anyProcessRules.append(id);
+        else m_rulesByProcessName[rule.processName].append(id);
+        m_rules.append(rule);
+    }
+    return errors->isEmpty();
+}
+
+bool AlertRuleEngine::run(const QVector<Instruction> &program, const double *metrics)
+{
+    bool stack[MaxStackDepth];
+    int top = -1;
+    for (const Instruction &instruction : program) {
+        switch (instruction.op) {
+        case Instruction::Compare: {
+            const double value = metrics[instruction.metric];
+            bool result = false;
+            switch (instruction.cmp) {
+            case Instruction::Gt: result = value > instruction.constant; break;
+            case Instruction::Ge: result = value >= instruction.constant; break;
+            case Instruction::Lt: result = value < instruction.constant; break;
+            case Instruction::Le: result = value <= instruction.constant; break;
+            case Instruction::Eq: result = value == instruction.constant; break;
+            case Instruction::Ne: result = value != instruction.constant; break;
+            }
+            stack[++top] = result;
+            break;
+        }
+        case Instruction::And: --top; stack[top] = stack[top] && stack[top + 1]; break;
+        case Instruction::Or: --top; stack[top] = stack[top] || stack[top + 1]; break;
+        case Instruction::Not: stack[top] = !stack[top]; break;
+        }
+    }
+    return top >= 0 && stack[top];
+}
+
+bool AlertRuleEngine::step(WindowState &state, bool condition, qint64 timestampMs, qint64 forMs)
+{
+    if (!condition) {
+        state.trueSinceMs = -1;
+        state.fired = false;
+        return false;
+    }
+    if (state.trueSinceMs < 0) state.trueSinceMs = timestampMs;
+    if (state.fired || timestampMs - state.trueSinceMs < forMs) return false;
+    state.fired = true;
+    return true;
+}
+
+void AlertRuleEngine::raise(const Rule &rule, const QString &message, int pid, qint64 timestampMs)
+{
+    MonitorAlert alert;
+    alert.source = MonitorAlert::Rule;
+    alert.timestampMs = timestampMs;
+    alert.series = rule.name;
+    alert.message = message;
+    alert.pid = pid;
+    m_alerts.append(alert);
+}
+
+void AlertRuleEngine::evaluateProcessRule(Rule &rule, const ProcessData &process, const double *metrics, qint64 timestampMs)
+{
+    const bool condition = run(rule.program, metrics);
+    auto it = rule.processStates.find(process.pid);
+    if (!condition) {
+        // Only processes currently matching keep window state.
+        if (it != rule.processStates.end()) rule.processStates.erase(it);
+        return;
+    }
+    if (it == rule.processStates.end()) it = rule.processStates.insert(process.pid, WindowState());
+    it->seenTick = m_tick;
+    if (!step(*it, true, timestampMs, rule.forMs)) return;
+
+    QString outcome;
+    if (rule.action == Kill || rule.action == Stop) {
+        const bool killing = rule.action == Kill;
+        const QString verb = killing ? "kill" : "stop";
+        // A broad rule must not take down init, the monitor itself or the kernel.
+        // Replayed and synthetic pids name nothing on this host.
+        if (!m_procFs || !m_procFs->isLive())
+            outcome = QString(" - would %1 the process (not live data)").arg(verb);
+        else if (process.pid <= 1 || process.pid == QCoreApplication::applicationPid() || isKernelThread(m_procFs, process.pid))
+            outcome = QString(" - refused to %1 this process").arg(verb);
+        else if (::kill(process.pid, killing ? SIGKILL : SIGSTOP) == 0)
+            outcome = killing ? " - process killed" : " - process stopped";
+        else
+            outcome = QString(" - could not %1 process: %2").arg(verb, QString::fromLocal8Bit(strerror(errno)));
+    }
+    const QString message = QString("Rule '%1' fired for %2 (PID %3): %4%5").arg(rule.name, process.name).arg(process.pid).arg(rule.source, outcome);
+    if (rule.action != Notify) qWarning().noquote() << message;
+    raise(rule, message, process.pid, timestampMs);
+}
+
+void AlertRuleEngine::updateRanks(const SystemData &data)
+{
+    for (int metric = 0; metric < ProcessRanking::MetricCount; ++metric) {
+        QHash<int, int> &ranks = m_ranks[metric];
+        ranks.clear();
+        const QVector<ProcessRanking::Entry> top = data.ranking.top(ProcessRanking::Metric(metric), ProcessRanking::Depth);
+        for (int i = 0; i < top.size(); ++i) ranks.insert(top[i].pid, i + 1);
+    }
+}
+
+const QList<MonitorAlert> &AlertRuleEngine::evaluate(const SystemData &data, qint64 timestampMs)
+{
+    m_alerts.clear();
+    if (m_rules.isEmpty()) return m_alerts;
+    ++m_tick;
+
+    const double systemMetrics[SystemMetricCount] = {
+        data.cpuPercentage, data.memPercentage, data.diskPercentage,
+        data.netDownSpeed_KBps, data.netUpSpeed_KBps, static_cast<double>(data.processes.size()),
+    };
+    for (int id : m_systemRules) {
+        Rule &rule = m_rules[id];
+        if (step(rule.state, run(rule.program, systemMetrics), timestampMs, rule.forMs))
+            raise(rule, QString("Rule '%1' fired: %2").arg(rule.name, rule.source), -1, timestampMs);
+    }
+    for (auto it = m_rulesByInterface.constBegin(); it != m_rulesByInterface.constEnd(); ++it) {
+        const NetworkInterfaceData *iface = nullptr;
+        for (const NetworkInterfaceData &candidate : data.interfaces) {
+            if (candidate.name == it.key()) { iface = &candidate; break; }
+        }
+        double interfaceMetrics[SystemMetricCount];
+        std::copy(systemMetrics, systemMetrics + SystemMetricCount, interfaceMetrics);
+        if (iface) {
+            interfaceMetrics[NetDown] = iface->rxKBps;
+            interfaceMetrics[NetUp] = iface->txKBps;
+        }
+        for (int id : *it) {
+            Rule &rule = m_rules[id];
+            // A missing interface matches nothing, so a link that went away does not look idle.
+            if (step(rule.state, iface && run(rule.program, interfaceMetrics), timestampMs, rule.forMs))
+                raise(rule, QString("Rule '%1' fired: %2").arg(rule.name, rule.source), -1, timestampMs);
+        }
+    }
+
+    if (m_anyProcessRules.isEmpty() && m_rulesByProcessName.isEmpty()) return m_alerts;
+    updateRanks(data);
+    const int unranked = ProcessRanking::Depth + 1;
+    for (const ProcessData &process : data.processes) {
+        const double processMetrics[ProcessMetricCount] = {
+            process.memUsageMB, static_cast<double>(process.pid), process.cpuPercentage,
+            static_cast<double>(process.threads),
+            static_cast<double>(m_ranks[ProcessRanking::Memory].value(process.pid, unranked)),
+            static_cast<double>(m_ranks[ProcessRanking::Cpu].value(process.pid, unranked)),
+        };
+        if (!m_rulesByProcessName.isEmpty()) {
+            auto named = m_rulesByProcessName.constFind(process.name);
+            if (named != m_rulesByProcessName.constEnd()) {
+                for (int id : *named) evaluateProcessRule(m_rules[id], process, processMetrics, timestampMs);
+            }
+        }
+        for (int id : m_anyProcessRules) evaluateProcessRule(m_rules[id], process, processMetrics, timestampMs);
+    }
+
+    // Drop window state of processes that exited while matching.
+    if (m_tick % 32 == 0) {
+        for (Rule &rule : m_rules) {
+            for (auto it = rule.processStates.begin(); it != rule.processStates.end();) {
+                if (it->seenTick != m_tick) it = rule.processStates.erase(it);
+                else ++it;
+            }
+        }
+    }
+    return m_alerts;
+}
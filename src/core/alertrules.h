@@ -0,0 +1,105 @@
+#ifndef ALERTRULES_H
+#define ALERTRULES_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "../common/alert.h"
+#include "../common/systemdata.h"
+
+class ProcFs;
+
+// Declarative alert rules, one per line:
+//
+//   [name:] [process [named NAME]] CONDITION [for DURATION] [on INTERFACE] [then ACTION]
+//
+//   high_cpu: cpu > 90 for 30s
+//   java_rss: process named java rss > 8GB
+//   stalled:  net_down < 1KB/s for 5m on eth0
+//   runaway:  process named "stress-ng" rss > 2GB for 10s then kill
+//   hog:      process cpu_rank <= 3 and cpu > 50 for 1m
+//
+// CONDITION combines `metric op value` comparisons with and/or/not and
+// parentheses. Rules are parsed once and compiled to a flat bytecode that is
+// run against every sample; `for` windows keep O(1) state per rule (and per
+// pid for process rules) instead of rescanning history.
+class AlertRuleEngine
+{
+public:
+    enum SystemMetric { Cpu, Mem, Disk, NetDown, NetUp, ProcessCount, SystemMetricCount };
+    enum ProcessMetric { Rss, Pid, ProcessCpu, Threads, MemRank, CpuRank, ProcessMetricCount };
+    enum Action { Notify, Kill, Stop };
+
+    // Kill and stop actions signal pids only while `procFs` is live (see
+    // ProcFs::isLive()); otherwise, and without a ProcFs, the alert says what
+    // would have been done. Not owned.
+    void setProcFs(ProcFs *procFs) { m_procFs = procFs; }
+
+    bool load(const QString &text, QStringList *errors);
+    bool loadFile(const QString &path, QStringList *errors);
+    static QString defaultRulesPath();
+
+    int ruleCount() const { return m_rules.size(); }
+
+    // Evaluates every rule against one sample and returns the rules that
+    // started firing on this sample. The list is owned by the engine.
+    const QList<MonitorAlert> &evaluate(const SystemData &data, qint64 timestampMs);
+
+private:
+    static constexpr int MaxStackDepth = 32;
+
+    struct Instruction
+    {
+        enum Op : quint8 { Compare, And, Or, Not };
+        enum Cmp : quint8 { Gt, Ge, Lt, Le, Eq, Ne };
+        Op op;
+        Cmp cmp;
+        quint8 metric;
+        double constant;
+    };
+
+    struct WindowState
+    {
+        qint64 trueSinceMs = -1;
+        bool fired = false;
+        quint32 seenTick = 0;
+    };
+
+    struct Rule
+    {
+        QString name;
+        QString source;
+        bool perProcess = false;
+        QString processName;       // empty matches every process
+        QString interfaceName;     // system rules: net_down/net_up of this interface only
+        QVector<Instruction> program;
+        qint64 forMs = 0;
+        Action action = Notify;
+        WindowState state;                      // system rules
+        QHash<int, WindowState> processStates;  // process rules, keyed by pid
+    };
+
+    friend class RuleParser;
+
+    static bool run(const QVector<Instruction> &program, const double *metrics);
+    static bool step(WindowState &state, bool condition, qint64 timestampMs, qint64 forMs);
+    void evaluateProcessRule(Rule &rule, const ProcessData &process, const double *metrics, qint64 timestampMs);
+    void raise(const Rule &rule, const QString &message, int pid, qint64 timestampMs);
+    void updateRanks(const SystemData &data);
+
+    ProcFs *m_procFs = nullptr;
+    QVector<Rule> m_rules;
+    QVector<int> m_systemRules;
+    QHash<QString, QVector<int>> m_rulesByInterface;
+    QVector<int> m_anyProcessRules;
+    QHash<QString, QVector<int>> m_rulesByProcessName;
+    QList<MonitorAlert> m_alerts;
+    // pid -> 1-based rank for the top ProcessRanking::Depth processes; the
+    // rest rank Depth + 1.
+    QHash<int, int> m_ranks[ProcessRanking::MetricCount];
+    quint32 m_tick = 0;
+};
+
+#endif // ALERTRULES_H
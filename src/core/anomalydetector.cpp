@@ -0,0 +1,166 @@
+#include "anomalydetector.h"
+#include <QDateTime>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+const char *const kSystemSeriesNames[] = {"cpu", "mem", "disk", "net_down", "net_up"};
+const char *const kSystemSeriesLabels[] = {"CPU usage", "Memory usage", "Disk usage", "Download speed", "Upload speed"};
+const char *const kSystemSeriesUnits[] = {"%", "%", "%", " KB/s", " KB/s"};
+const float kSystemSeriesMinStdDev[] = {1.0f, 0.5f, 0.25f, 8.0f, 8.0f};
+
+constexpr quint32 kAllSlotsFilled = (1u << 24) - 1;
+
+}
+
+AnomalyDetector::AnomalyDetector() : AnomalyDetector(Config()) {}
+
+AnomalyDetector::AnomalyDetector(const Config &config) : m_config(config)
+{
+    static_assert(SeasonalSlots == 24, "kAllSlotsFilled assumes hourly slots");
+}
+
+AnomalyDetector::Verdict AnomalyDetector::update(SeriesState &state, float value, float minStdDev, float *score, float *expected) const
+{
+    *score = 0.0f;
+    *expected = state.mean;
+    if (state.samples == 0) {
+        state.mean = value;
+        state.variance = 0.0f;
+        state.samples = 1;
+        *expected = value;
+        return Normal;
+    }
+
+    const float diff = value - state.mean;
+    const float stddev = std::max(std::sqrt(state.variance), minStdDev);
+    const float z = diff / stddev;
+
+    Verdict verdict = Normal;
+    if (state.samples >= m_config.warmupSamples) {
+        const float clamped = std::clamp(z, -m_config.zThreshold, m_config.zThreshold);
+        state.cusumHigh = std::max(0.0f, state.cusumHigh + clamped - m_config.cusumDrift);
+        state.cusumLow = std::max(0.0f, state.cusumLow - clamped - m_config.cusumDrift);
+        if (state.cooldown > 0) {
+            --state.cooldown;
+        } else if (std::fabs(z) >= m_config.zThreshold) {
+            verdict = Spike;
+            *score = z;
+        } else if (state.cusumHigh >= m_config.cusumThreshold) {
+            verdict = Shift;
+            *score = state.cusumHigh;
+        } else if (state.cusumLow >= m_config.cusumThreshold) {
+            verdict = Shift;
+            *score = -state.cusumLow;
+        }
+        if (verdict != Normal) {
+            state.cooldown = m_config.cooldownSamples;
+            state.cusumHigh = 0.0f;
+            state.cusumLow = 0.0f;
+        }
+    }
+
+    const float increment = m_config.alpha * diff;
+    state.mean += increment;
+    state.variance = (1.0f - m_config.alpha) * (state.variance + diff * increment);
+    if (state.samples < UINT32_MAX) ++state.samples;
+    return verdict;
+}
+
+void AnomalyDetector::raise(const QString &series, const QString &message, int pid, double value, double score, qint64 timestampMs)
+{
+    MonitorAlert alert;
+    alert.source = MonitorAlert::Anomaly;
+    alert.timestampMs = timestampMs;
+    alert.series = series;
+    alert.message = message;
+    alert.pid = pid;
+    alert.value = value;
+    alert.score = score;
+    m_alerts.append(alert);
+}
+
+const QList<MonitorAlert> &AnomalyDetector::process(const SystemData &data, qint64 timestampMs)
+{
+    m_alerts.clear();
+    ++m_tick;
+
+    const float systemValues[SystemSeriesCount] = {
+        static_cast<float>(data.cpuPercentage), static_cast<float>(data.memPercentage),
+        static_cast<float>(data.diskPercentage), static_cast<float>(data.netDownSpeed_KBps),
+        static_cast<float>(data.netUpSpeed_KBps)};
+    // Daily patterns follow the wall clock, so the slot is the local hour (and
+    // moves with DST), not the hour since the epoch.
+    const int slot = QDateTime::fromMSecsSinceEpoch(timestampMs).time().hour();
+
+    for (int i = 0; i < SystemSeriesCount; ++i) {
+        const float value = systemValues[i];
+        SeasonalBaseline &seasonal = m_seasonal[i];
+        if (slot != seasonal.currentSlot) {
+            if (seasonal.currentCount > 0) {
+                const int ended = seasonal.currentSlot;
+                const float mean = static_cast<float>(seasonal.currentSum / seasonal.currentCount);
+                if (seasonal.filled & (1u << ended)) {
+                    seasonal.hourly[ended] += m_config.seasonalAlpha * (mean - seasonal.hourly[ended]);
+                } else {
+                    seasonal.hourly[ended] = mean;
+                    seasonal.filled |= 1u << ended;
+                    if (seasonal.filled == kAllSlotsFilled) m_system[i] = SeriesState();
+                }
+            }
+            seasonal.currentSlot = slot;
+            seasonal.currentSum = 0.0;
+            seasonal.currentCount = 0;
+        }
+        seasonal.currentSum += value;
+        ++seasonal.currentCount;
+
+        // Until a full day has been seen the raw value is scored; once every
+        // hour has a baseline the series restarts on the de-seasonalized residual.
+        const bool deseasonalized = seasonal.filled == kAllSlotsFilled;
+        const float residual = deseasonalized ? value - seasonal.hourly[slot] : value;
+
+        float score, expected;
+        const Verdict verdict = update(m_system[i], residual, kSystemSeriesMinStdDev[i], &score, &expected);
+        if (verdict == Normal || score <= 0.0f) continue;
+        if (deseasonalized) expected += seasonal.hourly[slot];
+
+        const QString label = kSystemSeriesLabels[i];
+        const QString unit = kSystemSeriesUnits[i];
+        const QString message = verdict == Spike
+            ? QString("%1 spiked to %2%3 (expected ~%4%3, z=%5)").arg(label).arg(value, 0, 'f', 1).arg(unit).arg(expected, 0, 'f', 1).arg(score, 0, 'f', 1)
+            : QString("%1 shifted upward to %2%3 (baseline ~%4%3)").arg(label).arg(value, 0, 'f', 1).arg(unit).arg(expected, 0, 'f', 1);
+        raise(kSystemSeriesNames[i], message, -1, value, score, timestampMs);
+    }
+
+    const float processMinStdDev = m_config.minProcessDeltaMB / m_config.zThreshold;
+    for (const ProcessData &process : data.processes) {
+        ProcessSeries &series = m_processes[process.pid];
+        if (series.startTime != process.startTime) {
+            series.rss = SeriesState();
+            series.startTime = process.startTime;
+        }
+        series.lastSeenTick = m_tick;
+
+        const float rss = static_cast<float>(process.memUsageMB);
+        float score, expected;
+        const Verdict verdict = update(series.rss, rss, processMinStdDev, &score, &expected);
+        if (verdict == Normal || score <= 0.0f || rss - expected < m_config.minProcessDeltaMB) continue;
+
+        const QString message = verdict == Spike
+            ? QString("Process %1 (PID %2) memory jumped to %3 MB (expected ~%4 MB)").arg(process.name).arg(process.pid).arg(rss, 0, 'f', 1).arg(expected, 0, 'f', 1)
+            : QString("Process %1 (PID %2) memory keeps growing: %3 MB (baseline ~%4 MB), possible leak").arg(process.name).arg(process.pid).arg(rss, 0, 'f', 1).arg(expected, 0, 'f', 1);
+        raise("process.rss", message, process.pid, rss, score, timestampMs);
+    }
+
+    if (m_config.pruneInterval > 0 && m_tick % m_config.pruneInterval == 0) {
+        for (auto it = m_processes.begin(); it != m_processes.end();) {
+            if (it->lastSeenTick != m_tick) it = m_processes.erase(it);
+            else ++it;
+        }
+    }
+
+    return m_alerts;
+}
@@ -0,0 +1,84 @@
+#ifndef ANOMALYDETECTOR_H
+#define ANOMALYDETECTOR_H
+
+#include <QHash>
+#include <QList>
+#include "../common/alert.h"
+#include "../common/systemdata.h"
+
+// Online anomaly detection over the monitor's sample stream. Every series is
+// tracked with O(1) state per sample: an EWMA mean/variance for z-scores and
+// a two-sided CUSUM on the standardized residual for sustained shifts (slow
+// leaks). System-wide series additionally subtract a local hour-of-day seasonal
+// baseline before scoring: each hour's mean is folded into its slot once the
+// hour ends, so a slot follows the same hour on previous days.
+class AnomalyDetector
+{
+public:
+    struct Config
+    {
+        float alpha = 0.1f;          // EWMA smoothing factor
+        float seasonalAlpha = 0.2f;  // per day: weight of the latest hour's mean in its slot
+        float zThreshold = 4.0f;     // spike threshold in standard deviations
+        float cusumDrift = 0.5f;     // CUSUM slack (k)
+        float cusumThreshold = 12.0f;// CUSUM decision interval (h)
+        quint32 warmupSamples = 15;
+        quint32 cooldownSamples = 30;
+        float minProcessDeltaMB = 64.0f; // ignore per-process swings below this
+        int pruneInterval = 32;      // ticks between dead-pid sweeps
+    };
+
+    struct SeriesState
+    {
+        float mean = 0.0f;
+        float variance = 0.0f;
+        float cusumHigh = 0.0f;
+        float cusumLow = 0.0f;
+        quint32 samples = 0;
+        quint32 cooldown = 0;
+    };
+
+    enum Verdict { Normal, Spike, Shift };
+
+    AnomalyDetector();
+    explicit AnomalyDetector(const Config &config);
+
+    // Feeds one sample of every series. Returns the alerts raised by this
+    // tick; the list is owned by the detector and reused.
+    const QList<MonitorAlert> &process(const SystemData &data, qint64 timestampMs);
+
+    int trackedSeries() const { return SystemSeriesCount + m_processes.size(); }
+
+private:
+    enum SystemSeries { Cpu, Mem, Disk, NetDown, NetUp, SystemSeriesCount };
+    static constexpr int SeasonalSlots = 24;
+
+    struct SeasonalBaseline
+    {
+        float hourly[SeasonalSlots] = {};
+        quint32 filled = 0; // bitmask of slots with data
+        // The hour in progress, folded into hourly[] when it ends.
+        int currentSlot = -1;
+        double currentSum = 0.0;
+        quint32 currentCount = 0;
+    };
+
+    struct ProcessSeries
+    {
+        SeriesState rss;
+        quint64 startTime = 0; // a different one means the pid was reused
+        quint32 lastSeenTick = 0;
+    };
+
+    Verdict update(SeriesState &state, float value, float minStdDev, float *score, float *expected) const;
+    void raise(const QString &series, const QString &message, int pid, double value, double score, qint64 timestampMs);
+
+    Config m_config;
+    SeriesState m_system[SystemSeriesCount];
+    SeasonalBaseline m_seasonal[SystemSeriesCount];
+    QHash<int, ProcessSeries> m_processes;
+    quint32 m_tick = 0;
+    QList<MonitorAlert> m_alerts;
+};
+
+#endif // ANOMALYDETECTOR_H
@@ -0,0 +1,245 @@
+#include "cgroupcollector.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr qint64 kRescanIntervalMs = 10000;
+constexpr int kSlowReadsPerTick = 256;
+
+int openDirectory(int dirFd, const char *path)
+{
+    return ::openat(dirFd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+// The soft limit before raiseFileLimit(), or RLIM_INFINITY if unchanged.
+rlim_t g_originalFileLimit = RLIM_INFINITY;
+
+// A held fd per cgroup can exceed the usual soft limit of 1024; the hard
+// limit is normally far higher.
+void raiseFileLimit()
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        const rlim_t original = limit.rlim_cur;
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &limit) == 0) g_originalFileLimit = original;
+    }
+}
+
+// "12.34" -> 12.34; advances past the number.
+double readDecimal(const char *&p, const char *end)
+{
+    quint64 whole = 0;
+    ProcParse::readU64(p, end, &whole);
+    double value = static_cast<double>(whole);
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, scale /= 10) value += (*p - '0') * scale;
+    }
+    return value;
+}
+
+// "some avg10=1.23 avg60=... total=..." -> 1.23
+double somePressure(const ProcText &text)
+{
+    if (text.isNull()) return 0.0;
+    const char *p = text.begin;
+    if (!ProcParse::consume(p, text.end, "some")) return 0.0;
+    ProcParse::skipSpaces(p, text.end);
+    if (!ProcParse::consume(p, text.end, "avg10=")) return 0.0;
+    return readDecimal(p, text.end);
+}
+
+quint64 counterDelta(quint64 current, quint64 previous)
+{
+    return current >= previous ? current - previous : 0;
+}
+
+}
+
+CgroupCollector::CgroupCollector(ProcFs *procFs)
+    : m_procFs(procFs)
+{
+    const int sysFd = procFs->rootFd(ProcFs::Sys);
+    if (sysFd < 0) return;
+    // Pure v2 has cgroup.controllers at the top; hybrid hosts mount v2 below.
+    for (const char *path : {"fs/cgroup", "fs/cgroup/unified"}) {
+        const int fd = openDirectory(sysFd, path);
+        if (fd < 0) continue;
+        if (::faccessat(fd, "cgroup.controllers", F_OK, 0) == 0) {
+            m_rootFd = fd;
+            break;
+        }
+        ::close(fd);
+    }
+    if (m_rootFd >= 0) raiseFileLimit();
+}
+
+void CgroupCollector::restoreFileLimit()
+{
+    if (g_originalFileLimit == RLIM_INFINITY) return;
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+    limit.rlim_cur = g_originalFileLimit;
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+CgroupCollector::~CgroupCollector()
+{
+    for (const Node &node : m_nodes) {
+        if (node.dirFd >= 0 && node.dirFd != m_rootFd) ::close(node.dirFd);
+    }
+    if (m_rootFd >= 0) ::close(m_rootFd);
+}
+
+int CgroupCollector::openDir(const QByteArray &path) const
+{
+    return path.isEmpty() ? m_rootFd : openDirectory(m_rootFd, path.constData());
+}
+
+// Breadth-first, so parents always precede their children. Nodes that still
+// exist keep their fd and previous counters.
+void CgroupCollector::rescan(qint64 nowMs)
+{
+    m_lastScanMs = nowMs;
+    m_rescanWanted = false;
+    QHash<QByteArray, int> previousIndex;
+    previousIndex.reserve(m_nodes.size());
+    for (int i = 0; i < m_nodes.size(); ++i) previousIndex.insert(m_nodes[i].path, i);
+    QVector<bool> kept(m_nodes.size(), false);
+
+    QVector<Node> nodes;
+    nodes.reserve(m_nodes.size() + 16);
+    auto addNode = [&](const QByteArray &path, int parent) {
+        const int previous = previousIndex.value(path, -1);
+        Node node;
+        if (previous >= 0) {
+            node = m_nodes[previous];
+            kept[previous] = true;
+        } else {
+            node.path = path;
+            node.dirFd = openDir(path);
+            node.data = CgroupData();
+            node.data.path = path.isEmpty() ? QString("/") : QString::fromUtf8("/" + path);
+        }
+        node.data.parent = parent;
+        nodes.append(node);
+    };
+
+    addNode(QByteArray(), -1);
+    for (int i = 0; i < nodes.size(); ++i) {
+        int fd = nodes[i].dirFd;
+        const bool temporary = fd < 0;
+        if (temporary) fd = openDir(nodes[i].path);
+        const bool listed = ProcFs::listSubdirectories(fd, &m_names);
+        if (temporary && fd >= 0) ::close(fd);
+        if (!listed) continue;
+        const QByteArray prefix = nodes[i].path.isEmpty() ? QByteArray() : nodes[i].path + "/";
+        for (const QByteArray &name : m_names) addNode(prefix + name, i);
+    }
+
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        if (!kept[i] && m_nodes[i].dirFd >= 0 && m_nodes[i].dirFd != m_rootFd) ::close(m_nodes[i].dirFd);
+    }
+    m_nodes = nodes;
+    if (m_slowCursor >= m_nodes.size()) m_slowCursor = 0;
+}
+
+ProcText CgroupCollector::readFile(const Node &node, const char *name)
+{
+    if (node.dirFd >= 0) return m_procFs->readAt(node.dirFd, name);
+    m_pathBuffer = node.path;
+    if (!m_pathBuffer.isEmpty()) m_pathBuffer += '/';
+    m_pathBuffer += name;
+    return m_procFs->readAt(m_rootFd, m_pathBuffer.constData());
+}
+
+// False if the cgroup is gone.
+bool CgroupCollector::readFast(Node &node, qint64 nowMs)
+{
+    quint64 usageUsec = 0, readBytes = 0, writeBytes = 0;
+    ProcText text = readFile(node, "cpu.stat");
+    if (text.isNull()) {
+        if (!node.path.isEmpty() && (errno == ENOENT || errno == ENODEV)) return false;
+    } else {
+        const char *p = text.begin;
+        if (ProcParse::consume(p, text.end, "usage_usec")) ProcParse::readU64(p, text.end, &usageUsec);
+    }
+
+    text = readFile(node, "memory.current");
+    if (!text.isNull()) {
+        const char *p = text.begin;
+        ProcParse::readU64(p, text.end, &node.data.memoryBytes);
+    }
+
+    // "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=5 dios=6", one line per device.
+    text = readFile(node, "io.stat");
+    for (const char *p = text.begin; p && p < text.end;) {
+        const char *token;
+        int length;
+        ProcParse::readToken(p, text.end, &token, &length);
+        for (;;) {
+            ProcParse::skipSpaces(p, text.end);
+            if (p == text.end || *p == '\n') break;
+            quint64 value;
+            if (ProcParse::consume(p, text.end, "rbytes=") && ProcParse::readU64(p, text.end, &value)) readBytes += value;
+            else if (ProcParse::consume(p, text.end, "wbytes=") && ProcParse::readU64(p, text.end, &value)) writeBytes += value;
+            else ProcParse::readToken(p, text.end, &token, &length);
+        }
+        if (!ProcParse::nextLine(p, text.end)) break;
+    }
+
+    const double elapsedSeconds = node.sampledAtMs > 0 ? (nowMs - node.sampledAtMs) / 1000.0 : 0.0;
+    if (elapsedSeconds > 0) {
+        node.data.cpuPercentage = counterDelta(usageUsec, node.usageUsec) / (elapsedSeconds * 10000.0);
+        node.data.ioReadKBps = counterDelta(readBytes, node.ioReadBytes) / elapsedSeconds / 1024.0;
+        node.data.ioWriteKBps = counterDelta(writeBytes, node.ioWriteBytes) / elapsedSeconds / 1024.0;
+    }
+    node.usageUsec = usageUsec;
+    node.ioReadBytes = readBytes;
+    node.ioWriteBytes = writeBytes;
+    node.sampledAtMs = nowMs;
+    return true;
+}
+
+void CgroupCollector::readSlow(Node &node)
+{
+    const ProcText text = readFile(node, "memory.stat");
+    int found = 0;
+    for (const char *p = text.begin; p && p < text.end && found < 2;) {
+        if (ProcParse::consume(p, text.end, "anon ")) {
+            ProcParse::readU64(p, text.end, &node.data.anonBytes);
+            ++found;
+        } else if (ProcParse::consume(p, text.end, "file ")) {
+            ProcParse::readU64(p, text.end, &node.data.fileBytes);
+            ++found;
+        }
+        if (!ProcParse::nextLine(p, text.end)) break;
+    }
+    node.data.cpuPressure = somePressure(readFile(node, "cpu.pressure"));
+    node.data.memoryPressure = somePressure(readFile(node, "memory.pressure"));
+    node.data.ioPressure = somePressure(readFile(node, "io.pressure"));
+}
+
+void CgroupCollector::collect(qint64 nowMs, QList<CgroupData> *cgroups)
+{
+    if (m_rootFd < 0) return;
+    if (m_rescanWanted || nowMs - m_lastScanMs >= kRescanIntervalMs) rescan(nowMs);
+
+    for (Node &node : m_nodes) {
+        if (!readFast(node, nowMs)) m_rescanWanted = true;
+    }
+    const int slowReads = qMin(kSlowReadsPerTick, static_cast<int>(m_nodes.size()));
+    for (int i = 0; i < slowReads; ++i) {
+        readSlow(m_nodes[m_slowCursor]);
+        m_slowCursor = (m_slowCursor + 1) % m_nodes.size();
+    }
+
+    QList<CgroupData> result;
+    result.reserve(m_nodes.size());
+    for (const Node &node : m_nodes) result.append(node.data);
+    *cgroups = result;
+}
@@ -0,0 +1,66 @@
+#ifndef CGROUPCOLLECTOR_H
+#define CGROUPCOLLECTOR_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include "../common/systemdata.h"
+#include "procfs.h"
+
+// Resource usage of every cgroup under the cgroup v2 root (<sys>/fs/cgroup,
+// or fs/cgroup/unified on hybrid hosts).
+//
+// Each cgroup directory is opened once and its fd kept, so a tick is an
+// openat()+read() per file with no path walking. The hierarchy is listed
+// again only every few seconds or when a cgroup vanishes. cpu.stat,
+// memory.current and io.stat are read every tick; memory.stat and the
+// pressure files, which move slowly and cost the most, are refreshed for a
+// bounded number of cgroups per tick in rotation, so thousands of cgroups
+// add a fixed amount of work. Reads go through the monitor's ProcFs buffer
+// but are not recorded, so cgroups are empty when replaying.
+class CgroupCollector
+{
+public:
+    explicit CgroupCollector(ProcFs *procFs);
+    ~CgroupCollector();
+    CgroupCollector(const CgroupCollector &) = delete;
+    CgroupCollector &operator=(const CgroupCollector &) = delete;
+
+    bool isAvailable() const { return m_rootFd >= 0; }
+    // The collector raises the process's soft RLIMIT_NOFILE to the hard
+    // limit. Call this in a forked child before exec (a QProcess child
+    // process modifier) so programs we start get the limit we started with;
+    // it only makes async-signal-safe calls.
+    static void restoreFileLimit();
+    void collect(qint64 nowMs, QList<CgroupData> *cgroups);
+
+private:
+    struct Node
+    {
+        QByteArray path; // relative to the root, "" for the root
+        int dirFd = -1;  // -1 if we ran out of fds; read by path instead
+        CgroupData data;
+        quint64 usageUsec = 0;
+        quint64 ioReadBytes = 0;
+        quint64 ioWriteBytes = 0;
+        qint64 sampledAtMs = 0;
+    };
+
+    void rescan(qint64 nowMs);
+    int openDir(const QByteArray &path) const;
+    ProcText readFile(const Node &node, const char *name);
+    bool readFast(Node &node, qint64 nowMs);
+    void readSlow(Node &node);
+
+    ProcFs *m_procFs;
+    int m_rootFd = -1;
+    QVector<Node> m_nodes; // parents before children
+    QByteArray m_pathBuffer;
+    QVector<QByteArray> m_names;
+    qint64 m_lastScanMs = 0;
+    bool m_rescanWanted = true;
+    int m_slowCursor = 0;
+};
+
+#endif // CGROUPCOLLECTOR_H
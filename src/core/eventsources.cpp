@@ -0,0 +1,189 @@
+#include "eventsources.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/magic.h>
+#include <linux/netlink.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace {
+
+// Tags in epoll_event.data; pressure fds use their Resource value.
+constexpr int kNetlinkTag = 100;
+
+// Unprivileged triggers need a window that is a multiple of 2 s.
+constexpr const char *kTriggers[] = {
+    "some 200000 2000000", // cpu: 10% of 2 s
+    "some 100000 2000000", // memory: 5%
+    "some 200000 2000000", // io: 10%
+};
+constexpr const char *kPressurePaths[] = {"pressure/cpu", "pressure/memory", "pressure/io"};
+
+}
+
+EventSources::EventSources(QObject *parent)
+    : QObject(parent),
+      m_epollFd(::epoll_create1(EPOLL_CLOEXEC))
+{
+    if (m_epollFd < 0) return;
+    m_notifier = new QSocketNotifier(m_epollFd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &EventSources::onActivated);
+}
+
+EventSources::~EventSources()
+{
+    for (int fd : m_pressureFds) {
+        if (fd >= 0) ::close(fd);
+    }
+    if (m_netlinkFd >= 0) ::close(m_netlinkFd);
+    if (m_epollFd >= 0) ::close(m_epollFd);
+}
+
+QString EventSources::resourceName(Resource resource)
+{
+    switch (resource) {
+    case Cpu: return "cpu";
+    case Memory: return "memory";
+    case Io: return "io";
+    default: return QString();
+    }
+}
+
+QString EventSources::triggerDescription(Resource resource)
+{
+    return QString("tasks stalled over %1% of the last 2 s").arg(resource == Memory ? 5 : 10);
+}
+
+bool EventSources::hasPressureTriggers() const
+{
+    for (int fd : m_pressureFds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+bool EventSources::watch(int fd, quint32 events, int tag)
+{
+    epoll_event event = {};
+    event.events = events;
+    event.data.u32 = static_cast<quint32>(tag);
+    return ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+int EventSources::armPressureTriggers(int procRootFd)
+{
+    struct statfs info;
+    if (m_epollFd < 0 || procRootFd < 0 || ::fstatfs(procRootFd, &info) != 0 || info.f_type != PROC_SUPER_MAGIC) return 0;
+    int armed = 0;
+    for (int resource = 0; resource < ResourceCount; ++resource) {
+        if (m_pressureFds[resource] >= 0) {
+            ++armed;
+            continue;
+        }
+        const int fd = ::openat(procRootFd, kPressurePaths[resource], O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) continue;
+        // The trigger lives as long as the fd; POLLPRI once per window at most.
+        const char *trigger = kTriggers[resource];
+        if (::write(fd, trigger, std::strlen(trigger) + 1) < 0 || !watch(fd, EPOLLPRI, resource)) {
+            ::close(fd);
+            continue;
+        }
+        m_pressureFds[resource] = fd;
+        ++armed;
+    }
+    return armed;
+}
+
+bool EventSources::subscribeProcessEvents()
+{
+    if (m_epollFd < 0) return false;
+    if (m_netlinkFd >= 0) return true;
+    const int fd = ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) return false;
+
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    alignas(nlmsghdr) char request[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] = {};
+    nlmsghdr *header = reinterpret_cast<nlmsghdr *>(request);
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    header->nlmsg_type = NLMSG_DONE;
+    header->nlmsg_pid = static_cast<__u32>(::getpid());
+    cn_msg *message = static_cast<cn_msg *>(NLMSG_DATA(header));
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(proc_cn_mcast_op);
+    const proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+    std::memcpy(message->data, &op, sizeof(op));
+    if (::send(fd, request, header->nlmsg_len, 0) != static_cast<ssize_t>(header->nlmsg_len) || !watch(fd, EPOLLIN, kNetlinkTag)) {
+        ::close(fd);
+        return false;
+    }
+    m_netlinkFd = fd;
+    return true;
+}
+
+void EventSources::onActivated()
+{
+    epoll_event events[8];
+    const int count = ::epoll_wait(m_epollFd, events, 8, 0);
+    for (int i = 0; i < count; ++i) {
+        const int tag = static_cast<int>(events[i].data.u32);
+        if (tag == kNetlinkTag) readProcessEvents();
+        else if (tag >= 0 && tag < ResourceCount) emit pressureStall(static_cast<Resource>(tag));
+    }
+}
+
+void EventSources::readProcessEvents()
+{
+    m_changed.clear();
+    m_exited.clear();
+    bool lost = false;
+    alignas(nlmsghdr) char buffer[16 * 1024];
+    for (;;) {
+        const ssize_t length = ::recv(m_netlinkFd, buffer, sizeof(buffer), 0);
+        if (length < 0) {
+            if (errno == ENOBUFS) {
+                lost = true;
+                continue;
+            }
+            break; // EAGAIN: drained
+        }
+        int remaining = static_cast<int>(length);
+        for (const nlmsghdr *header = reinterpret_cast<const nlmsghdr *>(buffer); NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) continue;
+            const cn_msg *message = static_cast<const cn_msg *>(NLMSG_DATA(header));
+            if (message->id.idx != CN_IDX_PROC || message->len < sizeof(proc_event)) continue;
+            const proc_event *event = reinterpret_cast<const proc_event *>(message->data);
+            switch (event->what) {
+            case proc_event::PROC_EVENT_FORK:
+                // Thread creation reports child_pid != child_tgid.
+                if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid)
+                    m_changed.append(event->event_data.fork.child_tgid);
+                break;
+            case proc_event::PROC_EVENT_EXEC:
+                m_changed.append(event->event_data.exec.process_tgid);
+                break;
+            case proc_event::PROC_EVENT_EXIT:
+                if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid)
+                    m_exited.append(event->event_data.exit.process_tgid);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    if (lost) emit processEventsLost();
+    if (!m_changed.isEmpty() || !m_exited.isEmpty()) emit processesChanged(m_changed, m_exited);
+}
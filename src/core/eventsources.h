@@ -0,0 +1,59 @@
+#ifndef EVENTSOURCES_H
+#define EVENTSOURCES_H
+
+#include <QObject>
+#include <QSocketNotifier>
+#include <QVector>
+
+// Kernel event sources multiplexed on one epoll fd, which a QSocketNotifier
+// watches from the owner's thread, so the thread sleeps until something
+// happens:
+//  - PSI triggers on <proc>/pressure/{cpu,memory,io}: fire within the trigger
+//    window when stall time crosses the threshold.
+//  - The netlink proc connector: fork/exec/exit of every process. Needs
+//    CAP_NET_ADMIN.
+// Each source is optional; callers keep polling for whatever is unavailable.
+class EventSources : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Resource { Cpu, Memory, Io, ResourceCount };
+
+    explicit EventSources(QObject *parent = nullptr);
+    ~EventSources();
+
+    // Arms one "some" trigger per resource under procRootFd, which must be a
+    // real procfs (fixture trees are left alone). Returns how many were armed.
+    int armPressureTriggers(int procRootFd);
+    bool subscribeProcessEvents();
+
+    bool hasPressureTriggers() const;
+    bool hasProcessEvents() const { return m_netlinkFd >= 0; }
+    static QString resourceName(Resource resource);
+    // The armed threshold in words, e.g. "stalled over 10% of the last 2 s".
+    static QString triggerDescription(Resource resource);
+
+signals:
+    void pressureStall(EventSources::Resource resource);
+    // Processes (not threads) that were forked or exec'd, and that exited.
+    void processesChanged(const QVector<int> &changed, const QVector<int> &exited);
+    // The connector dropped events (socket overflow); the caller should rescan.
+    void processEventsLost();
+
+private slots:
+    void onActivated();
+
+private:
+    bool watch(int fd, quint32 events, int tag);
+    void readProcessEvents();
+
+    int m_epollFd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    int m_pressureFds[ResourceCount] = {-1, -1, -1};
+    int m_netlinkFd = -1;
+    QVector<int> m_changed;
+    QVector<int> m_exited;
+};
+
+#endif // EVENTSOURCES_H
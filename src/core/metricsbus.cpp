@@ -0,0 +1,87 @@
+#include "metricsbus.h"
+#include "selfprofiler.h"
+
+MetricsSubscription *MetricsBus::subscribe(Fields fields, int minIntervalMs, QObject *parent)
+{
+    QSharedPointer<Mailbox> mailbox(new Mailbox);
+    mailbox->fields = fields;
+    MetricsSubscription *subscription = new MetricsSubscription(mailbox, minIntervalMs, parent);
+    mailbox->receiver = subscription;
+    QMutexLocker locker(&m_mutex);
+    m_mailboxes.append(mailbox);
+    return subscription;
+}
+
+void MetricsBus::publish(const SystemData &data)
+{
+    PROFILE_SCOPE("bus.publish");
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_mailboxes.begin(); it != m_mailboxes.end();) {
+        Mailbox &mailbox = **it;
+        if (mailbox.closed.load(std::memory_order_relaxed)) {
+            it = m_mailboxes.erase(it);
+            continue;
+        }
+        // Lists are implicitly shared, so this only bumps reference counts.
+        // Unwanted ones are replaced rather than cleared: clear() on a shared
+        // list would allocate.
+        SystemData &slot = mailbox.buffer.back();
+        slot = data;
+        if (!(mailbox.fields & Processes)) {
+            slot.processes = QList<ProcessData>();
+            slot.ranking = ProcessRanking();
+        }
+        if (!(mailbox.fields & Devices)) {
+            slot.interfaces = QList<NetworkInterfaceData>();
+            slot.disks = QList<DiskDeviceData>();
+            slot.mounts = QList<MountData>();
+            slot.sensors = QList<SensorData>();
+            slot.cpuFrequencies = QList<CpuFrequencyData>();
+        }
+        if (!(mailbox.fields & Cgroups)) slot.cgroups = QList<CgroupData>();
+        if (!(mailbox.fields & Sockets)) slot.sockets = QList<SocketData>();
+        if (mailbox.buffer.publish()) mailbox.coalesced.fetch_add(1, std::memory_order_relaxed);
+
+        // One wake-up in flight per subscriber, however far behind it is.
+        if (!mailbox.wakePending.exchange(true)) {
+            QMutexLocker receiverLocker(&mailbox.receiverMutex);
+            if (mailbox.receiver)
+                QMetaObject::invokeMethod(mailbox.receiver, &MetricsSubscription::deliver, Qt::QueuedConnection);
+        }
+        ++it;
+    }
+}
+
+MetricsSubscription::MetricsSubscription(const QSharedPointer<MetricsBus::Mailbox> &mailbox, int minIntervalMs, QObject *parent)
+    : QObject(parent),
+      m_mailbox(mailbox),
+      m_minIntervalMs(minIntervalMs),
+      m_rateTimer(new QTimer(this))
+{
+    m_rateTimer->setSingleShot(true);
+    connect(m_rateTimer, &QTimer::timeout, this, &MetricsSubscription::deliver);
+}
+
+MetricsSubscription::~MetricsSubscription()
+{
+    QMutexLocker locker(&m_mailbox->receiverMutex);
+    m_mailbox->receiver = nullptr;
+    m_mailbox->closed.store(true, std::memory_order_relaxed);
+}
+
+void MetricsSubscription::deliver()
+{
+    if (m_minIntervalMs > 0 && m_sinceDelivery.isValid()) {
+        const qint64 wait = m_minIntervalMs - m_sinceDelivery.elapsed();
+        if (wait > 0) {
+            // Whatever arrives meanwhile is coalesced; the timer takes the newest.
+            if (!m_rateTimer->isActive()) m_rateTimer->start(static_cast<int>(wait));
+            return;
+        }
+    }
+    // Cleared before taking, so anything published after the take wakes us again.
+    m_mailbox->wakePending.store(false);
+    if (!m_mailbox->buffer.take()) return;
+    m_sinceDelivery.start();
+    emit sampleReady(m_mailbox->buffer.front());
+}
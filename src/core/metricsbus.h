@@ -0,0 +1,84 @@
+#ifndef METRICSBUS_H
+#define METRICSBUS_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimer>
+#include <atomic>
+#include "../common/systemdata.h"
+#include "triplebuffer.h"
+
+class MetricsSubscription;
+
+// Fan-out of monitor samples to the UI, the copilot and the agent. Each
+// subscriber names the parts of SystemData it wants and the minimum gap
+// between deliveries, and gets its own TripleBuffer: the monitor never waits
+// for a consumer, and a stalled consumer holds at most three samples and at
+// most one pending wake-up in its event queue. Samples it could not take in
+// time are coalesced into the newest one.
+class MetricsBus
+{
+public:
+    // Scalars (totals, CPU temperature and clock, static data) always travel.
+    enum Field { Processes = 0x1, Devices = 0x2, Cgroups = 0x4, Sockets = 0x8, AllFields = 0xf };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    // From any thread. The subscription delivers in the thread of `parent`,
+    // which owns it; deleting it unsubscribes.
+    MetricsSubscription *subscribe(Fields fields, int minIntervalMs, QObject *parent);
+    // From the monitor thread.
+    void publish(const SystemData &data);
+
+private:
+    friend class MetricsSubscription;
+
+    // Shared by the bus and one subscription, so either may go first.
+    struct Mailbox
+    {
+        Fields fields;
+        TripleBuffer<SystemData> buffer;
+        std::atomic<bool> wakePending{false};
+        std::atomic<bool> closed{false};
+        std::atomic<quint64> coalesced{0};
+        QMutex receiverMutex; // only taken to post a wake-up or to unsubscribe
+        MetricsSubscription *receiver = nullptr;
+    };
+
+    QMutex m_mutex; // guards the list, not the samples
+    QList<QSharedPointer<Mailbox>> m_mailboxes;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(MetricsBus::Fields)
+
+class MetricsSubscription : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~MetricsSubscription();
+
+    MetricsBus::Fields fields() const { return m_mailbox->fields; }
+    int minIntervalMs() const { return m_minIntervalMs; }
+    // Samples that were replaced by a newer one before this subscriber took them.
+    quint64 coalescedCount() const { return m_mailbox->coalesced.load(std::memory_order_relaxed); }
+
+signals:
+    // `data` stays valid until the next emission; copy what you keep.
+    void sampleReady(const SystemData &data);
+
+private:
+    friend class MetricsBus;
+
+    MetricsSubscription(const QSharedPointer<MetricsBus::Mailbox> &mailbox, int minIntervalMs, QObject *parent);
+    void deliver();
+
+    QSharedPointer<MetricsBus::Mailbox> m_mailbox;
+    int m_minIntervalMs;
+    QElapsedTimer m_sinceDelivery;
+    QTimer *m_rateTimer;
+};
+
+#endif // METRICSBUS_H
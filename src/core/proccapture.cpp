@@ -0,0 +1,270 @@
+#include "proccapture.h"
+#include "common/wireprotocol.h"
+#include <cstring>
+
+namespace {
+
+const char kMagic[6] = {'S', 'Y', 'S', 'C', 'A', 'P'};
+
+void putBytes(QByteArray &out, const char *data, int size)
+{
+    Wire::putVarint(out, static_cast<quint64>(size));
+    out.append(data, size);
+}
+
+bool getBytes(const char *&p, const char *end, const char *base, int *offset, int *size)
+{
+    quint64 length;
+    if (!Wire::getVarint(p, end, &length) || length > static_cast<quint64>(end - p)) return false;
+    *offset = static_cast<int>(p - base);
+    *size = static_cast<int>(length);
+    p += length;
+    return true;
+}
+
+QByteArray lookupKey(quint8 root, const char *path, int pathLength)
+{
+    QByteArray key;
+    key.reserve(pathLength + 1);
+    key.append(static_cast<char>(root));
+    key.append(path, pathLength);
+    return key;
+}
+
+}
+
+// --- Recording ---
+
+bool ProcCapture::open(const QString &path, QString *error)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *error = QString("%1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+    m_file.write(kMagic, sizeof(kMagic));
+    const char version = static_cast<char>(Capture::Version);
+    m_file.write(&version, 1);
+    return true;
+}
+
+void ProcCapture::close()
+{
+    m_file.close();
+}
+
+void ProcCapture::beginFrame(qint64 timestampMs)
+{
+    m_timestampMs = timestampMs;
+    m_body.clear();
+}
+
+void ProcCapture::addFile(ProcFs::Root root, const char *path, const ProcText &text)
+{
+    m_body.append(static_cast<char>(text.isNull() ? Capture::Missing : Capture::File));
+    m_body.append(static_cast<char>(root));
+    putBytes(m_body, path, static_cast<int>(std::strlen(path)));
+    if (!text.isNull()) putBytes(m_body, text.begin, text.size());
+}
+
+void ProcCapture::addPids(const QVector<int> &pids)
+{
+    m_body.append(static_cast<char>(Capture::Pids));
+    Wire::putVarint(m_body, static_cast<quint64>(pids.size()));
+    int previous = 0;
+    for (int pid : pids) {
+        Wire::putVarint(m_body, static_cast<quint64>(pid - previous));
+        previous = pid;
+    }
+}
+
+void ProcCapture::addDiskUsage(const char *path, quint64 totalBytes, quint64 freeBytes)
+{
+    m_body.append(static_cast<char>(Capture::DiskUsage));
+    putBytes(m_body, path, static_cast<int>(std::strlen(path)));
+    Wire::putVarint(m_body, totalBytes);
+    Wire::putVarint(m_body, freeBytes);
+}
+
+bool ProcCapture::endFrame()
+{
+    if (!m_file.isOpen()) return false;
+    const QByteArray compressed = qCompress(m_body);
+    m_frame.clear();
+    Wire::putVarint(m_frame, static_cast<quint64>(m_timestampMs));
+    Wire::putVarint(m_frame, static_cast<quint64>(compressed.size()));
+    m_frame.append(compressed);
+    // Flushed per frame so a crash or kill loses at most the current tick.
+    return m_file.write(m_frame) == m_frame.size() && m_file.flush();
+}
+
+// --- Replay ---
+
+bool ProcReplay::open(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("%1: %2").arg(path, file.errorString());
+        return false;
+    }
+    m_data = file.readAll();
+    m_frames.clear();
+    if (m_data.size() < qsizetype(sizeof(kMagic)) + 1 || std::memcmp(m_data.constData(), kMagic, sizeof(kMagic)) != 0) {
+        *error = QString("%1: not a capture file").arg(path);
+        return false;
+    }
+    if (static_cast<quint8>(m_data[sizeof(kMagic)]) != Capture::Version) {
+        *error = QString("%1: unsupported capture version %2").arg(path).arg(int(static_cast<quint8>(m_data[sizeof(kMagic)])));
+        return false;
+    }
+
+    const char *base = m_data.constData();
+    const char *p = base + sizeof(kMagic) + 1;
+    const char *end = base + m_data.size();
+    while (p < end) {
+        quint64 timestamp, size;
+        if (!Wire::getVarint(p, end, &timestamp) || !Wire::getVarint(p, end, &size)
+            || size > static_cast<quint64>(end - p)) {
+            break; // truncated tail, e.g. the recorder was killed mid-write
+        }
+        m_frames.append({static_cast<qint64>(timestamp), p - base, static_cast<qsizetype>(size)});
+        p += size;
+    }
+    if (m_frames.isEmpty()) {
+        *error = QString("%1: capture contains no frames").arg(path);
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void ProcReplay::rewind()
+{
+    m_nextFrame = 0;
+    m_timestampMs = 0;
+    m_entries.clear();
+    m_hasPids = false;
+}
+
+qint64 ProcReplay::nextTimestampMs() const
+{
+    return m_nextFrame < m_frames.size() ? m_frames[m_nextFrame].timestampMs : -1;
+}
+
+bool ProcReplay::nextFrame()
+{
+    if (m_nextFrame >= m_frames.size()) return false;
+    const FrameIndex &frame = m_frames[m_nextFrame++];
+    m_timestampMs = frame.timestampMs;
+    m_body = qUncompress(reinterpret_cast<const uchar *>(m_data.constData() + frame.offset), frame.size);
+    if (m_body.isEmpty() && frame.size > 4) return false; // corrupt
+    return parseFrame();
+}
+
+bool ProcReplay::parseFrame()
+{
+    m_entries.clear();
+    m_lookup.clear();
+    m_cursor = 0;
+    m_hasPids = false;
+
+    const char *base = m_body.constData();
+    const char *p = base;
+    const char *end = base + m_body.size();
+    while (p < end) {
+        Entry entry = {static_cast<quint8>(*p++), 0, 0, 0, 0, 0};
+        switch (entry.kind) {
+        case Capture::File:
+        case Capture::Missing:
+            if (p == end) return false;
+            entry.root = static_cast<quint8>(*p++);
+            if (!getBytes(p, end, base, &entry.pathOffset, &entry.pathLength)) return false;
+            if (entry.kind == Capture::File && !getBytes(p, end, base, &entry.dataOffset, &entry.dataLength)) return false;
+            break;
+        case Capture::Pids: {
+            quint64 count;
+            if (!Wire::getVarint(p, end, &count) || count > static_cast<quint64>(end - p)) return false;
+            m_pids.resize(static_cast<qsizetype>(count));
+            quint64 pid = 0;
+            for (int &value : m_pids) {
+                quint64 delta;
+                if (!Wire::getVarint(p, end, &delta)) return false;
+                pid += delta;
+                value = static_cast<int>(pid);
+            }
+            m_hasPids = true;
+            continue;
+        }
+        case Capture::DiskUsage: {
+            quint64 ignored;
+            if (!getBytes(p, end, base, &entry.pathOffset, &entry.pathLength)) return false;
+            entry.dataOffset = static_cast<int>(p - base);
+            if (!Wire::getVarint(p, end, &ignored) || !Wire::getVarint(p, end, &ignored)) return false;
+            entry.dataLength = static_cast<int>(p - base) - entry.dataOffset;
+            break;
+        }
+        default:
+            return false;
+        }
+        m_entries.append(entry);
+    }
+    return true;
+}
+
+bool ProcReplay::matches(const Entry &entry, ProcFs::Root root, const char *path, int pathLength) const
+{
+    return (entry.kind == Capture::File || entry.kind == Capture::Missing) && entry.root == root
+           && entry.pathLength == pathLength
+           && std::memcmp(m_body.constData() + entry.pathOffset, path, pathLength) == 0;
+}
+
+ProcText ProcReplay::file(ProcFs::Root root, const char *path)
+{
+    ProcText text;
+    const int pathLength = static_cast<int>(std::strlen(path));
+    int index = -1;
+    // Collectors normally read in recording order, so the next entry is
+    // almost always the one asked for.
+    if (m_cursor < m_entries.size() && matches(m_entries[m_cursor], root, path, pathLength)) {
+        index = m_cursor++;
+    } else {
+        if (m_lookup.isEmpty()) {
+            for (int i = 0; i < m_entries.size(); ++i) {
+                const Entry &entry = m_entries[i];
+                if (entry.kind == Capture::File || entry.kind == Capture::Missing)
+                    m_lookup.insert(lookupKey(entry.root, m_body.constData() + entry.pathOffset, entry.pathLength), i);
+            }
+        }
+        index = m_lookup.value(lookupKey(root, path, pathLength), -1);
+        if (index >= 0) m_cursor = index + 1;
+    }
+    if (index < 0 || m_entries[index].kind != Capture::File) return text;
+    text.begin = m_body.constData() + m_entries[index].dataOffset;
+    text.end = text.begin + m_entries[index].dataLength;
+    return text;
+}
+
+bool ProcReplay::pids(QVector<int> *pids) const
+{
+    if (!m_hasPids) {
+        pids->clear();
+        return false;
+    }
+    *pids = m_pids;
+    return true;
+}
+
+bool ProcReplay::diskUsage(const char *path, quint64 *totalBytes, quint64 *freeBytes) const
+{
+    const int pathLength = static_cast<int>(std::strlen(path));
+    for (const Entry &entry : m_entries) {
+        if (entry.kind != Capture::DiskUsage || entry.pathLength != pathLength
+            || std::memcmp(m_body.constData() + entry.pathOffset, path, pathLength) != 0) {
+            continue;
+        }
+        const char *p = m_body.constData() + entry.dataOffset;
+        const char *end = p + entry.dataLength;
+        return Wire::getVarint(p, end, totalBytes) && Wire::getVarint(p, end, freeBytes);
+    }
+    return false;
+}
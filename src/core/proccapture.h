@@ -0,0 +1,108 @@
+#ifndef PROCCAPTURE_H
+#define PROCCAPTURE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "procfs.h"
+
+// Recordings of the raw procfs bytes the collectors read, one frame per
+// monitor tick, so a misbehaving host can be replayed later through the same
+// parsers.
+//
+// File:  magic "SYSCAP", u8 version, then frames of
+//        varint timestamp ms, varint compressed size, qCompress(body)
+// Body:  entries in read order, each starting with a u8 kind:
+//        File       u8 root, path, bytes
+//        Missing    u8 root, path             (open or read failed)
+//        Pids       varint count, ascending pids as varint deltas
+//        DiskUsage  path, varint total bytes, varint free bytes
+// Paths and bytes are varint length + raw bytes.
+namespace Capture {
+
+constexpr quint8 Version = 1;
+
+enum EntryKind : quint8 { File = 1, Missing = 2, Pids = 3, DiskUsage = 4 };
+
+}
+
+class ProcCapture
+{
+public:
+    bool open(const QString &path, QString *error);
+    bool isOpen() const { return m_file.isOpen(); }
+    void close();
+
+    void beginFrame(qint64 timestampMs);
+    void addFile(ProcFs::Root root, const char *path, const ProcText &text);
+    void addPids(const QVector<int> &pids);
+    void addDiskUsage(const char *path, quint64 totalBytes, quint64 freeBytes);
+    // Compresses and appends the frame; false if the write failed.
+    bool endFrame();
+
+private:
+    QFile m_file;
+    QByteArray m_body;
+    QByteArray m_frame;
+    qint64 m_timestampMs = 0;
+};
+
+class ProcReplay
+{
+public:
+    bool open(const QString &path, QString *error);
+    bool isOpen() const { return !m_frames.isEmpty(); }
+    int frameCount() const { return m_frames.size(); }
+
+    // Decompresses the next frame; false at the end of the recording or if
+    // the frame is corrupt.
+    bool nextFrame();
+    qint64 timestampMs() const { return m_timestampMs; }
+    // Timestamp of the frame after the current one, -1 at the end.
+    qint64 nextTimestampMs() const;
+    void rewind();
+
+    // Null if the file was missing when recorded or was never read.
+    ProcText file(ProcFs::Root root, const char *path);
+    bool pids(QVector<int> *pids) const;
+    bool diskUsage(const char *path, quint64 *totalBytes, quint64 *freeBytes) const;
+
+private:
+    struct FrameIndex
+    {
+        qint64 timestampMs;
+        qsizetype offset;
+        qsizetype size;
+    };
+
+    struct Entry
+    {
+        quint8 kind;
+        quint8 root;
+        int pathOffset;
+        int pathLength;
+        int dataOffset;
+        int dataLength;
+    };
+
+    bool parseFrame();
+    bool matches(const Entry &entry, ProcFs::Root root, const char *path, int pathLength) const;
+
+    QByteArray m_data;
+    QVector<FrameIndex> m_frames;
+    int m_nextFrame = 0;
+    qint64 m_timestampMs = 0;
+
+    QByteArray m_body;
+    QVector<Entry> m_entries;
+    QVector<int> m_pids;
+    bool m_hasPids = false;
+    int m_cursor = 0;
+    // Built only if the collectors read files in a different order than they
+    // were recorded.
+    QHash<QByteArray, int> m_lookup;
+};
+
+#endif // PROCCAPTURE_H
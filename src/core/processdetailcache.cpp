@@ -0,0 +1,123 @@
+#include "processdetailcache.h"
+#include <QDateTime>
+#include <QPair>
+#include <QVector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Value of the first line starting with `key` ("Pss:", "read_bytes:").
+bool fieldValue(const char *text, const char *key, quint64 *value)
+{
+    const size_t keyLength = std::strlen(key);
+    for (const char *line = text; line && *line;) {
+        if (std::strncmp(line, key, keyLength) == 0) {
+            *value = std::strtoull(line + keyLength, nullptr, 10);
+            return true;
+        }
+        line = std::strchr(line, '\n');
+        if (line) ++line;
+    }
+    return false;
+}
+
+constexpr qint64 kForgetAfterMs = 60000;
+
+}
+
+ProcessDetailCache::ProcessDetailCache(int refreshIntervalMs, const QString &procRoot)
+    : m_procFs(procRoot, ProcFs::defaultSysRoot()),
+      m_refreshIntervalMs(refreshIntervalMs)
+{
+}
+
+void ProcessDetailCache::setWanted(const QSet<int> &pids)
+{
+    QMutexLocker locker(&m_mutex);
+    m_wanted = pids;
+}
+
+bool ProcessDetailCache::lookup(int pid, ProcessDetail *detail) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_cache.constFind(pid);
+    if (it == m_cache.constEnd()) return false;
+    *detail = it.value();
+    return true;
+}
+
+ProcessDetail ProcessDetailCache::get(int pid, int maxAgeMs)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    ProcessDetail previous;
+    {
+        QMutexLocker locker(&m_mutex);
+        previous = m_cache.value(pid);
+    }
+    if (previous.sampledAtMs > 0 && now - previous.sampledAtMs < maxAgeMs) return previous;
+
+    const ProcessDetail fresh = read(pid, previous, now);
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(pid, fresh);
+    return fresh;
+}
+
+void ProcessDetailCache::refreshWanted()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<QPair<int, ProcessDetail>> stale;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int pid : m_wanted) {
+            const ProcessDetail previous = m_cache.value(pid);
+            if (now - previous.sampledAtMs >= m_refreshIntervalMs) stale.append({pid, previous});
+        }
+        for (auto it = m_cache.begin(); it != m_cache.end();) {
+            if (!m_wanted.contains(it.key()) && now - it->sampledAtMs > kForgetAfterMs) it = m_cache.erase(it);
+            else ++it;
+        }
+    }
+    if (stale.isEmpty()) return;
+
+    // /proc is read without holding the lock so GUI lookups never wait on I/O.
+    for (auto &entry : stale) entry.second = read(entry.first, entry.second, now);
+
+    QMutexLocker locker(&m_mutex);
+    for (const auto &entry : stale) m_cache.insert(entry.first, entry.second);
+}
+
+ProcessDetail ProcessDetailCache::read(int pid, const ProcessDetail &previous, qint64 nowMs) const
+{
+    ProcessDetail detail;
+    detail.sampledAtMs = nowMs;
+    char path[64];
+    char buffer[4096];
+
+    std::snprintf(path, sizeof(path), "%d/smaps_rollup", pid);
+    if (m_procFs.readInto(ProcFs::Proc, path, buffer, sizeof(buffer)) > 0) {
+        quint64 pss = 0, privateClean = 0, privateDirty = 0, swap = 0;
+        detail.memoryValid = fieldValue(buffer, "Pss:", &pss);
+        fieldValue(buffer, "Private_Clean:", &privateClean);
+        fieldValue(buffer, "Private_Dirty:", &privateDirty);
+        fieldValue(buffer, "Swap:", &swap);
+        detail.pssMB = pss / 1024.0;
+        detail.ussMB = (privateClean + privateDirty) / 1024.0;
+        detail.swapMB = swap / 1024.0;
+    }
+
+    std::snprintf(path, sizeof(path), "%d/io", pid);
+    if (m_procFs.readInto(ProcFs::Proc, path, buffer, sizeof(buffer)) > 0) {
+        detail.ioValid = fieldValue(buffer, "read_bytes:", &detail.readBytes)
+                         && fieldValue(buffer, "write_bytes:", &detail.writeBytes);
+        const qint64 elapsedMs = nowMs - previous.sampledAtMs;
+        if (detail.ioValid && previous.ioValid && elapsedMs > 0) {
+            if (detail.readBytes >= previous.readBytes)
+                detail.readKBps = (detail.readBytes - previous.readBytes) * 1000.0 / elapsedMs / 1024.0;
+            if (detail.writeBytes >= previous.writeBytes)
+                detail.writeKBps = (detail.writeBytes - previous.writeBytes) * 1000.0 / elapsedMs / 1024.0;
+        }
+    }
+    return detail;
+}
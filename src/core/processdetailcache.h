@@ -0,0 +1,53 @@
+#ifndef PROCESSDETAILCACHE_H
+#define PROCESSDETAILCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include "procfs.h"
+
+// Expensive per-process details (PSS/USS from smaps_rollup, I/O counters from
+// /proc/<pid>/io). They are never collected by the full process scan; only
+// pids that someone asked for are read, each at most once per refresh
+// interval, and the results are cached. Shared between the monitor thread
+// and the GUI thread, hence the mutex.
+struct ProcessDetail
+{
+    qint64 sampledAtMs = 0;
+    bool memoryValid = false;   // smaps_rollup was readable
+    bool ioValid = false;       // io was readable
+    double pssMB = 0.0;
+    double ussMB = 0.0;
+    double swapMB = 0.0;
+    quint64 readBytes = 0;
+    quint64 writeBytes = 0;
+    double readKBps = 0.0;
+    double writeKBps = 0.0;
+};
+
+class ProcessDetailCache
+{
+public:
+    explicit ProcessDetailCache(int refreshIntervalMs = 5000, const QString &procRoot = ProcFs::defaultProcRoot());
+
+    // Pids whose details should be kept fresh (visible or selected rows).
+    void setWanted(const QSet<int> &pids);
+    // Called by the monitor every tick; reads only stale wanted pids.
+    void refreshWanted();
+    // Cached value only, never touches /proc.
+    bool lookup(int pid, ProcessDetail *detail) const;
+    // Cached value, refreshed first if older than maxAgeMs. Reads /proc, so
+    // call it from the monitor's thread, not the GUI's.
+    ProcessDetail get(int pid, int maxAgeMs);
+
+private:
+    ProcessDetail read(int pid, const ProcessDetail &previous, qint64 nowMs) const;
+
+    ProcFs m_procFs;
+    mutable QMutex m_mutex;
+    QHash<int, ProcessDetail> m_cache;
+    QSet<int> m_wanted;
+    int m_refreshIntervalMs;
+};
+
+#endif // PROCESSDETAILCACHE_H
@@ -0,0 +1,261 @@
+#include "procfs.h"
+#include "proccapture.h"
+#include <QDateTime>
+#include <QFile>
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/magic.h>
+#include <poll.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kInitialBufferSize = 64 * 1024;
+
+// getdents64 record; declared here because glibc only exposes it with
+// _GNU_SOURCE on recent versions.
+struct LinuxDirent64
+{
+    quint64 ino;
+    qint64 off;
+    unsigned short reclen;
+    unsigned char type;
+    char name[1];
+};
+
+int openRoot(const QString &path)
+{
+    return ::open(QFile::encodeName(path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+}
+
+ProcFs::ProcFs(const QString &procRoot, const QString &sysRoot)
+    : m_procRoot(procRoot),
+      m_sysRoot(sysRoot),
+      m_procFd(openRoot(procRoot)),
+      m_sysFd(openRoot(sysRoot))
+{
+    m_buffer.reserve(kInitialBufferSize);
+    struct statfs info;
+    m_procIsProcfs = m_procFd >= 0 && ::fstatfs(m_procFd, &info) == 0 && info.f_type == PROC_SUPER_MAGIC;
+}
+
+ProcFs::~ProcFs()
+{
+    if (m_procFd >= 0) ::close(m_procFd);
+    if (m_sysFd >= 0) ::close(m_sysFd);
+    if (m_mountsFd >= 0) ::close(m_mountsFd);
+}
+
+QString ProcFs::defaultProcRoot()
+{
+    const QString overrideRoot = qEnvironmentVariable("SYS_COPILOT_PROC_ROOT");
+    return overrideRoot.isEmpty() ? QString("/proc") : overrideRoot;
+}
+
+QString ProcFs::defaultSysRoot()
+{
+    const QString overrideRoot = qEnvironmentVariable("SYS_COPILOT_SYS_ROOT");
+    return overrideRoot.isEmpty() ? QString("/sys") : overrideRoot;
+}
+
+bool ProcFs::beginFrame()
+{
+    if (m_replay) {
+        if (!m_replay->nextFrame()) return false;
+        m_frameTimestampMs = m_replay->timestampMs();
+        return true;
+    }
+    m_frameTimestampMs = QDateTime::currentMSecsSinceEpoch();
+    if (m_capture) m_capture->beginFrame(m_frameTimestampMs);
+    return true;
+}
+
+void ProcFs::endFrame()
+{
+    if (m_replay) return; // beginFrame() did not open a capture frame either
+    if (m_capture && !m_capture->endFrame()) {
+        qWarning("Capture write failed; recording stopped");
+        m_capture->close();
+        m_capture = nullptr;
+    }
+}
+
+ProcText ProcFs::read(Root root, const char *path)
+{
+    if (m_replay) return m_replay->file(root, path);
+    const ProcText text = readAt(rootFd(root), path);
+    if (m_capture) m_capture->addFile(root, path, text);
+    return text;
+}
+
+ProcText ProcFs::readAt(int dirFd, const char *path)
+{
+    ProcText text;
+    if (dirFd < 0) return text;
+    const int fd = ::openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return text;
+
+    // procfs reports a size of 0, so read until EOF and grow only when a file
+    // outgrows everything read before.
+    qsizetype used = 0;
+    m_buffer.resize(m_buffer.capacity());
+    for (;;) {
+        if (used == m_buffer.size()) m_buffer.resize(m_buffer.size() * 2);
+        const ssize_t n = ::read(fd, m_buffer.data() + used, m_buffer.size() - used);
+        if (n < 0) {
+            ::close(fd);
+            return text;
+        }
+        if (n == 0) break;
+        used += n;
+    }
+    ::close(fd);
+    text.begin = m_buffer.constData();
+    text.end = text.begin + used;
+    return text;
+}
+
+ProcText ProcFs::readPid(int pid, const char *name)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "%d/%s", pid, name);
+    return read(Proc, path);
+}
+
+bool ProcFs::listPids(QVector<int> *pids)
+{
+    if (m_replay) return m_replay->pids(pids);
+    pids->clear();
+    if (m_procFd < 0) return false;
+    const int fd = ::openat(m_procFd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool listed = listNumeric(fd, pids);
+    ::close(fd);
+    if (listed && m_capture) m_capture->addPids(*pids);
+    return listed;
+}
+
+bool ProcFs::listNumeric(int dirFd, QVector<int> *numbers)
+{
+    numbers->clear();
+    if (dirFd < 0 || ::lseek(dirFd, 0, SEEK_SET) < 0) return false;
+    alignas(8) char buffer[32 * 1024];
+    for (;;) {
+        const long n = ::syscall(SYS_getdents64, dirFd, buffer, sizeof(buffer));
+        if (n < 0) return false;
+        if (n == 0) break;
+        for (long offset = 0; offset < n;) {
+            const LinuxDirent64 *entry = reinterpret_cast<const LinuxDirent64 *>(buffer + offset);
+            offset += entry->reclen;
+            const char *name = entry->name;
+            if (*name < '1' || *name > '9') continue;
+            int number = 0;
+            while (*name >= '0' && *name <= '9') number = number * 10 + (*name++ - '0');
+            if (*name == '\0') numbers->append(number);
+        }
+    }
+    std::sort(numbers->begin(), numbers->end());
+    return true;
+}
+
+bool ProcFs::listSubdirectories(int dirFd, QVector<QByteArray> *names)
+{
+    names->clear();
+    if (dirFd < 0 || ::lseek(dirFd, 0, SEEK_SET) < 0) return false;
+    alignas(8) char buffer[32 * 1024];
+    for (;;) {
+        const long n = ::syscall(SYS_getdents64, dirFd, buffer, sizeof(buffer));
+        if (n < 0) return false;
+        if (n == 0) break;
+        for (long offset = 0; offset < n;) {
+            const LinuxDirent64 *entry = reinterpret_cast<const LinuxDirent64 *>(buffer + offset);
+            offset += entry->reclen;
+            const char *name = entry->name;
+            if (entry->type != DT_DIR || (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))) continue;
+            names->append(QByteArray(name));
+        }
+    }
+    return true;
+}
+
+bool ProcFs::diskUsage(const char *path, quint64 *totalBytes, quint64 *freeBytes)
+{
+    if (m_replay) return m_replay->diskUsage(path, totalBytes, freeBytes);
+    struct statvfs stat;
+    if (statvfs(path, &stat) != 0) return false;
+    *totalBytes = static_cast<quint64>(stat.f_blocks) * stat.f_frsize;
+    *freeBytes = static_cast<quint64>(stat.f_bfree) * stat.f_frsize;
+    if (m_capture) m_capture->addDiskUsage(path, *totalBytes, *freeBytes);
+    return true;
+}
+
+bool ProcFs::mountsChanged()
+{
+    if (m_replay) return true;
+    if (m_mountsFd < 0) {
+        if (m_procFd >= 0) m_mountsFd = ::openat(m_procFd, "self/mountinfo", O_RDONLY | O_CLOEXEC);
+        return true;
+    }
+    // The kernel flags POLLPRI on a mountinfo fd once per change of the mount
+    // namespace; plain files (fixtures) never do.
+    pollfd pfd = {m_mountsFd, POLLPRI, 0};
+    return ::poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLPRI | POLLERR));
+}
+
+int ProcFs::readInto(Root root, const char *path, char *buffer, int size) const
+{
+    const int dirFd = rootFd(root);
+    if (dirFd < 0) return -1;
+    const int fd = ::openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    int used = 0;
+    while (used < size - 1) {
+        const ssize_t n = ::read(fd, buffer + used, size - 1 - used);
+        if (n < 0) {
+            ::close(fd);
+            return -1;
+        }
+        if (n == 0) break;
+        used += static_cast<int>(n);
+    }
+    ::close(fd);
+    buffer[used] = '\0';
+    return used;
+}
+
+bool ProcParse::parsePidStat(const ProcText &text, PidStat *stat)
+{
+    // "pid (comm) S ppid pgrp session tty tpgid flags minflt cminflt majflt
+    // cmajflt utime stime ... starttime ... processor"
+    const char *open = text.begin;
+    while (open < text.end && *open != '(') ++open;
+    const char *close = text.end;
+    while (close > open && *(close - 1) != ')') --close;
+    if (open == text.end || close == open) return false;
+    stat->name = open + 1;
+    stat->nameLength = static_cast<int>(close - 1 - stat->name);
+
+    const char *p = close;
+    const char *token;
+    int length;
+    readToken(p, text.end, &token, &length);
+    stat->state = length > 0 ? *token : '?';
+    for (int field = 4; field <= 8; ++field) readToken(p, text.end, &token, &length);
+    if (!readU64(p, text.end, &stat->flags)) return false;
+    for (int field = 10; field <= 13; ++field) readToken(p, text.end, &token, &length);
+    quint64 processor = 0;
+    if (!readU64(p, text.end, &stat->utime) || !readU64(p, text.end, &stat->stime)) return false;
+    for (int field = 16; field <= 21; ++field) readToken(p, text.end, &token, &length);
+    if (!readU64(p, text.end, &stat->startTime)) return false;
+    for (int field = 23; field <= 38; ++field) readToken(p, text.end, &token, &length);
+    readU64(p, text.end, &processor);
+    stat->processor = static_cast<int>(processor);
+    return true;
+}
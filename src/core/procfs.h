@@ -0,0 +1,174 @@
+#ifndef PROCFS_H
+#define PROCFS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class ProcCapture;
+class ProcReplay;
+
+// Read-only view of a file's bytes. Valid until the next read on the ProcFs
+// that produced it.
+struct ProcText
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+
+    bool isNull() const { return begin == nullptr; }
+    int size() const { return static_cast<int>(end - begin); }
+};
+
+// Access to procfs and sysfs relative to configurable roots, so collectors
+// can run against synthetic or recorded trees. Every file is opened with
+// openat() against a directory fd held for the lifetime of the object, and
+// read into a buffer that is reused across reads; steady-state reads do not
+// allocate. An instance is not thread-safe except for readInto().
+//
+// With a capture attached, everything read between beginFrame() and
+// endFrame() is also recorded; with a replay attached, reads are served from
+// the recording instead of the roots. readAt() and readInto() are never
+// recorded.
+class ProcFs
+{
+public:
+    enum Root { Proc, Sys };
+
+    explicit ProcFs(const QString &procRoot = defaultProcRoot(), const QString &sysRoot = defaultSysRoot());
+    ~ProcFs();
+    ProcFs(const ProcFs &) = delete;
+    ProcFs &operator=(const ProcFs &) = delete;
+
+    // $SYS_COPILOT_PROC_ROOT / $SYS_COPILOT_SYS_ROOT, else /proc and /sys.
+    static QString defaultProcRoot();
+    static QString defaultSysRoot();
+
+    QString procRoot() const { return m_procRoot; }
+    QString sysRoot() const { return m_sysRoot; }
+    bool isValid() const { return m_procFd >= 0; }
+
+    // Whole file, e.g. read(Proc, "meminfo"). Null text if it can't be read.
+    ProcText read(Root root, const char *path);
+    // <proc>/<pid>/<name>
+    ProcText readPid(int pid, const char *name);
+    // Numeric entries of the proc root, ascending.
+    bool listPids(QVector<int> *pids);
+
+    // statvfs() of an absolute path (not relative to the roots).
+    bool diskUsage(const char *path, quint64 *totalBytes, quint64 *freeBytes);
+    // True on the first call and whenever <proc>/self/mountinfo changed since
+    // the last one. Polls a held fd, so nothing is read while mounts stay put.
+    // Always true when replaying: frames only carry mountinfo when it changed.
+    bool mountsChanged();
+
+    // Neither object is owned; pass nullptr to detach.
+    void setCapture(ProcCapture *capture) { m_capture = capture; }
+    void setReplay(ProcReplay *replay) { m_replay = replay; }
+    bool isReplaying() const { return m_replay != nullptr; }
+    bool isRecording() const { return m_capture != nullptr; }
+    // Reads describe this host: not replaying, and the proc root is a procfs
+    // mount rather than a synthetic tree. Pids are only acted on when true.
+    bool isLive() const { return !m_replay && m_procIsProcfs; }
+    // Brackets one tick. beginFrame() is false once a replay is exhausted.
+    bool beginFrame();
+    void endFrame();
+    // Wall clock when the frame began, or the recorded time when replaying.
+    qint64 nowMs() const { return m_frameTimestampMs; }
+
+    // Root directory fd, for callers that hold their own directory fds below it.
+    int rootFd(Root root) const { return root == Proc ? m_procFd : m_sysFd; }
+    // Like read(), but relative to a directory fd the caller keeps open.
+    ProcText readAt(int dirFd, const char *path);
+    // Names of the subdirectories of dirFd, in directory order. Rewinds the
+    // fd first, so the same fd can be listed again later.
+    static bool listSubdirectories(int dirFd, QVector<QByteArray> *names);
+    // Numeric entries of dirFd (pids, or tids under <pid>/task), ascending.
+    static bool listNumeric(int dirFd, QVector<int> *numbers);
+
+    // Thread-safe read into a caller-supplied buffer, NUL-terminated.
+    // Returns the number of bytes read or -1.
+    int readInto(Root root, const char *path, char *buffer, int size) const;
+
+private:
+
+    QString m_procRoot;
+    QString m_sysRoot;
+    int m_procFd = -1;
+    int m_sysFd = -1;
+    int m_mountsFd = -1;
+    bool m_procIsProcfs = false;
+    QByteArray m_buffer;
+    ProcCapture *m_capture = nullptr;
+    ProcReplay *m_replay = nullptr;
+    qint64 m_frameTimestampMs = 0;
+};
+
+// Allocation-free scanning helpers over [p, end), in the style of the wire
+// protocol readers: each advances `p` past what it consumed.
+namespace ProcParse {
+
+inline void skipSpaces(const char *&p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+}
+
+inline bool nextLine(const char *&p, const char *end)
+{
+    while (p < end && *p != '\n') ++p;
+    if (p == end) return false;
+    ++p;
+    return p < end;
+}
+
+// Unsigned decimal after optional blanks; false if there are no digits.
+inline bool readU64(const char *&p, const char *end, quint64 *value)
+{
+    skipSpaces(p, end);
+    const char *start = p;
+    quint64 result = 0;
+    while (p < end && *p >= '0' && *p <= '9') result = result * 10 + quint64(*p++ - '0');
+    *value = result;
+    return p != start;
+}
+
+// Token up to the next blank or newline.
+inline void readToken(const char *&p, const char *end, const char **token, int *length)
+{
+    skipSpaces(p, end);
+    const char *start = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\n') ++p;
+    *token = start;
+    *length = static_cast<int>(p - start);
+}
+
+// The fields of /proc/<pid>/stat (or task/<tid>/stat) the collectors use.
+// `name` points into the text.
+struct PidStat
+{
+    const char *name;
+    int nameLength;
+    char state;
+    quint64 flags;        // PF_* task flags
+    quint64 utime, stime; // clock ticks
+    quint64 startTime;    // clock ticks after boot; tells a reused pid apart
+    int processor;
+};
+
+// comm may itself contain ") ", so fields are counted from the last ')'.
+bool parsePidStat(const ProcText &text, PidStat *stat);
+
+// True and advances past `key` if the text at `p` starts with it.
+template <int N>
+inline bool consume(const char *&p, const char *end, const char (&key)[N])
+{
+    if (end - p < N - 1) return false;
+    for (int i = 0; i < N - 1; ++i) {
+        if (p[i] != key[i]) return false;
+    }
+    p += N - 1;
+    return true;
+}
+
+}
+
+#endif // PROCFS_H
@@ -0,0 +1,214 @@
+#include "selfprofiler.h"
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QMutex>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+struct ProbeHistogram
+{
+    std::atomic<quint64> buckets[LatencyHistogram::BucketCount] = {};
+    std::atomic<quint64> count{0};
+    std::atomic<quint64> sum{0};
+    std::atomic<quint64> min{std::numeric_limits<quint64>::max()};
+    std::atomic<quint64> max{0};
+};
+
+struct TraceEvent
+{
+    std::atomic<int> probe{-1};
+    std::atomic<qint64> startNs{0};
+    std::atomic<qint64> durationNs{0};
+};
+
+// One per thread that ever recorded. Written only by its owner; read by
+// snapshot() from any thread. Kept after the thread exits so its samples
+// still count. Holds a histogram for every registered probe: probe()
+// allocates one for each existing thread, and a new thread gets one for
+// each existing probe, so record() never allocates one.
+struct ThreadState
+{
+    int index = 0;
+    QString name;
+    std::atomic<ProbeHistogram *> probes[SelfProfiler::MaxProbes] = {};
+    TraceEvent trace[SelfProfiler::TraceCapacity];
+    std::atomic<quint64> traceHead{0};
+};
+
+QMutex g_registryMutex;
+const char *g_probeNames[SelfProfiler::MaxProbes];
+std::atomic<int> g_probeCount{0};
+QList<ThreadState *> g_threads;
+std::atomic<bool> g_tracing{false};
+std::atomic<qint64> g_resetAtNs{SelfProfiler::now()};
+
+thread_local ThreadState *t_state = nullptr;
+
+ThreadState *threadState()
+{
+    if (t_state) return t_state;
+    ThreadState *state = new ThreadState;
+    QThread *thread = QThread::currentThread();
+    if (thread && !thread->objectName().isEmpty()) state->name = thread->objectName();
+    else if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) state->name = "main";
+    QMutexLocker locker(&g_registryMutex);
+    const int probes = g_probeCount.load(std::memory_order_relaxed);
+    for (int probe = 0; probe < probes; ++probe) state->probes[probe].store(new ProbeHistogram, std::memory_order_release);
+    state->index = g_threads.size() + 1;
+    if (state->name.isEmpty()) state->name = QString("thread %1").arg(state->index);
+    g_threads.append(state);
+    t_state = state;
+    return state;
+}
+
+void updateMin(std::atomic<quint64> &target, quint64 value)
+{
+    quint64 current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void updateMax(std::atomic<quint64> &target, quint64 value)
+{
+    quint64 current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+}
+
+qint64 SelfProfiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int SelfProfiler::probe(const char *name)
+{
+    QMutexLocker locker(&g_registryMutex);
+    const int count = g_probeCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (std::strcmp(g_probeNames[i], name) == 0) return i;
+    }
+    if (count == MaxProbes) return -1;
+    for (ThreadState *state : g_threads) state->probes[count].store(new ProbeHistogram, std::memory_order_release);
+    g_probeNames[count] = name;
+    g_probeCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void SelfProfiler::record(int probe, qint64 startNs, qint64 endNs)
+{
+    if (probe < 0) return;
+    ThreadState *state = threadState();
+    ProbeHistogram *histogram = state->probes[probe].load(std::memory_order_acquire);
+    if (!histogram) return; // probe id not from probe()
+    const quint64 duration = endNs > startNs ? static_cast<quint64>(endNs - startNs) : 0;
+    histogram->buckets[LatencyHistogram::bucketFor(duration)].fetch_add(1, std::memory_order_relaxed);
+    histogram->count.fetch_add(1, std::memory_order_relaxed);
+    histogram->sum.fetch_add(duration, std::memory_order_relaxed);
+    updateMin(histogram->min, duration);
+    updateMax(histogram->max, duration);
+
+    if (g_tracing.load(std::memory_order_relaxed)) {
+        const quint64 slot = state->traceHead.load(std::memory_order_relaxed);
+        TraceEvent &event = state->trace[slot % TraceCapacity];
+        event.probe.store(probe, std::memory_order_relaxed);
+        event.startNs.store(startNs, std::memory_order_relaxed);
+        event.durationNs.store(static_cast<qint64>(duration), std::memory_order_relaxed);
+        state->traceHead.store(slot + 1, std::memory_order_release);
+    }
+}
+
+void SelfProfiler::setTracing(bool enabled)
+{
+    g_tracing.store(enabled, std::memory_order_relaxed);
+}
+
+bool SelfProfiler::isTracing()
+{
+    return g_tracing.load(std::memory_order_relaxed);
+}
+
+QList<SelfProfiler::ProbeStats> SelfProfiler::snapshot()
+{
+    QMutexLocker locker(&g_registryMutex);
+    const int count = g_probeCount.load(std::memory_order_acquire);
+    QList<ProbeStats> stats(count);
+    std::array<quint64, LatencyHistogram::BucketCount> buckets;
+    for (int probe = 0; probe < count; ++probe) {
+        stats[probe].name = QString::fromLatin1(g_probeNames[probe]);
+        for (const ThreadState *state : g_threads) {
+            const ProbeHistogram *histogram = state->probes[probe].load(std::memory_order_acquire);
+            if (!histogram || histogram->count.load(std::memory_order_relaxed) == 0) continue;
+            for (int i = 0; i < LatencyHistogram::BucketCount; ++i) buckets[i] = histogram->buckets[i].load(std::memory_order_relaxed);
+            const quint64 sum = histogram->sum.load(std::memory_order_relaxed);
+            stats[probe].histogram.addBuckets(buckets.data(), sum, histogram->min.load(std::memory_order_relaxed),
+                                              histogram->max.load(std::memory_order_relaxed));
+            stats[probe].totalNs += sum;
+        }
+    }
+    return stats;
+}
+
+qint64 SelfProfiler::elapsedSinceReset()
+{
+    return now() - g_resetAtNs.load(std::memory_order_relaxed);
+}
+
+void SelfProfiler::reset()
+{
+    // A sample recorded concurrently may survive partially; good enough for
+    // a diagnostics view.
+    QMutexLocker locker(&g_registryMutex);
+    for (ThreadState *state : g_threads) {
+        for (auto &slot : state->probes) {
+            ProbeHistogram *histogram = slot.load(std::memory_order_acquire);
+            if (!histogram) continue;
+            for (auto &bucket : histogram->buckets) bucket.store(0, std::memory_order_relaxed);
+            histogram->count.store(0, std::memory_order_relaxed);
+            histogram->sum.store(0, std::memory_order_relaxed);
+            histogram->min.store(std::numeric_limits<quint64>::max(), std::memory_order_relaxed);
+            histogram->max.store(0, std::memory_order_relaxed);
+        }
+    }
+    g_resetAtNs.store(now(), std::memory_order_relaxed);
+}
+
+QJsonObject SelfProfiler::chromeTrace()
+{
+    QMutexLocker locker(&g_registryMutex);
+    QJsonArray events;
+    for (const ThreadState *state : g_threads) {
+        QJsonObject threadName;
+        threadName["name"] = "thread_name";
+        threadName["ph"] = "M";
+        threadName["pid"] = 1;
+        threadName["tid"] = state->index;
+        threadName["args"] = QJsonObject{{"name", state->name}};
+        events.append(threadName);
+
+        const quint64 head = state->traceHead.load(std::memory_order_acquire);
+        const quint64 first = head > quint64(TraceCapacity) ? head - TraceCapacity : 0;
+        for (quint64 slot = first; slot < head; ++slot) {
+            const TraceEvent &event = state->trace[slot % TraceCapacity];
+            const int probe = event.probe.load(std::memory_order_relaxed);
+            if (probe < 0) continue;
+            QJsonObject entry;
+            entry["name"] = QString::fromLatin1(g_probeNames[probe]);
+            entry["ph"] = "X";
+            entry["pid"] = 1;
+            entry["tid"] = state->index;
+            entry["ts"] = event.startNs.load(std::memory_order_relaxed) / 1000.0;
+            entry["dur"] = event.durationNs.load(std::memory_order_relaxed) / 1000.0;
+            events.append(entry);
+        }
+    }
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+    return trace;
+}
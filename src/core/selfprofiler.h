@@ -0,0 +1,66 @@
+#ifndef SELFPROFILER_H
+#define SELFPROFILER_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include "../common/latencyhistogram.h"
+
+// Timers for the monitor's own work: collectors, signal hops, UI updates.
+//
+// Probes are registered once by name. Each thread records into its own
+// histograms with relaxed atomics, so recording never takes a lock and never
+// contends with another thread; readers merge all threads on demand. When
+// tracing is switched on, each thread also keeps its most recent spans in a
+// ring buffer for Chrome trace export (chrome://tracing, Perfetto).
+class SelfProfiler
+{
+public:
+    enum { MaxProbes = 64, TraceCapacity = 8192 };
+
+    struct ProbeStats
+    {
+        QString name;
+        LatencyHistogram histogram;
+        quint64 totalNs = 0;
+    };
+
+    // Monotonic nanoseconds, comparable across threads.
+    static qint64 now();
+    // Returns the id for `name`, registering it on first use; -1 if full.
+    static int probe(const char *name);
+    static void record(int probe, qint64 startNs, qint64 endNs);
+
+    static void setTracing(bool enabled);
+    static bool isTracing();
+
+    // Merged over all threads, in registration order.
+    static QList<ProbeStats> snapshot();
+    // Nanoseconds since the last reset(), for overhead ratios.
+    static qint64 elapsedSinceReset();
+    static void reset();
+    // {"traceEvents": [...]} with complete ("X") events in microseconds.
+    static QJsonObject chromeTrace();
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(int probe) : m_probe(probe), m_startNs(SelfProfiler::now()) {}
+    ~ProfileScope() { SelfProfiler::record(m_probe, m_startNs, SelfProfiler::now()); }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    int m_probe;
+    qint64 m_startNs;
+};
+
+#define SELFPROFILER_CONCAT2(a, b) a##b
+#define SELFPROFILER_CONCAT(a, b) SELFPROFILER_CONCAT2(a, b)
+// Times the rest of the enclosing block under `name` (a string literal).
+#define PROFILE_SCOPE(name) \
+    static const int SELFPROFILER_CONCAT(profileProbe_, __LINE__) = SelfProfiler::probe(name); \
+    ProfileScope SELFPROFILER_CONCAT(profileScope_, __LINE__)(SELFPROFILER_CONCAT(profileProbe_, __LINE__))
+
+#endif // SELFPROFILER_H
@@ -0,0 +1,207 @@
+#include "sensorcollector.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+int openDirectory(int dirFd, const char *path)
+{
+    return ::openat(dirFd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+// Entry names of dirFd, following symlinks (hwmonN entries are links).
+// Consumes dirFd.
+QVector<QByteArray> listEntries(int dirFd)
+{
+    QVector<QByteArray> names;
+    DIR *dir = ::fdopendir(dirFd);
+    if (!dir) {
+        ::close(dirFd);
+        return names;
+    }
+    while (const dirent *entry = ::readdir(dir)) {
+        if (entry->d_name[0] != '.') names.append(QByteArray(entry->d_name));
+    }
+    ::closedir(dir);
+    return names;
+}
+
+// A sysfs attribute is a single signed decimal; pread() at 0 re-generates it.
+bool preadValue(int fd, qint64 *value)
+{
+    char buffer[32];
+    const ssize_t n = ::pread(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return false;
+    const char *p = buffer;
+    const char *end = buffer + n;
+    const bool negative = *p == '-';
+    if (negative) ++p;
+    quint64 magnitude;
+    if (!ProcParse::readU64(p, end, &magnitude)) return false;
+    *value = negative ? -static_cast<qint64>(magnitude) : static_cast<qint64>(magnitude);
+    return true;
+}
+
+bool readAttribute(int dirFd, const char *path, qint64 *value)
+{
+    const int fd = ::openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool read = preadValue(fd, value);
+    ::close(fd);
+    return read;
+}
+
+QString readLine(ProcFs *procFs, int dirFd, const char *path)
+{
+    const ProcText text = procFs->readAt(dirFd, path);
+    if (text.isNull()) return QString();
+    const char *end = text.begin;
+    while (end < text.end && *end != '\n') ++end;
+    return QString::fromUtf8(text.begin, static_cast<int>(end - text.begin));
+}
+
+// Drivers that read the CPU's own die sensors. acpitz is left out: its zones
+// are whatever the firmware picked, often the chassis or the chipset.
+bool isCpuChip(const QString &chip)
+{
+    return chip == "coretemp" || chip == "k10temp" || chip == "zenpower" || chip == "cpu_thermal";
+}
+
+}
+
+SensorCollector::SensorCollector(ProcFs *procFs)
+    : m_procFs(procFs)
+{
+}
+
+SensorCollector::~SensorCollector()
+{
+    for (const QVector<Input> *inputs : {&m_sensorInputs, &m_frequencyInputs, &m_throttleInputs}) {
+        for (const Input &input : *inputs) ::close(input.fd);
+    }
+}
+
+void SensorCollector::discover()
+{
+    if (m_discovered) return;
+    m_discovered = true;
+    const int sysFd = m_procFs->rootFd(ProcFs::Sys);
+    if (sysFd < 0) return;
+    discoverHwmon(sysFd);
+    discoverCpus(sysFd);
+}
+
+// temp<N>_input in millidegrees C, fan<N>_input in RPM.
+void SensorCollector::discoverHwmon(int sysFd)
+{
+    const int classFd = openDirectory(sysFd, "class/hwmon");
+    if (classFd < 0) return;
+    const int keptClassFd = ::dup(classFd);
+    QVector<QByteArray> chips = listEntries(classFd);
+    std::sort(chips.begin(), chips.end());
+    for (const QByteArray &chipName : chips) {
+        const int chipFd = openDirectory(keptClassFd, chipName.constData());
+        if (chipFd < 0) continue;
+        QString chip = readLine(m_procFs, chipFd, "name");
+        if (chip.isEmpty()) chip = QString::fromUtf8(chipName);
+        const int listFd = ::dup(chipFd);
+        QVector<QByteArray> files = listFd >= 0 ? listEntries(listFd) : QVector<QByteArray>();
+        std::sort(files.begin(), files.end());
+        for (const QByteArray &file : files) {
+            const bool temperature = file.startsWith("temp");
+            if ((!temperature && !file.startsWith("fan")) || !file.endsWith("_input")) continue;
+            const int fd = ::openat(chipFd, file.constData(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            const QByteArray base = file.left(file.size() - 6); // "temp1"
+            SensorData sensor;
+            sensor.kind = temperature ? SensorData::Temperature : SensorData::Fan;
+            sensor.chip = chip;
+            sensor.label = readLine(m_procFs, chipFd, (base + "_label").constData());
+            if (sensor.label.isEmpty()) sensor.label = QString::fromUtf8(base);
+            sensor.value = 0.0;
+            sensor.critical = 0.0;
+            qint64 limit;
+            if (temperature && (readAttribute(chipFd, (base + "_crit").constData(), &limit)
+                                || readAttribute(chipFd, (base + "_max").constData(), &limit))
+                && limit > 0) {
+                sensor.critical = limit / 1000.0;
+            }
+            m_sensorInputs.append({fd, static_cast<int>(m_sensors.size()), temperature ? 0.001 : 1.0});
+            m_cpuSensor.append(temperature && isCpuChip(chip));
+            m_sensors.append(sensor);
+        }
+        ::close(chipFd);
+    }
+    if (keptClassFd >= 0) ::close(keptClassFd);
+}
+
+// cpufreq values are in kHz; thermal_throttle exists on x86 only.
+void SensorCollector::discoverCpus(int sysFd)
+{
+    const int cpusFd = openDirectory(sysFd, "devices/system/cpu");
+    if (cpusFd < 0) return;
+    QVector<int> cpus;
+    const int listFd = ::dup(cpusFd);
+    for (const QByteArray &name : listFd >= 0 ? listEntries(listFd) : QVector<QByteArray>()) {
+        bool ok = false;
+        const int cpu = name.startsWith("cpu") ? name.mid(3).toInt(&ok) : -1;
+        if (ok && cpu >= 0) cpus.append(cpu);
+    }
+    std::sort(cpus.begin(), cpus.end());
+
+    char path[96];
+    for (int cpu : cpus) {
+        CpuFrequencyData frequency = {cpu, 0.0, 0.0, 0};
+        qint64 maxKHz;
+        std::snprintf(path, sizeof(path), "cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+        if (readAttribute(cpusFd, path, &maxKHz)) frequency.maxMHz = maxKHz / 1000.0;
+        std::snprintf(path, sizeof(path), "cpu%d/cpufreq/scaling_cur_freq", cpu);
+        const int frequencyFd = ::openat(cpusFd, path, O_RDONLY | O_CLOEXEC);
+        std::snprintf(path, sizeof(path), "cpu%d/thermal_throttle/core_throttle_count", cpu);
+        const int throttleFd = ::openat(cpusFd, path, O_RDONLY | O_CLOEXEC);
+        if (frequencyFd < 0 && throttleFd < 0) continue;
+        const int index = m_frequencies.size();
+        if (frequencyFd >= 0) m_frequencyInputs.append({frequencyFd, index, 0.001});
+        if (throttleFd >= 0) m_throttleInputs.append({throttleFd, index, 1.0});
+        m_maxFrequencyMHz = qMax(m_maxFrequencyMHz, frequency.maxMHz);
+        m_frequencies.append(frequency);
+    }
+    ::close(cpusFd);
+}
+
+void SensorCollector::collect(QList<SensorData> *sensors, QList<CpuFrequencyData> *frequencies)
+{
+    qint64 raw;
+    for (const Input &input : m_sensorInputs) {
+        if (preadValue(input.fd, &raw)) m_sensors[input.index].value = raw * input.scale;
+    }
+    for (const Input &input : m_frequencyInputs) {
+        if (preadValue(input.fd, &raw)) m_frequencies[input.index].currentMHz = raw * input.scale;
+    }
+    for (const Input &input : m_throttleInputs) {
+        if (preadValue(input.fd, &raw) && raw >= 0) m_frequencies[input.index].throttleCount = static_cast<quint64>(raw);
+    }
+    *sensors = m_sensors;
+    *frequencies = m_frequencies;
+}
+
+double SensorCollector::cpuTemperature() const
+{
+    double hottest = 0.0;
+    for (int i = 0; i < m_sensors.size(); ++i) {
+        if (m_cpuSensor[i]) hottest = qMax(hottest, m_sensors[i].value);
+    }
+    return hottest;
+}
+
+double SensorCollector::averageFrequencyMHz() const
+{
+    if (m_frequencyInputs.isEmpty()) return 0.0;
+    double sum = 0.0;
+    for (const Input &input : m_frequencyInputs) sum += m_frequencies[input.index].currentMHz;
+    return sum / m_frequencyInputs.size();
+}
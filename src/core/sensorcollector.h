@@ -0,0 +1,64 @@
+#ifndef SENSORCOLLECTOR_H
+#define SENSORCOLLECTOR_H
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include "../common/systemdata.h"
+#include "procfs.h"
+
+// Temperatures and fan speeds from <sys>/class/hwmon, and per-CPU clock and
+// thermal throttle counters from <sys>/devices/system/cpu/cpu*.
+//
+// Everything is discovered once: each value file is opened then and its fd
+// kept, and the static attributes (labels, critical limits, maximum clocks)
+// are read only then. A tick is one pread() at offset 0 per held fd, which
+// makes sysfs regenerate the value, with no path lookups. The lists handed
+// out by collect() share data with the collector's, so the next tick's
+// writes detach them: one copy of each list per tick, no per-sensor
+// allocation. Reads bypass ProcFs capture, so sensors are empty when
+// replaying.
+class SensorCollector
+{
+public:
+    explicit SensorCollector(ProcFs *procFs);
+    ~SensorCollector();
+    SensorCollector(const SensorCollector &) = delete;
+    SensorCollector &operator=(const SensorCollector &) = delete;
+
+    // Finds and opens the inputs; later calls do nothing.
+    void discover();
+    bool isAvailable() const { return !m_sensors.isEmpty() || !m_frequencies.isEmpty(); }
+    // Highest cpuinfo_max_freq of any CPU, 0 without cpufreq.
+    double maxFrequencyMHz() const { return m_maxFrequencyMHz; }
+
+    void collect(QList<SensorData> *sensors, QList<CpuFrequencyData> *frequencies);
+    // Hottest CPU package or core sensor (coretemp, k10temp, zenpower,
+    // cpu_thermal), 0 if none.
+    double cpuTemperature() const;
+    // Mean current clock over all CPUs, 0 without cpufreq.
+    double averageFrequencyMHz() const;
+
+private:
+    struct Input
+    {
+        int fd;
+        int index;    // into m_sensors, or m_frequencies for CPU inputs
+        double scale; // raw value to reported unit
+    };
+
+    void discoverHwmon(int sysFd);
+    void discoverCpus(int sysFd);
+
+    ProcFs *m_procFs;
+    bool m_discovered = false;
+    QVector<Input> m_sensorInputs;
+    QVector<Input> m_frequencyInputs;
+    QVector<Input> m_throttleInputs;
+    QVector<bool> m_cpuSensor; // parallel to m_sensors
+    QList<SensorData> m_sensors;
+    QList<CpuFrequencyData> m_frequencies;
+    double m_maxFrequencyMHz = 0.0;
+};
+
+#endif // SENSORCOLLECTOR_H
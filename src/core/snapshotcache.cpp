@@ -0,0 +1,50 @@
+#include "snapshotcache.h"
+#include "../common/wireprotocol.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+// A corrupt or foreign file is rejected long before it costs real memory.
+constexpr qint64 kMaxSnapshotBytes = 16 * 1024 * 1024;
+
+}
+
+QString SnapshotCache::defaultPath()
+{
+    const QString overridePath = qEnvironmentVariable("SYS_COPILOT_SNAPSHOT");
+    if (!overridePath.isEmpty()) return overridePath;
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/last-sample.bin";
+}
+
+bool SnapshotCache::save(const QString &path, const SystemData &data, QString *error)
+{
+    WireEncoder encoder;
+    QByteArray bytes = encoder.encodeHello(data);
+    encoder.encodeDelta(data);
+    bytes += encoder.encodeSnapshot();
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    // Written aside and renamed, so a crash mid-write leaves the previous one.
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotCache::load(const QString &path, SystemData *data, QDateTime *savedAt)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() > kMaxSnapshotBytes) return false;
+    WireDecoder decoder;
+    decoder.append(file.readAll());
+    if (decoder.next() != WireDecoder::HelloFrame || decoder.next() != WireDecoder::SampleFrame) return false;
+    *data = decoder.data();
+    if (savedAt) *savedAt = QFileInfo(path).lastModified();
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef SNAPSHOTCACHE_H
+#define SNAPSHOTCACHE_H
+
+#include <QDateTime>
+#include <QString>
+#include "../common/systemdata.h"
+
+// The last sample of a session, kept so the next launch can paint before the
+// monitor's first tick. Stored as the agent protocol's Hello and Snapshot
+// frames, so it holds what a remote host shows: the static data, the headline
+// scalars and every process's name and memory.
+class SnapshotCache
+{
+public:
+    // $SYS_COPILOT_SNAPSHOT, or last-sample.bin in the user's cache directory.
+    static QString defaultPath();
+    static bool save(const QString &path, const SystemData &data, QString *error);
+    // False if the file is missing or not a complete Hello + Snapshot pair.
+    static bool load(const QString &path, SystemData *data, QDateTime *savedAt);
+};
+
+#endif // SNAPSHOTCACHE_H
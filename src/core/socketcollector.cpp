@@ -0,0 +1,405 @@
+#include "socketcollector.h"
+#include <QStringList>
+#include <QtEndian>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/tcp.h>
+#include <linux/unix_diag.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+// Kernel TCP_* states; UDP and unix sockets reuse them.
+constexpr quint8 kEstablished = 1;
+constexpr quint8 kClose = 7;
+
+const char *const kStateNames[] = {
+    "UNKNOWN", "ESTAB", "SYN-SENT", "SYN-RECV", "FIN-WAIT-1", "FIN-WAIT-2", "TIME-WAIT",
+    "CLOSE", "CLOSE-WAIT", "LAST-ACK", "LISTEN", "CLOSING", "NEW-SYN-RECV",
+};
+
+QString endpointText(const SocketData &socket, const quint8 *address, quint16 port)
+{
+    const int size = socket.ipv6 ? 16 : 4;
+    bool any = true;
+    for (int i = 0; i < size; ++i) any = any && address[i] == 0;
+    QString host;
+    if (any) {
+        host = "*";
+    } else if (socket.ipv6) {
+        QStringList groups;
+        for (int i = 0; i < 16; i += 2) groups << QString::number(address[i] << 8 | address[i + 1], 16);
+        host = "[" + groups.join(':') + "]";
+    } else {
+        host = QString("%1.%2.%3.%4").arg(address[0]).arg(address[1]).arg(address[2]).arg(address[3]);
+    }
+    return host + ":" + (port ? QString::number(port) : QString("*"));
+}
+
+}
+
+SocketCollector::SocketCollector(ProcFs *procFs)
+    : m_procFs(procFs)
+{
+    // Non-blocking: the kernel queues each dump part as the previous one is
+    // read, so an empty queue mid-dump means something went wrong.
+    m_netlinkFd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+}
+
+SocketCollector::~SocketCollector()
+{
+    if (m_netlinkFd >= 0) ::close(m_netlinkFd);
+}
+
+template <typename Handler>
+bool SocketCollector::dump(nlmsghdr *message, Handler handle)
+{
+    // The kernel runs one dump per socket at a time and refuses a new one
+    // (EBUSY) while the last is unread, so every dump is read to its end,
+    // even one that failed halfway. Replies to an earlier, abandoned request
+    // carry its sequence number and are skipped.
+    message->nlmsg_seq = ++m_sequence;
+    sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+    if (::sendto(m_netlinkFd, message, message->nlmsg_len, 0, reinterpret_cast<sockaddr *>(&kernel), sizeof(kernel))
+        != static_cast<ssize_t>(message->nlmsg_len)) return false;
+    bool complete = true;
+    for (;;) {
+        const ssize_t received = ::recv(m_netlinkFd, m_buffer, sizeof(m_buffer), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && errno == ENOBUFS) {
+            complete = false; // parts were dropped; read on to the end
+            continue;
+        }
+        if (received <= 0) return false; // nothing left queued
+        int remaining = static_cast<int>(received);
+        for (const nlmsghdr *header = reinterpret_cast<const nlmsghdr *>(m_buffer); NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_seq != m_sequence) continue;
+            if (header->nlmsg_type == NLMSG_DONE) return complete;
+            if (header->nlmsg_type == NLMSG_ERROR) return false; // final reply, e.g. udp_diag not loaded
+            if (complete) handle(header);
+        }
+    }
+}
+
+bool SocketCollector::dumpInet(int family, int protocol, QList<SocketData> *sockets)
+{
+    struct
+    {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message = {};
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request.sdiag_family = static_cast<quint8>(family);
+    message.request.sdiag_protocol = static_cast<quint8>(protocol);
+    message.request.idiag_states = ~0u;
+    if (protocol == IPPROTO_TCP) message.request.idiag_ext = 1 << (INET_DIAG_INFO - 1);
+
+    return dump(&message.header, [this, protocol, sockets](const nlmsghdr *header) {
+        if (header->nlmsg_len < NLMSG_LENGTH(sizeof(inet_diag_msg))) return;
+        const inet_diag_msg *diag = static_cast<const inet_diag_msg *>(NLMSG_DATA(header));
+        SocketData socket;
+        socket.protocol = protocol == IPPROTO_TCP ? SocketData::Tcp : SocketData::Udp;
+        socket.ipv6 = diag->idiag_family == AF_INET6;
+        socket.state = diag->idiag_state;
+        std::memcpy(socket.local, diag->id.idiag_src, sizeof(socket.local));
+        std::memcpy(socket.remote, diag->id.idiag_dst, sizeof(socket.remote));
+        socket.localPort = qFromBigEndian(diag->id.idiag_sport);
+        socket.remotePort = qFromBigEndian(diag->id.idiag_dport);
+        socket.inode = diag->idiag_inode;
+        socket.peerInode = 0;
+        socket.pid = 0;
+        socket.receiveQueue = diag->idiag_rqueue;
+        socket.sendQueue = diag->idiag_wqueue;
+        socket.rxKBps = socket.txKBps = 0.0;
+
+        int attributeLength = static_cast<int>(header->nlmsg_len - NLMSG_LENGTH(sizeof(inet_diag_msg)));
+        for (const rtattr *attribute = reinterpret_cast<const rtattr *>(diag + 1); RTA_OK(attribute, attributeLength);
+             attribute = RTA_NEXT(attribute, attributeLength)) {
+            if (attribute->rta_type != INET_DIAG_INFO || socket.inode == 0) continue;
+            // Older kernels send a shorter tcp_info without the byte counters.
+            const size_t payload = RTA_PAYLOAD(attribute);
+            if (payload < offsetof(tcp_info, tcpi_bytes_received) + sizeof(quint64)) continue;
+            tcp_info info = {};
+            std::memcpy(&info, RTA_DATA(attribute), std::min(payload, sizeof(info)));
+            m_traffic.insert(socket.inode, {info.tcpi_bytes_received, info.tcpi_bytes_acked});
+        }
+        sockets->append(socket);
+    });
+}
+
+bool SocketCollector::dumpUnix(QList<SocketData> *sockets)
+{
+    struct
+    {
+        nlmsghdr header;
+        unix_diag_req request;
+    } message = {};
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request.sdiag_family = AF_UNIX;
+    message.request.udiag_states = ~0u;
+    message.request.udiag_show = UDIAG_SHOW_NAME | UDIAG_SHOW_PEER | UDIAG_SHOW_RQLEN;
+
+    return dump(&message.header, [sockets](const nlmsghdr *header) {
+        if (header->nlmsg_len < NLMSG_LENGTH(sizeof(unix_diag_msg))) return;
+        const unix_diag_msg *diag = static_cast<const unix_diag_msg *>(NLMSG_DATA(header));
+        SocketData socket;
+        socket.protocol = SocketData::Unix;
+        socket.ipv6 = false;
+        socket.state = diag->udiag_state;
+        std::memset(socket.local, 0, sizeof(socket.local));
+        std::memset(socket.remote, 0, sizeof(socket.remote));
+        socket.localPort = socket.remotePort = 0;
+        socket.inode = diag->udiag_ino;
+        socket.peerInode = 0;
+        socket.pid = 0;
+        socket.receiveQueue = socket.sendQueue = 0;
+        socket.rxKBps = socket.txKBps = 0.0;
+
+        int attributeLength = static_cast<int>(header->nlmsg_len - NLMSG_LENGTH(sizeof(unix_diag_msg)));
+        for (const rtattr *attribute = reinterpret_cast<const rtattr *>(diag + 1); RTA_OK(attribute, attributeLength);
+             attribute = RTA_NEXT(attribute, attributeLength)) {
+            const char *data = static_cast<const char *>(RTA_DATA(attribute));
+            const int size = static_cast<int>(RTA_PAYLOAD(attribute));
+            if (attribute->rta_type == UNIX_DIAG_NAME && size > 0) {
+                // Abstract names start with a NUL; filesystem paths may carry one at the end.
+                if (data[0] == '\0') socket.path = "@" + QString::fromUtf8(data + 1, size - 1);
+                else socket.path = QString::fromUtf8(data, static_cast<int>(strnlen(data, size)));
+            } else if (attribute->rta_type == UNIX_DIAG_PEER && size >= 4) {
+                quint32 peer;
+                std::memcpy(&peer, data, sizeof(peer));
+                socket.peerInode = peer;
+            } else if (attribute->rta_type == UNIX_DIAG_RQLEN && size >= int(sizeof(unix_diag_rqlen))) {
+                unix_diag_rqlen queues;
+                std::memcpy(&queues, data, sizeof(queues));
+                socket.receiveQueue = queues.udiag_rqueue;
+                socket.sendQueue = queues.udiag_wqueue;
+            }
+        }
+        sockets->append(socket);
+    });
+}
+
+void SocketCollector::invalidate(int pid)
+{
+    m_invalidated.insert(pid);
+}
+
+void SocketCollector::setSignature(const struct stat &st, FdSignature *signature)
+{
+    signature->mtimeNs = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    signature->links = st.st_nlink;
+    signature->size = st.st_size;
+}
+
+bool SocketCollector::scanFds(int pid, FdTable *table)
+{
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d/fd", pid);
+    const int dirFd = ::openat(m_procFs->rootFd(ProcFs::Proc), path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) return false; // exited, or another user's process
+    struct stat st;
+    if (::fstat(dirFd, &st) == 0) setSignature(st, table);
+    table->inodes.resize(0);
+    ProcFs::listNumeric(dirFd, &m_fds);
+    char name[16];
+    char link[64];
+    for (int fd : m_fds) {
+        std::snprintf(name, sizeof(name), "%d", fd);
+        const ssize_t length = ::readlinkat(dirFd, name, link, sizeof(link));
+        if (length < 9 || std::memcmp(link, "socket:[", 8) != 0) continue;
+        const char *p = link + 8;
+        quint64 inode;
+        if (ProcParse::readU64(p, link + length, &inode)) table->inodes.append(inode);
+    }
+    ::close(dirFd);
+    return true;
+}
+
+void SocketCollector::addOwner(int pid, const FdTable &table)
+{
+    for (quint64 inode : table.inodes) {
+        // Shared sockets (forked workers) go to the lowest pid, usually the parent.
+        auto owner = m_owners.find(inode);
+        if (owner == m_owners.end()) m_owners.insert(inode, pid);
+        else if (*owner > pid) *owner = pid;
+        m_unresolved.remove(inode);
+    }
+}
+
+void SocketCollector::resolveOwners(const QVector<int> &pids, const QList<SocketData> &sockets)
+{
+    auto alive = [&pids](int pid) { return std::binary_search(pids.begin(), pids.end(), pid); };
+    const int procFd = m_procFs->rootFd(ProcFs::Proc);
+    char path[32];
+
+    // Forget exited and exec'd processes, and socket owners whose fd
+    // directory changed; their sockets are looked up again below.
+    bool ownersChanged = false;
+    for (auto it = m_fdTables.begin(); it != m_fdTables.end();) {
+        bool stale = m_invalidated.contains(it.key()) || !alive(it.key());
+        if (!stale && !it->inodes.isEmpty()) {
+            struct stat st;
+            std::snprintf(path, sizeof(path), "%d/fd", it.key());
+            FdSignature signature;
+            if (::fstatat(procFd, path, &st, 0) == 0) setSignature(st, &signature);
+            stale = signature != *it;
+        }
+        if (!stale) {
+            ++it;
+            continue;
+        }
+        ownersChanged = ownersChanged || !it->inodes.isEmpty();
+        it = m_fdTables.erase(it);
+    }
+    for (auto it = m_unreadable.begin(); it != m_unreadable.end();) {
+        if (m_invalidated.contains(*it) || !alive(*it)) it = m_unreadable.erase(it);
+        else ++it;
+    }
+    m_invalidated.clear();
+    if (ownersChanged) {
+        m_owners.clear();
+        for (auto it = m_fdTables.cbegin(); it != m_fdTables.cend(); ++it) addOwner(it.key(), *it);
+    }
+
+    // Orphans are kept only while their socket exists.
+    m_unresolved.clear();
+    QSet<quint64> orphans;
+    for (const SocketData &socket : sockets) {
+        if (socket.inode == 0 || m_owners.contains(socket.inode)) continue;
+        if (m_orphans.contains(socket.inode)) orphans.insert(socket.inode);
+        else m_unresolved.insert(socket.inode);
+    }
+    m_orphans.swap(orphans);
+    if (m_unresolved.isEmpty()) return;
+
+    // New sockets mostly belong to processes that already have some, so
+    // those are read again first; then the processes not read yet, mostly
+    // new ones. Before Linux 6.2 the fd directory reports no size, so an fd
+    // table there cannot be seen to change and is read again too.
+    m_scanned.clear();
+    bool lostSockets = false;
+    auto scan = [this, &lostSockets](int pid) {
+        m_scanned.insert(pid);
+        FdTable table;
+        const bool readable = scanFds(pid, &table);
+        auto previous = m_fdTables.find(pid);
+        if (previous != m_fdTables.end()) {
+            lostSockets = lostSockets || previous->inodes != table.inodes;
+            m_fdTables.erase(previous);
+        }
+        if (!readable) {
+            m_unreadable.insert(pid);
+            return;
+        }
+        addOwner(pid, table);
+        m_fdTables.insert(pid, table);
+    };
+    m_candidates.resize(0);
+    for (auto it = m_fdTables.cbegin(); it != m_fdTables.cend(); ++it) {
+        if (!it->inodes.isEmpty()) m_candidates.append(it.key());
+    }
+    for (int pid : std::as_const(m_candidates)) {
+        if (m_unresolved.isEmpty()) break;
+        scan(pid);
+    }
+    for (int pid : pids) {
+        if (m_unresolved.isEmpty()) break;
+        if (m_scanned.contains(pid) || m_unreadable.contains(pid)) continue;
+        auto table = m_fdTables.constFind(pid);
+        if (table != m_fdTables.cend() && table->size > 0) continue;
+        scan(pid);
+    }
+    // A socket that moved out of a table read again may belong elsewhere now.
+    if (lostSockets) {
+        m_owners.clear();
+        for (auto it = m_fdTables.cbegin(); it != m_fdTables.cend(); ++it) addOwner(it.key(), *it);
+    }
+    // Held only by processes we cannot read; not searched for again.
+    m_orphans.unite(m_unresolved);
+}
+
+void SocketCollector::collect(qint64 nowMs, const QVector<int> &pids, QList<SocketData> *sockets, QList<ProcessData> *processes)
+{
+    sockets->clear();
+    m_traffic.clear();
+    dumpInet(AF_INET, IPPROTO_TCP, sockets);
+    dumpInet(AF_INET6, IPPROTO_TCP, sockets);
+    dumpInet(AF_INET, IPPROTO_UDP, sockets);
+    dumpInet(AF_INET6, IPPROTO_UDP, sockets);
+    dumpUnix(sockets);
+    resolveOwners(pids, *sockets);
+
+    for (ProcessData &process : *processes) {
+        process.sockets = process.connections = 0;
+        process.netRxKBps = process.netTxKBps = 0.0;
+    }
+    const double elapsedSeconds = m_previousMs > 0 ? (nowMs - m_previousMs) / 1000.0 : 0.0;
+    for (SocketData &socket : *sockets) {
+        if (socket.inode == 0) continue;
+        if (socket.protocol == SocketData::Tcp && elapsedSeconds > 0) {
+            auto current = m_traffic.constFind(socket.inode);
+            auto previous = m_previousTraffic.constFind(socket.inode);
+            if (current != m_traffic.constEnd() && previous != m_previousTraffic.constEnd()) {
+                if (current->received >= previous->received) socket.rxKBps = (current->received - previous->received) / 1024.0 / elapsedSeconds;
+                if (current->acked >= previous->acked) socket.txKBps = (current->acked - previous->acked) / 1024.0 / elapsedSeconds;
+            }
+        }
+        socket.pid = m_owners.value(socket.inode, 0);
+        if (socket.pid == 0) continue;
+        auto process = std::lower_bound(processes->begin(), processes->end(), socket.pid,
+                                        [](const ProcessData &data, int pid) { return data.pid < pid; });
+        if (process == processes->end() || process->pid != socket.pid) continue;
+        ++process->sockets;
+        if (socket.protocol != SocketData::Unix && socket.state == kEstablished) ++process->connections;
+        process->netRxKBps += socket.rxKBps;
+        process->netTxKBps += socket.txKBps;
+    }
+    m_previousTraffic.swap(m_traffic);
+    m_previousMs = nowMs;
+}
+
+const char *SocketCollector::protocolName(const SocketData &socket)
+{
+    switch (socket.protocol) {
+    case SocketData::Tcp: return socket.ipv6 ? "tcp6" : "tcp";
+    case SocketData::Udp: return socket.ipv6 ? "udp6" : "udp";
+    case SocketData::Unix: return "unix";
+    }
+    return "?";
+}
+
+const char *SocketCollector::stateName(const SocketData &socket)
+{
+    if (socket.protocol != SocketData::Tcp && socket.state == kClose) return "UNCONN";
+    return socket.state < sizeof(kStateNames) / sizeof(kStateNames[0]) ? kStateNames[socket.state] : kStateNames[0];
+}
+
+QString SocketCollector::localText(const SocketData &socket)
+{
+    if (socket.protocol == SocketData::Unix) return socket.path.isEmpty() ? QString("*") : socket.path;
+    return endpointText(socket, socket.local, socket.localPort);
+}
+
+QString SocketCollector::remoteText(const SocketData &socket)
+{
+    if (socket.protocol == SocketData::Unix) return socket.peerInode ? QString("peer %1").arg(socket.peerInode) : QString("*");
+    return endpointText(socket, socket.remote, socket.remotePort);
+}
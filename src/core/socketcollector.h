@@ -0,0 +1,102 @@
+#ifndef SOCKETCOLLECTOR_H
+#define SOCKETCOLLECTOR_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include "../common/systemdata.h"
+#include "procfs.h"
+
+struct nlmsghdr;
+struct stat;
+
+// Every TCP, UDP and unix socket of the monitor's network namespace, dumped
+// through NETLINK_SOCK_DIAG on one held netlink socket (no /proc/net text to
+// parse), with TCP byte counters from tcp_info for per-socket throughput.
+//
+// Owners are found by walking <pid>/fd, which is expensive, so each
+// process's socket inodes are kept across ticks. A process's set is dropped
+// when it exits or execs (invalidate()), or when it owns sockets and the
+// mtime, link count or size (the fd count, since Linux 6.2) of its fd
+// directory changes. Only sockets with unknown inodes start a search:
+// processes that already own sockets are read again first, since that is
+// where accept() and connect() happen, then processes not read yet. Inodes
+// no readable process holds are not searched for again, and processes
+// whose fd directory we cannot read are skipped until they exec. Live only.
+class SocketCollector
+{
+public:
+    enum { BufferSize = 32 * 1024 };
+
+    explicit SocketCollector(ProcFs *procFs);
+    ~SocketCollector();
+    SocketCollector(const SocketCollector &) = delete;
+    SocketCollector &operator=(const SocketCollector &) = delete;
+
+    bool isAvailable() const { return m_netlinkFd >= 0; }
+    // `pids` ascending, as listed this tick. Adds per-process totals to
+    // `processes` (ascending pid).
+    void collect(qint64 nowMs, const QVector<int> &pids, QList<SocketData> *sockets, QList<ProcessData> *processes);
+    // `pid` exec'd or exited: its fds are read again when needed.
+    void invalidate(int pid);
+
+    static const char *protocolName(const SocketData &socket);
+    static const char *stateName(const SocketData &socket);
+    // "10.0.0.1:443", "[::1]:22", "*:53", or the unix path.
+    static QString localText(const SocketData &socket);
+    static QString remoteText(const SocketData &socket);
+
+private:
+    struct Traffic
+    {
+        quint64 received;
+        quint64 acked;
+    };
+    struct FdSignature
+    {
+        qint64 mtimeNs = 0;
+        quint64 links = 0;
+        qint64 size = 0; // open fds since Linux 6.2, 0 before
+        bool operator!=(const FdSignature &other) const
+        {
+            return mtimeNs != other.mtimeNs || links != other.links || size != other.size;
+        }
+    };
+    struct FdTable : FdSignature
+    {
+        QVector<quint64> inodes; // sockets among the fds
+    };
+
+    bool dumpInet(int family, int protocol, QList<SocketData> *sockets);
+    bool dumpUnix(QList<SocketData> *sockets);
+    // Sends a dump request and feeds every reply message to `handle`; false
+    // if the dump failed or came back incomplete.
+    template <typename Handler>
+    bool dump(nlmsghdr *message, Handler handle);
+    void resolveOwners(const QVector<int> &pids, const QList<SocketData> &sockets);
+    // False if the fd directory cannot be read.
+    bool scanFds(int pid, FdTable *table);
+    void addOwner(int pid, const FdTable &table);
+    static void setSignature(const struct stat &st, FdSignature *signature);
+
+    ProcFs *m_procFs;
+    int m_netlinkFd = -1;
+    quint32 m_sequence = 0;
+    alignas(8) char m_buffer[BufferSize];
+    QHash<int, FdTable> m_fdTables;
+    QHash<quint64, int> m_owners; // socket inode -> pid
+    QSet<quint64> m_unresolved;
+    QSet<quint64> m_orphans;      // held by no process we can read
+    QSet<int> m_unreadable;       // fd directory not readable
+    QSet<int> m_invalidated;
+    QSet<int> m_scanned;
+    QVector<int> m_fds;
+    QHash<quint64, Traffic> m_traffic; // by inode, TCP only
+    QHash<quint64, Traffic> m_previousTraffic;
+    qint64 m_previousMs = 0;
+    QVector<int> m_candidates;
+};
+
+#endif // SOCKETCOLLECTOR_H
@@ -1,13 +1,155 @@
 #include "systemmonitor.h"
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <string>
-#include <sys/statvfs.h>
+#include "selfprofiler.h"
 #include <QDebug>
-#include <QDir>
+#include <QSet>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
 
-SystemMonitor::SystemMonitor(QObject *parent) : QObject(parent) {}
+namespace {
+
+constexpr int kPollIntervalMs = 2000;
+// With the proc connector, new and exited processes arrive as events, so the
+// full scan only has to keep memory and rates current.
+constexpr int kEventDrivenPollIntervalMs = 5000;
+// Bursts of events cause at most one extra tick per this interval.
+constexpr int kMinEventPollGapMs = 500;
+constexpr int kProcessEventCoalesceMs = 250;
+// Gap between the counter-only priming read and the first full tick: long
+// enough for CPU% to mean something, short enough to feel instant.
+constexpr int kPrimingDelayMs = 100;
+constexpr qint64 kPressureAlertCooldownMs = 30000;
+constexpr qint64 kSensorAlertCooldownMs = 60000;
+// Thermal alerts quote CPU load and clocks over this window.
+constexpr qint64 kCpuHistoryMs = 60000;
+// Degrees below a sensor's critical (or max) limit that count as overheating.
+constexpr double kOverheatMarginC = 5.0;
+// Longer command lines are cut; the table and the copilot need the start.
+constexpr int kMaxCommandLineBytes = 4096;
+
+quint64 counterDelta(quint64 current, quint64 previous)
+{
+    return current >= previous ? current - previous : 0; // wrapped or reset
+}
+
+double clockTicksPerSecond()
+{
+    static const double ticks = static_cast<double>(sysconf(_SC_CLK_TCK));
+    return ticks;
+}
+
+// Devices rarely come and go, so the same index last time is almost always
+// the same device.
+template <typename Counters>
+const Counters *findCounters(const QVector<Counters> &previous, int index, const Counters &current)
+{
+    auto sameName = [&current](const Counters &other) {
+        return other.nameLength == current.nameLength && std::memcmp(other.name, current.name, current.nameLength) == 0;
+    };
+    if (index < previous.size() && sameName(previous[index])) return &previous[index];
+    for (const Counters &other : previous) {
+        if (sameName(other)) return &other;
+    }
+    return nullptr;
+}
+
+// Shares last tick's QString when the name at this position is unchanged.
+template <typename Data>
+QString sharedName(const QList<Data> &previous, int index, const char *name, int length)
+{
+    if (index < previous.size() && previous[index].name == QLatin1String(name, length)) return previous[index].name;
+    return QString::fromUtf8(name, length);
+}
+
+// Network filesystems are left out: statvfs() on one whose server is gone
+// blocks the monitor thread until the mount times out, if it ever does.
+bool isNetworkFilesystem(QLatin1String type)
+{
+    static const char *const types[] = {"nfs", "nfs4", "cifs", "smb3", "smbfs", "ceph", "glusterfs", "9p", "afs", "fuse.sshfs"};
+    for (const char *network : types) {
+        if (type == QLatin1String(network)) return true;
+    }
+    return false;
+}
+
+bool isRealFilesystem(const char *fsType, int fsTypeLength, const char *source, int sourceLength)
+{
+    const QLatin1String type(fsType, fsTypeLength);
+    if (type == QLatin1String("squashfs")) return false; // read-only images, always full
+    if (isNetworkFilesystem(type)) return false; // cifs sources look like paths ("//server/share")
+    if (sourceLength > 0 && source[0] == '/') return true;
+    return type == QLatin1String("zfs");
+}
+
+// mountinfo escapes space, tab, newline and backslash as \ooo.
+QByteArray unescapeMountField(const char *text, int length)
+{
+    QByteArray out;
+    out.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        const char *digits = text + i + 1;
+        if (text[i] == '\\' && i + 3 < length && digits[0] >= '0' && digits[0] <= '3'
+            && digits[1] >= '0' && digits[1] <= '7' && digits[2] >= '0' && digits[2] <= '7') {
+            out.append(static_cast<char>((digits[0] - '0') * 64 + (digits[1] - '0') * 8 + (digits[2] - '0')));
+            i += 3;
+            continue;
+        }
+        out.append(text[i]);
+    }
+    return out;
+}
+
+}
+
+SystemMonitor::SystemMonitor(QObject *parent) : QObject(parent)
+{
+    m_ruleEngine.setProcFs(&m_procFs);
+}
+
+SystemMonitor::SystemMonitor(const QString &procRoot, const QString &sysRoot, QObject *parent)
+    : QObject(parent),
+      m_procFs(procRoot, sysRoot),
+      m_detailCache(5000, procRoot)
+{
+    m_ruleEngine.setProcFs(&m_procFs);
+}
+
+SystemData SystemMonitor::getSystemData() const
+{
+    return m_data;
+}
+
+bool SystemMonitor::startRecording(const QString &path, QString *error)
+{
+    if (!m_capture.open(path, error)) return false;
+    m_procFs.setCapture(&m_capture);
+    return true;
+}
+
+bool SystemMonitor::startReplay(const QString &path, ReplaySpeed speed, QString *error)
+{
+    if (!m_replay.open(path, error)) return false;
+    m_replaySpeed = speed;
+    m_procFs.setReplay(&m_replay);
+    return true;
+}
+
+bool SystemMonitor::applyCaptureOptions(const CaptureOptions &options, QString *error)
+{
+    // A replayed frame is served from the capture, not read, so there would
+    // be nothing to record.
+    if (!options.replayPath.isEmpty() && !options.recordPath.isEmpty()) {
+        *error = "--record and --replay cannot be combined.";
+        return false;
+    }
+    if (!options.replayPath.isEmpty() && !startReplay(options.replayPath, options.replaySpeed, error)) return false;
+    if (!options.recordPath.isEmpty() && !startRecording(options.recordPath, error)) {
+        m_procFs.setReplay(nullptr);
+        return false;
+    }
+    return true;
+}
 
 void SystemMonitor::startMonitoring()
 {
@@ -17,137 +159,713 @@ void SystemMonitor::startMonitoring()
     readStaticData();
     emit staticDataReady(m_data);
 
+    QStringList ruleErrors;
+    const QString rulesPath = AlertRuleEngine::defaultRulesPath();
+    if (!m_ruleEngine.loadFile(rulesPath, &ruleErrors)) {
+        QList<MonitorAlert> errorAlerts;
+        for (const QString &error : ruleErrors) {
+            qWarning() << rulesPath << error;
+            MonitorAlert alert;
+            alert.source = MonitorAlert::Rule;
+            alert.timestampMs = QDateTime::currentMSecsSinceEpoch();
+            alert.message = QString("%1: %2").arg(rulesPath, error);
+            errorAlerts.append(alert);
+        }
+        emit alertsRaised(errorAlerts);
+    }
+
+    // A replay paces itself frame by frame from the recorded timestamps.
+    m_timer->setSingleShot(m_procFs.isReplaying());
+    if (m_procFs.isReplaying()) {
+        pollDynamicData();
+        return;
+    }
+    startEventSources();
+    // Otherwise the first sample would report 0% CPU and no I/O. A recording
+    // starts with a full tick instead, so every captured frame replays as one.
+    if (m_procFs.isRecording()) {
+        pollDynamicData();
+    } else {
+        primeCounters();
+        // Through pollSoon(), so it is dropped if an event already ran a tick.
+        QTimer::singleShot(kPrimingDelayMs, this, &SystemMonitor::pollSoon);
+    }
+    m_timer->start(m_events && m_events->hasProcessEvents() ? kEventDrivenPollIntervalMs : kPollIntervalMs);
+}
+
+void SystemMonitor::primeCounters()
+{
+    PROFILE_SCOPE("monitor.prime");
+    if (!m_procFs.beginFrame()) return;
+    readCpuUsage();
+    readNetworkUsage();
+    readDiskStats();
+    m_procFs.endFrame();
+}
+
+// Live only: events describe this host, not a recording.
+void SystemMonitor::startEventSources()
+{
+    m_events = new EventSources(this);
+    const int pressureTriggers = m_events->armPressureTriggers(m_procFs.rootFd(ProcFs::Proc));
+    // Patched processes are read between frames, which a recording does not
+    // keep; recordings stay on full scans. The connector reports this host's
+    // pids, which mean nothing under a synthetic proc root.
+    const bool processEvents = m_procFs.isLive() && !m_procFs.isRecording() && m_events->subscribeProcessEvents();
+    if (pressureTriggers == 0 && !processEvents) {
+        delete m_events;
+        m_events = nullptr;
+        return;
+    }
+    connect(m_events, &EventSources::pressureStall, this, &SystemMonitor::onPressureStall);
+    connect(m_events, &EventSources::processesChanged, this, &SystemMonitor::onProcessesChanged);
+    connect(m_events, &EventSources::processEventsLost, this, &SystemMonitor::pollSoon);
+    m_processEventTimer = new QTimer(this);
+    m_processEventTimer->setSingleShot(true);
+    m_processEventTimer->setInterval(kProcessEventCoalesceMs);
+    connect(m_processEventTimer, &QTimer::timeout, this, &SystemMonitor::applyProcessEvents);
+}
+
+void SystemMonitor::pollSoon()
+{
+    if (m_sinceLastPoll.isValid() && m_sinceLastPoll.elapsed() < kMinEventPollGapMs) return;
     pollDynamicData();
-    m_timer->start(2000); // Update every 2 seconds for process list
+    m_timer->start(); // the regular cadence restarts from this tick
+}
+
+void SystemMonitor::onPressureStall(EventSources::Resource resource)
+{
+    pollSoon();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (now - m_lastPressureAlertMs[resource] < kPressureAlertCooldownMs) return;
+    m_lastPressureAlertMs[resource] = now;
+    MonitorAlert alert;
+    alert.source = MonitorAlert::Pressure;
+    alert.timestampMs = now;
+    alert.series = "pressure." + EventSources::resourceName(resource);
+    alert.message = QString("%1 pressure stall: %2").arg(EventSources::resourceName(resource), EventSources::triggerDescription(resource));
+    emit alertsRaised({alert});
+}
+
+void SystemMonitor::onProcessesChanged(const QVector<int> &changed, const QVector<int> &exited)
+{
+    for (int pid : changed) {
+        m_changedPids.insert(pid);
+        m_sockets.invalidate(pid);
+    }
+    for (int pid : exited) {
+        m_changedPids.remove(pid);
+        m_exitedPids.insert(pid);
+        m_sockets.invalidate(pid);
+    }
+    if (!m_processEventTimer->isActive()) m_processEventTimer->start();
+}
+
+// Patches the last process list with just the pids the connector reported,
+// between full scans.
+void SystemMonitor::applyProcessEvents()
+{
+    PROFILE_SCOPE("monitor.processEvents");
+    if (!m_sinceLastPoll.isValid()) {
+        // Before the first full tick there is no list to patch; that tick reads these too.
+        m_changedPids.clear();
+        m_exitedPids.clear();
+        return;
+    }
+    QList<ProcessData> &processes = m_data.processes;
+    auto position = [&processes](int pid) {
+        return static_cast<int>(std::lower_bound(processes.begin(), processes.end(), pid,
+                                                 [](const ProcessData &process, int value) { return process.pid < value; })
+                                - processes.begin());
+    };
+    for (int pid : m_exitedPids) {
+        const int index = position(pid);
+        if (index < processes.size() && processes[index].pid == pid) processes.removeAt(index);
+        m_data.ranking.remove(pid);
+    }
+    for (int pid : m_changedPids) {
+        const int index = position(pid);
+        const bool known = index < processes.size() && processes[index].pid == pid;
+        ProcessData process;
+        if (!readProcess(pid, known ? &processes[index] : nullptr, 0.0, true, &process)) continue;
+        if (known) processes[index] = process;
+        else processes.insert(index, process);
+        m_data.ranking.update(process);
+    }
+    if (m_data.ranking.needsRebuild()) m_data.ranking.rebuild(processes);
+    m_changedPids.clear();
+    m_exitedPids.clear();
+    m_data.sampledAtNs = SelfProfiler::now();
+    m_bus.publish(m_data);
 }
 
 void SystemMonitor::pollDynamicData()
 {
-    readDynamicData();
-    emit dynamicDataUpdated(m_data);
+    m_sinceLastPoll.start();
+    if (!readDynamicData()) {
+        m_timer->stop();
+        emit replayFinished();
+        return;
+    }
+    m_bus.publish(m_data);
+
+    const qint64 now = m_procFs.nowMs();
+    QList<MonitorAlert> alerts;
+    {
+        PROFILE_SCOPE("monitor.anomaly");
+        alerts = m_anomalyDetector.process(m_data, now);
+    }
+    {
+        PROFILE_SCOPE("monitor.rules");
+        alerts += m_ruleEngine.evaluate(m_data, now);
+    }
+    alerts += checkSensors(now);
+    if (!alerts.isEmpty()) emit alertsRaised(alerts);
+
+    if (m_procFs.isReplaying()) {
+        const qint64 next = m_replay.nextTimestampMs();
+        const bool immediate = m_replaySpeed == MaximumSpeed || next < 0;
+        m_timer->start(immediate ? 0 : static_cast<int>(qBound<qint64>(0, next - now, 60000)));
+    }
 }
 
 void SystemMonitor::readStaticData()
 {
-    std::string temp_str;
-    std::ifstream hostFile("/proc/sys/kernel/hostname");
-    if(hostFile.is_open()) { std::getline(hostFile, temp_str); m_data.hostname = QString::fromStdString(temp_str); }
-    hostFile.close();
+    PROFILE_SCOPE("collector.static");
+    if (!m_procFs.beginFrame()) return;
+    auto firstLine = [](const ProcText &text) {
+        const char *p = text.begin;
+        while (p < text.end && *p != '\n') ++p;
+        return QString::fromUtf8(text.begin, static_cast<int>(p - text.begin));
+    };
+    ProcText text = m_procFs.read(ProcFs::Proc, "sys/kernel/hostname");
+    if (!text.isNull()) m_data.hostname = firstLine(text);
+    text = m_procFs.read(ProcFs::Proc, "version");
+    if (!text.isNull()) m_data.kernelVersion = firstLine(text);
 
-    std::ifstream kernelFile("/proc/version");
-    if(kernelFile.is_open()) { std::getline(kernelFile, temp_str); m_data.kernelVersion = QString::fromStdString(temp_str); }
-    kernelFile.close();
-
-    std::ifstream cpuFile("/proc/cpuinfo");
-    std::string line;
-    while (std::getline(cpuFile, line)) {
-        if (line.find("model name") != std::string::npos) {
-            m_data.cpuModel = QString::fromStdString(line.substr(line.find(":") + 2));
-            break;
+    // One block per logical CPU; physical cores are the distinct
+    // (physical id, core id) pairs, where the architecture reports them.
+    text = m_procFs.read(ProcFs::Proc, "cpuinfo");
+    auto value = [](const char *&p, const char *end) {
+        while (p < end && *p != ':' && *p != '\n') ++p;
+        if (p < end && *p == ':') ++p;
+        ProcParse::skipSpaces(p, end);
+    };
+    QString cpuModel;
+    QSet<quint64> cores;
+    quint64 physicalId = 0, coreId = 0;
+    int logicalCpus = 0;
+    for (const char *p = text.begin; p && p < text.end;) {
+        if (ProcParse::consume(p, text.end, "processor")) {
+            ++logicalCpus;
+            physicalId = 0;
+        } else if (ProcParse::consume(p, text.end, "physical id")) {
+            value(p, text.end);
+            ProcParse::readU64(p, text.end, &physicalId);
+        } else if (ProcParse::consume(p, text.end, "core id")) {
+            value(p, text.end);
+            ProcParse::readU64(p, text.end, &coreId);
+            cores.insert(physicalId << 32 | coreId);
+        } else if (cpuModel.isEmpty() && ProcParse::consume(p, text.end, "model name")) {
+            value(p, text.end);
+            ProcText rest{p, text.end};
+            cpuModel = firstLine(rest);
         }
+        if (!ProcParse::nextLine(p, text.end)) break;
+    }
+    if (!cpuModel.isEmpty()) m_data.cpuModel = cpuModel;
+    m_data.logicalCpus = logicalCpus;
+    m_data.physicalCores = cores.isEmpty() ? logicalCpus : static_cast<int>(cores.size());
+    m_procFs.endFrame();
+
+    if (!m_procFs.isReplaying()) {
+        m_sensors.discover();
+        m_data.cpuMaxMHz = m_sensors.maxFrequencyMHz();
     }
-    cpuFile.close();
 }
 
-void SystemMonitor::readDynamicData()
+bool SystemMonitor::readDynamicData()
 {
+    PROFILE_SCOPE("monitor.tick");
+    if (!m_procFs.beginFrame()) return false;
     m_data.cpuPercentage = readCpuUsage();
     m_data.memPercentage = readMemoryUsage();
-    m_data.diskPercentage = readDiskUsage("/");
     readNetworkUsage();
+    readDiskStats();
+    readMounts();
     readProcessList();
+    readSockets();
+    readCgroups();
+    readSensors();
+    m_procFs.endFrame();
+    if (!m_procFs.isReplaying()) {
+        PROFILE_SCOPE("collector.details");
+        m_detailCache.refreshWanted();
+    }
+    m_data.sampledAtNs = SelfProfiler::now();
+    return true;
 }
 
 void SystemMonitor::readProcessList()
 {
-    m_data.processes.clear();
-    QDir procDir("/proc");
-    QStringList entries = procDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    PROFILE_SCOPE("collector.processes");
+    m_procFs.listPids(&m_pids);
+    m_userNames.refresh();
+    const qint64 now = m_procFs.nowMs();
+    const double elapsedSeconds = m_previousProcessScanMs > 0 ? (now - m_previousProcessScanMs) / 1000.0 : 0.0;
+    m_previousProcessScanMs = now;
 
-    for(const QString &pidStr : entries) {
-        bool isNumber;
-        int pid = pidStr.toInt(&isNumber);
-        if (!isNumber) continue;
+    // Pids come back sorted, as does the previous list, so names of processes
+    // seen last tick are shared instead of decoded again.
+    const QList<ProcessData> &previous = m_data.processes;
+    int previousIndex = 0;
+    QList<ProcessData> processes;
+    processes.reserve(m_pids.size());
 
+    for (int pid : m_pids) {
+        while (previousIndex < previous.size() && previous[previousIndex].pid < pid) ++previousIndex;
+        const bool known = previousIndex < previous.size() && previous[previousIndex].pid == pid;
         ProcessData p_data;
-        p_data.pid = pid;
-
-        std::ifstream statusFile(QString("/proc/%1/status").arg(pid).toStdString());
-        if(!statusFile.is_open()) continue;
-
-        std::string line;
-        long vmrss = 0;
-        while(std::getline(statusFile, line)) {
-            std::stringstream ss(line);
-            std::string key;
-            ss >> key;
-            if (key == "Name:") {
-                std::string name;
-                ss >> name;
-                p_data.name = QString::fromStdString(name);
-            } else if (key == "VmRSS:") {
-                ss >> vmrss;
-                break; // VmRSS is usually after Name
-            }
+        if (readProcess(pid, known ? &previous[previousIndex] : nullptr, elapsedSeconds, false, &p_data)) processes.append(p_data);
+    }
+    m_data.processes = processes;
+    m_data.ranking.rebuild(m_data.processes);
+    pruneCommandLines();
+}
+
+bool SystemMonitor::readProcess(int pid, const ProcessData *previous, double elapsedSeconds, bool execed, ProcessData *process)
+{
+    const ProcText status = m_procFs.readPid(pid, "status");
+    if (status.isNull()) return false;
+
+    // Name, State and Uid come first and Threads near the end; kernel
+    // threads have no VmRSS.
+    const char *name = nullptr;
+    int nameLength = 0;
+    char state = '?';
+    quint64 uid = 0, vmrss = 0, threads = 0;
+    for (const char *p = status.begin; p < status.end;) {
+        if (ProcParse::consume(p, status.end, "Name:")) {
+            ProcParse::skipSpaces(p, status.end);
+            name = p;
+            while (p < status.end && *p != '\n') ++p;
+            nameLength = static_cast<int>(p - name);
+        } else if (ProcParse::consume(p, status.end, "State:")) {
+            ProcParse::skipSpaces(p, status.end);
+            if (p < status.end) state = *p;
+        } else if (ProcParse::consume(p, status.end, "Uid:")) {
+            ProcParse::readU64(p, status.end, &uid);
+        } else if (ProcParse::consume(p, status.end, "VmRSS:")) {
+            ProcParse::readU64(p, status.end, &vmrss);
+        } else if (ProcParse::consume(p, status.end, "Threads:")) {
+            ProcParse::readU64(p, status.end, &threads);
+            break;
         }
-        statusFile.close();
+        if (!ProcParse::nextLine(p, status.end)) break;
+    }
+
+    process->pid = pid;
+    const bool sameName = previous && previous->name == QLatin1String(name, nameLength);
+    if (sameName) process->name = previous->name;
+    else process->name = QString::fromUtf8(name, nameLength);
+    process->memUsageMB = vmrss / 1024.0;
+    process->uid = static_cast<uint>(uid);
+    process->user = m_userNames.name(process->uid);
+    process->state = state;
+    process->threads = static_cast<int>(threads);
 
-        p_data.memUsageMB = vmrss / 1024.0;
-        m_data.processes.append(p_data);
+    // The start time tells a reused pid from the process seen last tick.
+    ProcParse::PidStat stat;
+    const ProcText statText = m_procFs.readPid(pid, "stat");
+    const bool haveStat = !statText.isNull() && ProcParse::parsePidStat(statText, &stat);
+    process->startTime = haveStat ? stat.startTime : 0;
+    const bool sameProcess = previous && haveStat && previous->startTime == stat.startTime;
+    // Read once per process: again for a new process on a reused pid, or
+    // after an exec, which keeps both pid and start time.
+    process->commandLine = sameProcess && !execed ? previous->commandLine : readCommandLine(pid, process->name);
+
+    // Between full scans a known process keeps its counters, so the next
+    // scan's rate spans the whole interval.
+    if (sameProcess && elapsedSeconds <= 0) {
+        process->cpuTicks = previous->cpuTicks;
+        process->cpuPercentage = previous->cpuPercentage;
+        process->sockets = previous->sockets;
+        process->connections = previous->connections;
+        process->netRxKBps = previous->netRxKBps;
+        process->netTxKBps = previous->netTxKBps;
+        return true;
     }
+    process->cpuTicks = haveStat ? stat.utime + stat.stime : 0;
+    process->cpuPercentage = sameProcess && elapsedSeconds > 0
+        ? 100.0 * counterDelta(process->cpuTicks, previous->cpuTicks) / clockTicksPerSecond() / elapsedSeconds
+        : 0.0;
+    return true;
+}
+
+QString SystemMonitor::readCommandLine(int pid, const QString &name)
+{
+    const ProcText text = m_procFs.readPid(pid, "cmdline");
+    int length = text.isNull() ? 0 : qMin(text.size(), kMaxCommandLineBytes);
+    while (length > 0 && text.begin[length - 1] == '\0') --length;
+    if (length == 0) return "[" + name + "]";
+
+    m_commandLineBuffer.resize(length);
+    char *out = m_commandLineBuffer.data();
+    for (int i = 0; i < length; ++i) out[i] = text.begin[i] == '\0' ? ' ' : text.begin[i];
+    const QString commandLine = QString::fromUtf8(m_commandLineBuffer);
+    auto it = m_commandLines.constFind(commandLine);
+    if (it != m_commandLines.constEnd()) return *it;
+    m_commandLines.insert(commandLine);
+    return commandLine;
+}
+
+// Rebuilt from the live processes once dead entries outnumber them, so the
+// set stays proportional to what is running.
+void SystemMonitor::pruneCommandLines()
+{
+    if (m_commandLines.size() <= 2 * m_data.processes.size() + 256) return;
+    QSet<QString> live;
+    live.reserve(m_data.processes.size());
+    for (const ProcessData &process : m_data.processes) live.insert(process.commandLine);
+    m_commandLines.swap(live);
 }
 
 void SystemMonitor::readNetworkUsage()
 {
-    std::ifstream file("/proc/net/dev");
-    if (!file.is_open()) return;
-
-    long long totalBytesReceived = 0;
-    long long totalBytesSent = 0;
-    std::string line;
-    std::getline(file, line); std::getline(file, line);
-
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string ifaceName;
-        ss >> ifaceName;
-        if (ifaceName.find("lo:") != std::string::npos) continue;
-
-        long long recv, sent;
-        ss >> recv; for(int i=0; i<7; ++i) ss >> sent; ss >> sent;
-        totalBytesReceived += recv;
-        totalBytesSent += sent;
-    }
-    file.close();
-
-    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    if (m_previousTimestamp > 0) {
-        double timeElapsedSeconds = (currentTime - m_previousTimestamp) / 1000.0;
-        if (timeElapsedSeconds > 0) {
-            m_data.netDownSpeed_KBps = (totalBytesReceived - m_previousNetBytesReceived) / timeElapsedSeconds / 1024.0;
-            m_data.netUpSpeed_KBps = (totalBytesSent - m_previousNetBytesSent) / timeElapsedSeconds / 1024.0;
+    PROFILE_SCOPE("collector.network");
+    const ProcText text = m_procFs.read(ProcFs::Proc, "net/dev");
+    if (text.isNull()) return;
+
+    std::swap(m_netCounters, m_previousNetCounters);
+    m_netCounters.clear();
+    const char *p = text.begin;
+    ProcParse::nextLine(p, text.end);
+    ProcParse::nextLine(p, text.end);
+
+    while (p < text.end) {
+        // "  eth0: rx_bytes rx_packets rx_errs rx_drop fifo frame compressed multicast tx_bytes tx_packets tx_errs tx_drop ...";
+        // counters may be glued to the colon.
+        ProcParse::skipSpaces(p, text.end);
+        const char *ifaceName = p;
+        while (p < text.end && *p != ':' && *p != '\n') ++p;
+        if (p < text.end && *p == ':') {
+            NetCounters counters;
+            counters.nameLength = qMin(static_cast<int>(p - ifaceName), static_cast<int>(sizeof(counters.name)));
+            std::memcpy(counters.name, ifaceName, counters.nameLength);
+            ++p;
+            quint64 fields[12] = {};
+            for (quint64 &field : fields) ProcParse::readU64(p, text.end, &field);
+            std::copy(fields, fields + 4, counters.values);
+            std::copy(fields + 8, fields + 12, counters.values + 4);
+            m_netCounters.append(counters);
+        }
+        if (!ProcParse::nextLine(p, text.end)) break;
+    }
+
+    const qint64 currentTime = m_procFs.nowMs();
+    const double elapsedSeconds = m_previousNetTimestamp > 0 ? (currentTime - m_previousNetTimestamp) / 1000.0 : 0.0;
+    m_previousNetTimestamp = currentTime;
+
+    QList<NetworkInterfaceData> interfaces;
+    interfaces.reserve(m_netCounters.size());
+    double totalDownKBps = 0.0, totalUpKBps = 0.0;
+    for (int i = 0; i < m_netCounters.size(); ++i) {
+        const NetCounters &current = m_netCounters[i];
+        const NetCounters *previous = findCounters(m_previousNetCounters, i, current);
+        NetworkInterfaceData iface;
+        iface.name = sharedName(m_data.interfaces, i, current.name, current.nameLength);
+        iface.rxBytes = current.values[0];
+        iface.rxPackets = current.values[1];
+        iface.rxErrors = current.values[2];
+        iface.rxDrops = current.values[3];
+        iface.txBytes = current.values[4];
+        iface.txPackets = current.values[5];
+        iface.txErrors = current.values[6];
+        iface.txDrops = current.values[7];
+        iface.rxKBps = iface.txKBps = 0.0;
+        if (previous && elapsedSeconds > 0) {
+            iface.rxKBps = counterDelta(current.values[0], previous->values[0]) / elapsedSeconds / 1024.0;
+            iface.txKBps = counterDelta(current.values[4], previous->values[4]) / elapsedSeconds / 1024.0;
+        }
+        const bool loopback = current.nameLength == 2 && current.name[0] == 'l' && current.name[1] == 'o';
+        if (!loopback) {
+            totalDownKBps += iface.rxKBps;
+            totalUpKBps += iface.txKBps;
+        }
+        interfaces.append(iface);
+    }
+    m_data.interfaces = interfaces;
+    m_data.netDownSpeed_KBps = totalDownKBps;
+    m_data.netUpSpeed_KBps = totalUpKBps;
+}
+
+void SystemMonitor::readDiskStats()
+{
+    PROFILE_SCOPE("collector.diskstats");
+    const ProcText text = m_procFs.read(ProcFs::Proc, "diskstats");
+    if (text.isNull()) return;
+
+    std::swap(m_diskCounters, m_previousDiskCounters);
+    m_diskCounters.clear();
+    for (const char *p = text.begin; p < text.end;) {
+        // "   8       0 sda reads merged sectors ms writes merged sectors ms in_flight io_ms weighted_ms ..."
+        quint64 major, minor, fields[10] = {};
+        const char *name = nullptr;
+        int nameLength = 0;
+        if (ProcParse::readU64(p, text.end, &major) && ProcParse::readU64(p, text.end, &minor)) {
+            ProcParse::readToken(p, text.end, &name, &nameLength);
+            for (quint64 &field : fields) ProcParse::readU64(p, text.end, &field);
+            DiskCounters counters;
+            counters.nameLength = qMin(nameLength, static_cast<int>(sizeof(counters.name)));
+            std::memcpy(counters.name, name, counters.nameLength);
+            counters.reads = fields[0];
+            counters.readSectors = fields[2];
+            counters.readMs = fields[3];
+            counters.writes = fields[4];
+            counters.writeSectors = fields[6];
+            counters.writeMs = fields[7];
+            counters.ioMs = fields[9];
+            m_diskCounters.append(counters);
+        }
+        if (!ProcParse::nextLine(p, text.end)) break;
+    }
+
+    const qint64 currentTime = m_procFs.nowMs();
+    const double elapsedSeconds = m_previousDiskTimestamp > 0 ? (currentTime - m_previousDiskTimestamp) / 1000.0 : 0.0;
+    m_previousDiskTimestamp = currentTime;
+
+    QList<DiskDeviceData> disks;
+    for (int i = 0; i < m_diskCounters.size(); ++i) {
+        const DiskCounters &current = m_diskCounters[i];
+        // Partitions, and devices that never saw I/O (unused loop, nbd, ram).
+        if (current.reads == 0 && current.writes == 0) continue;
+        if (!isWholeDisk(current.name, current.nameLength)) continue;
+        const DiskCounters *previous = findCounters(m_previousDiskCounters, i, current);
+        DiskDeviceData disk;
+        disk.name = sharedName(m_data.disks, disks.size(), current.name, current.nameLength);
+        disk.readIops = disk.writeIops = disk.readKBps = disk.writeKBps = 0.0;
+        disk.readLatencyMs = disk.writeLatencyMs = disk.busyPercentage = 0.0;
+        if (previous && elapsedSeconds > 0) {
+            const quint64 reads = counterDelta(current.reads, previous->reads);
+            const quint64 writes = counterDelta(current.writes, previous->writes);
+            disk.readIops = reads / elapsedSeconds;
+            disk.writeIops = writes / elapsedSeconds;
+            // diskstats sectors are always 512 bytes.
+            disk.readKBps = counterDelta(current.readSectors, previous->readSectors) / 2.0 / elapsedSeconds;
+            disk.writeKBps = counterDelta(current.writeSectors, previous->writeSectors) / 2.0 / elapsedSeconds;
+            if (reads > 0) disk.readLatencyMs = static_cast<double>(counterDelta(current.readMs, previous->readMs)) / reads;
+            if (writes > 0) disk.writeLatencyMs = static_cast<double>(counterDelta(current.writeMs, previous->writeMs)) / writes;
+            disk.busyPercentage = qMin(100.0, counterDelta(current.ioMs, previous->ioMs) / (elapsedSeconds * 10.0));
+        }
+        disks.append(disk);
+    }
+    m_data.disks = disks;
+}
+
+bool SystemMonitor::isWholeDisk(const char *name, int length)
+{
+    const auto cached = m_wholeDisks.constFind(QByteArray::fromRawData(name, length));
+    if (cached != m_wholeDisks.constEnd()) return cached.value();
+    // Only whole devices have an entry in /sys/block; "/" in a name is "!" there.
+    char path[64];
+    int used = std::snprintf(path, sizeof(path), "block/");
+    for (int i = 0; i < length && used < int(sizeof(path)) - 5; ++i) path[used++] = name[i] == '/' ? '!' : name[i];
+    std::snprintf(path + used, sizeof(path) - used, "/dev");
+    const bool whole = !m_procFs.read(ProcFs::Sys, path).isNull();
+    m_wholeDisks.insert(QByteArray(name, length), whole);
+    return whole;
+}
+
+void SystemMonitor::readMounts()
+{
+    PROFILE_SCOPE("collector.mounts");
+    if (m_procFs.mountsChanged()) {
+        const ProcText text = m_procFs.read(ProcFs::Proc, "self/mountinfo");
+        if (!text.isNull()) parseMountInfo(text);
+    }
+
+    QList<MountData> mounts;
+    mounts.reserve(m_mounts.size());
+    bool sawRoot = false;
+    for (const MountEntry &entry : m_mounts) {
+        quint64 totalBytes = 0, freeBytes = 0;
+        if (!m_procFs.diskUsage(entry.path.constData(), &totalBytes, &freeBytes) || totalBytes == 0) continue;
+        MountData mount;
+        mount.mountPoint = entry.mountPoint;
+        mount.device = entry.device;
+        mount.fsType = entry.fsType;
+        mount.totalBytes = totalBytes;
+        mount.freeBytes = freeBytes;
+        mount.usedPercentage = 100.0 * static_cast<double>(totalBytes - freeBytes) / static_cast<double>(totalBytes);
+        if (entry.path == "/") {
+            m_data.diskPercentage = mount.usedPercentage;
+            sawRoot = true;
+        }
+        mounts.append(mount);
+    }
+    m_data.mounts = mounts;
+    if (!sawRoot) m_data.diskPercentage = readDiskUsage("/");
+}
+
+void SystemMonitor::parseMountInfo(const ProcText &text)
+{
+    // "36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue"
+    m_mounts.clear();
+    QSet<QByteArray> devices;
+    for (const char *p = text.begin; p < text.end;) {
+        const char *token = nullptr;
+        int length = 0;
+        const char *fields[5];
+        int lengths[5];
+        for (int i = 0; i < 5; ++i) {
+            ProcParse::readToken(p, text.end, &fields[i], &lengths[i]); // id, parent, dev, root, mount point
+        }
+        do {
+            ProcParse::readToken(p, text.end, &token, &length); // options and optional fields
+        } while (length > 0 && !(length == 1 && *token == '-'));
+        const char *fsType = nullptr, *source = nullptr;
+        int fsTypeLength = 0, sourceLength = 0;
+        ProcParse::readToken(p, text.end, &fsType, &fsTypeLength);
+        ProcParse::readToken(p, text.end, &source, &sourceLength);
+
+        if (fsTypeLength > 0 && isRealFilesystem(fsType, fsTypeLength, source, sourceLength)) {
+            // Bind mounts and btrfs subvolumes repeat a device; keep its first mount.
+            const QByteArray device(fields[2], lengths[2]);
+            if (!devices.contains(device)) {
+                devices.insert(device);
+                MountEntry entry;
+                entry.path = unescapeMountField(fields[4], lengths[4]);
+                entry.mountPoint = QString::fromUtf8(entry.path);
+                entry.device = QString::fromUtf8(unescapeMountField(source, sourceLength));
+                entry.fsType = QString::fromUtf8(fsType, fsTypeLength);
+                m_mounts.append(entry);
+            }
+        }
+        if (!ProcParse::nextLine(p, text.end)) break;
+    }
+}
+
+void SystemMonitor::readCgroups()
+{
+    if (m_procFs.isReplaying() || !m_cgroups.isAvailable()) return;
+    PROFILE_SCOPE("collector.cgroups");
+    m_cgroups.collect(m_procFs.nowMs(), &m_data.cgroups);
+}
+
+void SystemMonitor::readSockets()
+{
+    if (m_procFs.isReplaying() || !m_sockets.isAvailable()) return;
+    PROFILE_SCOPE("collector.sockets");
+    m_sockets.collect(m_procFs.nowMs(), m_pids, &m_data.sockets, &m_data.processes);
+}
+
+void SystemMonitor::readSensors()
+{
+    if (m_procFs.isReplaying()) return;
+    m_sensors.discover();
+    if (!m_sensors.isAvailable()) return;
+    PROFILE_SCOPE("collector.sensors");
+    m_sensors.collect(&m_data.sensors, &m_data.cpuFrequencies);
+    m_data.cpuTemperature = m_sensors.cpuTemperature();
+    m_data.cpuFrequencyMHz = m_sensors.averageFrequencyMHz();
+}
+
+// Throttling and overheating, each quoted against the CPU's recent load so
+// a hot, busy CPU can be told apart from a cooling problem at idle.
+QList<MonitorAlert> SystemMonitor::checkSensors(qint64 nowMs)
+{
+    QList<MonitorAlert> alerts;
+    m_cpuHistory.append({nowMs, m_data.cpuPercentage, m_data.cpuFrequencyMHz});
+    while (m_cpuHistory.size() > 1 && nowMs - m_cpuHistory.first().timestampMs > kCpuHistoryMs) m_cpuHistory.removeFirst();
+
+    const QList<CpuFrequencyData> &frequencies = m_data.cpuFrequencies;
+    quint64 throttleEvents = 0;
+    int throttledCpus = 0;
+    if (m_previousThrottleCounts.size() == frequencies.size()) {
+        for (int i = 0; i < frequencies.size(); ++i) {
+            const quint64 events = counterDelta(frequencies[i].throttleCount, m_previousThrottleCounts[i]);
+            throttleEvents += events;
+            if (events > 0) ++throttledCpus;
         }
     }
-    m_previousNetBytesReceived = totalBytesReceived;
-    m_previousNetBytesSent = totalBytesSent;
-    m_previousTimestamp = currentTime;
+    m_previousThrottleCounts.resize(frequencies.size());
+    for (int i = 0; i < frequencies.size(); ++i) m_previousThrottleCounts[i] = frequencies[i].throttleCount;
+
+    if (throttleEvents > 0 && nowMs - m_lastThrottleAlertMs >= kSensorAlertCooldownMs) {
+        m_lastThrottleAlertMs = nowMs;
+        MonitorAlert alert;
+        alert.source = MonitorAlert::Sensor;
+        alert.timestampMs = nowMs;
+        alert.series = "cpu.throttle";
+        alert.value = static_cast<double>(throttleEvents);
+        alert.message = QString("CPU thermal throttling on %1 CPU(s), %2 event(s); %3")
+                            .arg(throttledCpus).arg(throttleEvents).arg(cpuHistoryContext());
+        alerts.append(alert);
+    }
+
+    const SensorData *hottest = nullptr;
+    for (const SensorData &sensor : m_data.sensors) {
+        if (sensor.kind != SensorData::Temperature || sensor.critical <= 0) continue;
+        if (sensor.value < sensor.critical - kOverheatMarginC) continue;
+        if (!hottest || sensor.critical - sensor.value < hottest->critical - hottest->value) hottest = &sensor;
+    }
+    if (hottest && nowMs - m_lastOverheatAlertMs >= kSensorAlertCooldownMs) {
+        m_lastOverheatAlertMs = nowMs;
+        MonitorAlert alert;
+        alert.source = MonitorAlert::Sensor;
+        alert.timestampMs = nowMs;
+        alert.series = "sensor.temperature";
+        alert.value = hottest->value;
+        alert.message = QString("%1 %2 at %3 °C (limit %4 °C); %5")
+                            .arg(hottest->chip, hottest->label)
+                            .arg(hottest->value, 0, 'f', 0)
+                            .arg(hottest->critical, 0, 'f', 0)
+                            .arg(cpuHistoryContext());
+        alerts.append(alert);
+    }
+    return alerts;
+}
+
+QString SystemMonitor::cpuHistoryContext() const
+{
+    double sum = 0.0, peak = 0.0;
+    for (const CpuHistorySample &sample : m_cpuHistory) {
+        sum += sample.cpuPercentage;
+        peak = qMax(peak, sample.cpuPercentage);
+    }
+    const double average = m_cpuHistory.isEmpty() ? 0.0 : sum / m_cpuHistory.size();
+    const qint64 spanS = m_cpuHistory.isEmpty() ? 0 : (m_cpuHistory.last().timestampMs - m_cpuHistory.first().timestampMs) / 1000;
+    QString context = QString("CPU %1% now, %2% average and %3% peak over the last %4 s")
+                          .arg(m_data.cpuPercentage, 0, 'f', 0)
+                          .arg(average, 0, 'f', 0)
+                          .arg(peak, 0, 'f', 0)
+                          .arg(spanS);
+    if (m_data.cpuFrequencyMHz > 0 && m_data.cpuMaxMHz > 0) {
+        context += QString(", clocks at %1 MHz (%2% of max)")
+                       .arg(m_data.cpuFrequencyMHz, 0, 'f', 0)
+                       .arg(100.0 * m_data.cpuFrequencyMHz / m_data.cpuMaxMHz, 0, 'f', 0);
+    }
+    if (peak < 30.0) context += "; the CPU was mostly idle, so check cooling";
+    return context;
 }
 
 double SystemMonitor::readMemoryUsage()
 {
-    std::ifstream file("/proc/meminfo");
-    if (!file.is_open()) return 0.0;
-    std::string line;
-    long long memTotal = 0, memAvailable = 0;
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string key;
-        long long value;
-        ss >> key >> value;
-        if (key == "MemTotal:") memTotal = value;
-        if (key == "MemAvailable:") memAvailable = value;
-    }
-    file.close();
+    PROFILE_SCOPE("collector.memory");
+    const ProcText text = m_procFs.read(ProcFs::Proc, "meminfo");
+    if (text.isNull()) return 0.0;
+    quint64 memTotal = 0, memAvailable = 0;
+    int found = 0;
+    for (const char *p = text.begin; p < text.end && found < 2;) {
+        if (ProcParse::consume(p, text.end, "MemTotal:")) {
+            ProcParse::readU64(p, text.end, &memTotal);
+            ++found;
+        } else if (ProcParse::consume(p, text.end, "MemAvailable:")) {
+            ProcParse::readU64(p, text.end, &memAvailable);
+            ++found;
+        }
+        if (!ProcParse::nextLine(p, text.end)) break;
+    }
     if (memTotal == 0) return 0.0;
     m_data.totalSystemMemoryMB = memTotal / 1024;
     long long memUsed = memTotal - memAvailable;
@@ -156,31 +874,28 @@ double SystemMonitor::readMemoryUsage()
 
 double SystemMonitor::readDiskUsage(const char* path)
 {
-    struct statvfs stat;
-    if (statvfs(path, &stat) != 0) return 0.0;
-    unsigned long long totalBytes = stat.f_blocks * stat.f_frsize;
-    unsigned long long freeBytes = stat.f_bfree * stat.f_frsize;
-    unsigned long long usedBytes = totalBytes - freeBytes;
+    PROFILE_SCOPE("collector.disk");
+    quint64 totalBytes = 0, freeBytes = 0;
+    if (!m_procFs.diskUsage(path, &totalBytes, &freeBytes) || totalBytes == 0) return 0.0;
+    quint64 usedBytes = totalBytes - freeBytes;
     return 100.0 * static_cast<double>(usedBytes) / static_cast<double>(totalBytes);
 }
 
 double SystemMonitor::readCpuUsage()
 {
-    std::ifstream file("/proc/stat");
-    if (!file.is_open()) return 0.0;
-    std::string line;
-    std::getline(file, line);
-    file.close();
-    std::stringstream ss(line);
-    std::string cpu;
-    ss >> cpu;
-    std::vector<long long> times;
-    long long time;
-    while (ss >> time) times.push_back(time);
-    if (times.size() < 4) return 0.0;
+    PROFILE_SCOPE("collector.cpu");
+    const ProcText text = m_procFs.read(ProcFs::Proc, "stat");
+    if (text.isNull()) return 0.0;
+    const char *p = text.begin;
+    if (!ProcParse::consume(p, text.end, "cpu ")) return 0.0;
+    long long times[10] = {};
+    int count = 0;
+    quint64 time;
+    while (count < 10 && ProcParse::readU64(p, text.end, &time)) times[count++] = static_cast<long long>(time);
+    if (count < 5) return 0.0;
     long long idleTime = times[3] + times[4];
     long long totalTime = 0;
-    for(long long t : times) totalTime += t;
+    for (int i = 0; i < count; ++i) totalTime += times[i];
     double cpuUsage = 0.0;
     if (m_previousCpuTotalTime > 0) {
         long long deltaTotal = totalTime - m_previousCpuTotalTime;
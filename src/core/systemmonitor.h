@@ -4,7 +4,24 @@
 #include <QObject>
 #include <QTimer>
 #include <QTime>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
 #include "../common/systemdata.h"
+#include "../common/alert.h"
+#include "anomalydetector.h"
+#include "alertrules.h"
+#include "processdetailcache.h"
+#include "procfs.h"
+#include "proccapture.h"
+#include "cgroupcollector.h"
+#include "sensorcollector.h"
+#include "socketcollector.h"
+#include "usernamecache.h"
+#include "eventsources.h"
+#include "threadsampler.h"
+#include "metricsbus.h"
 
 class SystemMonitor : public QObject
 {
@@ -12,38 +29,160 @@ class SystemMonitor : public QObject
 
 public:
     explicit SystemMonitor(QObject *parent = nullptr);
+    SystemMonitor(const QString &procRoot, const QString &sysRoot, QObject *parent = nullptr);
     SystemData getSystemData() const;
+    // Thread-safe; the UI and copilot register and read per-process details here.
+    ProcessDetailCache *detailCache() { return &m_detailCache; }
+    // Lives in the monitor's thread; drive it with queued calls to watch().
+    ThreadSampler *threadSampler() { return m_threadSampler; }
+    // Every sample is published here; consumers subscribe from their own thread.
+    MetricsBus *metricsBus() { return &m_bus; }
+
+    enum ReplaySpeed { OriginalSpeed, MaximumSpeed };
+    struct CaptureOptions
+    {
+        QString recordPath;
+        QString replayPath;
+        ReplaySpeed replaySpeed = OriginalSpeed;
+    };
+    // Record the raw bytes of every procfs read to a capture file, or feed a
+    // capture back through the collectors instead of reading this host.
+    // Call before startMonitoring().
+    bool startRecording(const QString &path, QString *error);
+    bool startReplay(const QString &path, ReplaySpeed speed, QString *error);
+    bool applyCaptureOptions(const CaptureOptions &options, QString *error);
+
+    // Individual collectors, public so they can be driven and measured on
+    // their own (collector_bench). Results land in getSystemData(). Bracket
+    // them in a frame like a tick, or they see no timestamp and skip rates;
+    // readDynamicData() brackets itself.
+    bool beginFrame() { return m_procFs.beginFrame(); }
+    void endFrame() { m_procFs.endFrame(); }
+    void readStaticData();
+    // False once a replay has run out of frames.
+    bool readDynamicData();
+    double readCpuUsage();
+    double readMemoryUsage();
+    double readDiskUsage(const char* path);
+    // Per interface, including lo; the SystemData totals exclude it.
+    void readNetworkUsage();
+    // Whole block devices from /proc/diskstats.
+    void readDiskStats();
+    // Usage of every real filesystem; also sets diskPercentage from "/".
+    void readMounts();
+    // cgroup v2 usage; live only, skipped when replaying.
+    void readCgroups();
+    // hwmon temperatures and fans, per-CPU clocks and throttle counts; live
+    // only, skipped when replaying.
+    void readSensors();
+    void readProcessList();
+    // TCP, UDP and unix sockets and their owners, after readProcessList();
+    // live only, skipped when replaying.
+    void readSockets();
 
 public slots:
     void startMonitoring();
 
 signals:
-    void dynamicDataUpdated(const SystemData &data);
     void staticDataReady(const SystemData &data);
+    void alertsRaised(const QList<MonitorAlert> &alerts);
+    void replayFinished();
     void finished();
 
 private slots:
     void pollDynamicData();
+    // An extra tick now, unless one just ran.
+    void pollSoon();
+    void onPressureStall(EventSources::Resource resource);
+    void onProcessesChanged(const QVector<int> &changed, const QVector<int> &exited);
+    void applyProcessEvents();
 
 private:
-    void readStaticData();
-    void readDynamicData();
+    // Raw counters of the current and previous read, parsed in one pass into
+    // arrays that keep their capacity from tick to tick.
+    struct NetCounters
+    {
+        char name[16]; // IFNAMSIZ
+        int nameLength;
+        quint64 values[8]; // rx bytes, packets, errs, drop, then the same for tx
+    };
+    struct DiskCounters
+    {
+        char name[32];
+        int nameLength;
+        quint64 reads, readSectors, readMs, writes, writeSectors, writeMs, ioMs;
+    };
+    struct CpuHistorySample
+    {
+        qint64 timestampMs;
+        double cpuPercentage;
+        double frequencyMHz;
+    };
+    struct MountEntry
+    {
+        QByteArray path; // unescaped mount point, for statvfs
+        QString mountPoint;
+        QString device;
+        QString fsType;
+    };
 
-    double readCpuUsage();
-    double readMemoryUsage();
-    double readDiskUsage(const char* path);
-    void readNetworkUsage();
-    void readProcessList();
+    void startEventSources();
+    // Reads only the cumulative counters, so the next tick has rates.
+    void primeCounters();
+    // elapsedSeconds since `previous` was read, for CPU%; 0 keeps its rate.
+    // `execed` forces the command line to be read again even though pid and
+    // start time match `previous`.
+    bool readProcess(int pid, const ProcessData *previous, double elapsedSeconds, bool execed, ProcessData *process);
+    QString readCommandLine(int pid, const QString &name);
+    void pruneCommandLines();
+    bool isWholeDisk(const char *name, int length);
+    void parseMountInfo(const ProcText &text);
+    QList<MonitorAlert> checkSensors(qint64 nowMs);
+    QString cpuHistoryContext() const;
 
     QTimer *m_timer;
+    QElapsedTimer m_sinceLastPoll;
+    EventSources *m_events = nullptr;
+    QTimer *m_processEventTimer = nullptr;
+    QSet<int> m_changedPids;
+    QSet<int> m_exitedPids;
+    qint64 m_lastPressureAlertMs[EventSources::ResourceCount] = {};
     SystemData m_data;
+    MetricsBus m_bus;
+    ProcFs m_procFs;
+    CgroupCollector m_cgroups{&m_procFs};
+    SensorCollector m_sensors{&m_procFs};
+    SocketCollector m_sockets{&m_procFs};
+    ThreadSampler *m_threadSampler = new ThreadSampler(&m_procFs, this);
+    ProcCapture m_capture;
+    ProcReplay m_replay;
+    ReplaySpeed m_replaySpeed = OriginalSpeed;
+    QVector<int> m_pids;
+    qint64 m_previousProcessScanMs = 0;
+    UserNameCache m_userNames;
+    // Distinct command lines, so identical workers share one string; entries
+    // no process uses any more are dropped by pruneCommandLines().
+    QSet<QString> m_commandLines;
+    QByteArray m_commandLineBuffer;
+    AnomalyDetector m_anomalyDetector;
+    AlertRuleEngine m_ruleEngine;
+    ProcessDetailCache m_detailCache;
 
     long long m_previousCpuIdleTime = 0;
     long long m_previousCpuTotalTime = 0;
 
-    long long m_previousNetBytesReceived = 0;
-    long long m_previousNetBytesSent = 0;
-    qint64 m_previousTimestamp = 0;
+    QVector<NetCounters> m_netCounters;
+    QVector<NetCounters> m_previousNetCounters;
+    qint64 m_previousNetTimestamp = 0;
+    QVector<DiskCounters> m_diskCounters;
+    QVector<DiskCounters> m_previousDiskCounters;
+    qint64 m_previousDiskTimestamp = 0;
+    QHash<QByteArray, bool> m_wholeDisks; // by diskstats name
+    QVector<MountEntry> m_mounts; // rebuilt only when mountinfo changes
+    QVector<CpuHistorySample> m_cpuHistory; // last kCpuHistoryMs of ticks
+    QVector<quint64> m_previousThrottleCounts;
+    qint64 m_lastThrottleAlertMs = 0;
+    qint64 m_lastOverheatAlertMs = 0;
 };
 
 #endif // SYSTEMMONITOR_H
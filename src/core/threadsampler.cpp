@@ -0,0 +1,99 @@
+#include "threadsampler.h"
+#include "selfprofiler.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+ThreadSampler::ThreadSampler(ProcFs *procFs, QObject *parent)
+    : QObject(parent),
+      m_procFs(procFs),
+      m_timer(new QTimer(this)),
+      m_ticksPerSecond(static_cast<double>(sysconf(_SC_CLK_TCK)))
+{
+    connect(m_timer, &QTimer::timeout, this, &ThreadSampler::sample);
+}
+
+ThreadSampler::~ThreadSampler()
+{
+    stop();
+}
+
+void ThreadSampler::stop()
+{
+    m_timer->stop();
+    if (m_taskFd >= 0) ::close(m_taskFd);
+    m_taskFd = -1;
+    m_pid = 0;
+    m_counters.clear();
+    m_previousCounters.clear();
+    m_threads.clear();
+}
+
+void ThreadSampler::watch(int pid)
+{
+    if (pid == m_pid) return;
+    stop();
+    if (pid <= 0 || m_procFs->isReplaying()) return;
+
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d/task", pid);
+    m_taskFd = ::openat(m_procFs->rootFd(ProcFs::Proc), path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    m_pid = pid;
+    m_sinceSample.invalidate();
+    sample();
+    m_timer->start(IntervalMs);
+}
+
+void ThreadSampler::sample()
+{
+    PROFILE_SCOPE("collector.threads");
+    if (!ProcFs::listNumeric(m_taskFd, &m_tids)) {
+        const int pid = m_pid;
+        stop();
+        emit threadsSampled(pid, {});
+        return;
+    }
+    const double elapsedSeconds = m_sinceSample.isValid() ? m_sinceSample.nsecsElapsed() / 1e9 : 0.0;
+    m_sinceSample.start();
+
+    std::swap(m_counters, m_previousCounters);
+    m_counters.clear();
+    const QList<ThreadData> &previousThreads = m_threads;
+    QList<ThreadData> threads;
+    threads.reserve(m_tids.size());
+    int previousCounter = 0, previousThread = 0;
+
+    for (int tid : m_tids) {
+        char path[32];
+        std::snprintf(path, sizeof(path), "%d/stat", tid);
+        const ProcText text = m_procFs->readAt(m_taskFd, path);
+        if (text.isNull()) continue; // exited since the listing
+
+        ProcParse::PidStat stat;
+        if (!ProcParse::parsePidStat(text, &stat)) continue;
+        const Counters counters = {tid, stat.utime + stat.stime};
+        m_counters.append(counters);
+
+        ThreadData thread;
+        thread.tid = tid;
+        thread.state = stat.state;
+        thread.processor = stat.processor;
+        thread.cpuPercentage = 0.0;
+        while (previousCounter < m_previousCounters.size() && m_previousCounters[previousCounter].tid < tid) ++previousCounter;
+        if (elapsedSeconds > 0 && previousCounter < m_previousCounters.size() && m_previousCounters[previousCounter].tid == tid) {
+            const quint64 previousTicks = m_previousCounters[previousCounter].ticks;
+            const quint64 delta = counters.ticks >= previousTicks ? counters.ticks - previousTicks : 0;
+            thread.cpuPercentage = 100.0 * delta / m_ticksPerSecond / elapsedSeconds;
+        }
+        while (previousThread < previousThreads.size() && previousThreads[previousThread].tid < tid) ++previousThread;
+        if (previousThread < previousThreads.size() && previousThreads[previousThread].tid == tid
+            && previousThreads[previousThread].name == QLatin1String(stat.name, stat.nameLength)) {
+            thread.name = previousThreads[previousThread].name;
+        } else {
+            thread.name = QString::fromUtf8(stat.name, stat.nameLength);
+        }
+        threads.append(thread);
+    }
+    m_threads = threads;
+    emit threadsSampled(m_pid, m_threads);
+}
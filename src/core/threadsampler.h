@@ -0,0 +1,59 @@
+#ifndef THREADSAMPLER_H
+#define THREADSAMPLER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include "../common/systemdata.h"
+#include "procfs.h"
+
+// Per-thread CPU, state and name for one process, sampled faster than the
+// global scan but only while someone is watching. Holds <pid>/task open and
+// reads each <tid>/stat relative to it through the monitor's ProcFs buffer,
+// so a sample of a process with thousands of threads allocates only its
+// result list. Lives in the monitor thread.
+class ThreadSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum { IntervalMs = 500 };
+
+    explicit ThreadSampler(ProcFs *procFs, QObject *parent = nullptr);
+    ~ThreadSampler();
+
+public slots:
+    // Starts sampling pid every IntervalMs; pid <= 0 stops. Does nothing
+    // when replaying: captures carry no per-thread data.
+    void watch(int pid);
+
+signals:
+    // Threads in tid order; empty once the process is gone.
+    void threadsSampled(int pid, const QList<ThreadData> &threads);
+
+private slots:
+    void sample();
+
+private:
+    struct Counters
+    {
+        int tid;
+        quint64 ticks; // utime + stime
+    };
+
+    void stop();
+
+    ProcFs *m_procFs;
+    QTimer *m_timer;
+    QElapsedTimer m_sinceSample;
+    int m_pid = 0;
+    int m_taskFd = -1;
+    double m_ticksPerSecond;
+    QVector<int> m_tids;
+    QVector<Counters> m_counters;
+    QVector<Counters> m_previousCounters;
+    QList<ThreadData> m_threads;
+};
+
+#endif // THREADSAMPLER_H
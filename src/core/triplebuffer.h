@@ -0,0 +1,44 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Single-producer, single-consumer hand-off of the most recent value through
+// three fixed slots: the producer fills back() and publishes it, the
+// consumer takes whatever was published last. Neither side blocks or
+// allocates; values published faster than they are taken are overwritten,
+// so a slow consumer costs at most three values of memory.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Producer side. publish() is true if it overwrote a value that was
+    // never taken.
+    T &back() { return m_slots[m_back]; }
+    bool publish()
+    {
+        const int previous = m_middle.exchange(m_back | Fresh);
+        m_back = previous & IndexMask;
+        return previous & Fresh;
+    }
+
+    // Consumer side. False if nothing was published since the last take();
+    // front() stays valid until the next successful take().
+    bool take()
+    {
+        if (!(m_middle.load() & Fresh)) return false;
+        m_front = m_middle.exchange(m_front) & IndexMask;
+        return true;
+    }
+    const T &front() const { return m_slots[m_front]; }
+
+private:
+    enum { IndexMask = 3, Fresh = 4 };
+
+    T m_slots[3];
+    int m_back = 0;
+    std::atomic<int> m_middle{1};
+    int m_front = 2;
+};
+
+#endif // TRIPLEBUFFER_H
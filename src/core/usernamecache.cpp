@@ -0,0 +1,43 @@
+#include "usernamecache.h"
+#include <pwd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+UserNameCache::UserNameCache(const QByteArray &passwdPath)
+    : m_passwdPath(passwdPath)
+{
+}
+
+bool UserNameCache::refresh()
+{
+    // Editors and useradd replace the file, so the inode matters as much as
+    // the mtime.
+    struct stat info;
+    Stamp stamp;
+    if (::stat(m_passwdPath.constData(), &info) == 0) {
+        stamp.device = info.st_dev;
+        stamp.inode = info.st_ino;
+        stamp.size = info.st_size;
+        stamp.modifiedNs = qint64(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    }
+    if (stamp == m_stamp) return false;
+    m_stamp = stamp;
+    m_names.clear();
+    return true;
+}
+
+QString UserNameCache::name(uint uid)
+{
+    auto it = m_names.constFind(uid);
+    if (it != m_names.constEnd()) return *it;
+
+    QString name;
+    passwd entry;
+    passwd *result = nullptr;
+    char buffer[16384];
+    if (::getpwuid_r(uid, &entry, buffer, sizeof(buffer), &result) == 0 && result && result->pw_name)
+        name = QString::fromUtf8(result->pw_name);
+    if (name.isEmpty()) name = QString::number(uid);
+    m_names.insert(uid, name);
+    return name;
+}
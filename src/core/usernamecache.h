@@ -0,0 +1,42 @@
+#ifndef USERNAMECACHE_H
+#define USERNAMECACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+// uid -> login name for the process table. Each uid is resolved through
+// getpwuid_r() once and the answer kept until the passwd file changes, which
+// refresh() detects with a single stat(); a tick costs one hash lookup per
+// process instead of an NSS query per row. Not thread-safe.
+class UserNameCache
+{
+public:
+    explicit UserNameCache(const QByteArray &passwdPath = "/etc/passwd");
+
+    // Forgets every name if the passwd file was replaced or modified since
+    // the last call. True if it did.
+    bool refresh();
+    // Login name, or the number for uids without a passwd entry.
+    QString name(uint uid);
+
+private:
+    struct Stamp
+    {
+        quint64 device = 0;
+        quint64 inode = 0;
+        qint64 size = -1;
+        qint64 modifiedNs = 0;
+
+        bool operator==(const Stamp &other) const
+        {
+            return device == other.device && inode == other.inode && size == other.size && modifiedNs == other.modifiedNs;
+        }
+    };
+
+    QByteArray m_passwdPath;
+    Stamp m_stamp;
+    QHash<uint, QString> m_names;
+};
+
+#endif // USERNAMECACHE_H
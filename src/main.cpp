@@ -1,10 +1,114 @@
 #include "ui/mainwindow.h"
+#include "core/agentserver.h"
+#include "core/selfprofiler.h"
+#include "core/systemmonitor.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <cstring>
+
+static QList<QCommandLineOption> captureOptions()
+{
+    return {
+        QCommandLineOption("record", "Record every procfs read to a capture file.", "file"),
+        QCommandLineOption("replay", "Replay a capture file instead of reading this host.", "file"),
+        QCommandLineOption("replay-speed", "\"original\" (default) or \"max\".", "speed", "original"),
+    };
+}
+
+static SystemMonitor::CaptureOptions parseCaptureOptions(const QCommandLineParser &parser)
+{
+    SystemMonitor::CaptureOptions options;
+    options.recordPath = parser.value("record");
+    options.replayPath = parser.value("replay");
+    options.replaySpeed = parser.value("replay-speed") == "max" ? SystemMonitor::MaximumSpeed : SystemMonitor::OriginalSpeed;
+    return options;
+}
+
+// Headless mode: stream this host's samples to remote consoles.
+static int runAgent(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("sys-copilot");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption agentOption("agent", "Run as a headless monitoring agent.");
+    QCommandLineOption portOption("port", "Port to listen on.", "port", QString::number(Wire::DefaultPort));
+    // Unauthenticated and it sends every process name, so local-only unless
+    // exposing it is asked for.
+    QCommandLineOption bindOption("bind", "Address to listen on (e.g. 0.0.0.0 for all interfaces).", "address", "127.0.0.1");
+    parser.addOptions({agentOption, portOption, bindOption});
+    parser.addOptions(captureOptions());
+    parser.process(a);
+
+    bool portOk = false;
+    const quint16 port = parser.value(portOption).toUShort(&portOk);
+    if (!portOk || port == 0) {
+        qCritical("Invalid port %s", qPrintable(parser.value(portOption)));
+        return 1;
+    }
+    QHostAddress bindAddress;
+    if (!bindAddress.setAddress(parser.value(bindOption))) {
+        qCritical("Invalid bind address %s", qPrintable(parser.value(bindOption)));
+        return 1;
+    }
+    AgentServer server;
+    if (!server.listen(bindAddress, port)) {
+        qCritical("Could not listen on %s:%s: %s", qPrintable(parser.value(bindOption)),
+                  qPrintable(parser.value(portOption)), qPrintable(server.errorString()));
+        return 1;
+    }
+
+    SystemMonitor monitor;
+    QString captureError;
+    if (!monitor.applyCaptureOptions(parseCaptureOptions(parser), &captureError)) {
+        qCritical("%s", qPrintable(captureError));
+        return 1;
+    }
+    QObject::connect(&monitor, &SystemMonitor::replayFinished, &a, &QCoreApplication::quit);
+    QObject::connect(&monitor, &SystemMonitor::staticDataReady, &server, &AgentServer::onStaticDataReady);
+    MetricsSubscription *samples = monitor.metricsBus()->subscribe(MetricsBus::Processes, 0, &server);
+    QObject::connect(samples, &MetricsSubscription::sampleReady, &server, &AgentServer::onDynamicDataUpdated);
+    monitor.startMonitoring();
+    return a.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    const qint64 launchNs = SelfProfiler::now();
+    // Decided before any QApplication exists so the agent never needs a display.
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--agent") == 0) return runAgent(argc, argv);
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
+    a.setApplicationName("sys-copilot");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption agentOption("agent", "Run as a headless agent instead (--agent --help for its options).");
+    QCommandLineOption connectOption("connect", "Remote agents to show, as host[:port] (repeatable).", "host");
+    parser.addOptions({agentOption, connectOption});
+    parser.addOptions(captureOptions());
+    parser.process(a);
+
+    // Checked before any window exists, so a typo is not a silent port-0 host.
+    QList<QPair<QString, quint16>> remoteHosts;
+    for (const QString &entry : parser.values(connectOption)) {
+        const int colon = entry.lastIndexOf(':');
+        const QString host = colon > 0 ? entry.left(colon) : entry;
+        bool portOk = true;
+        const quint16 port = colon > 0 ? entry.mid(colon + 1).toUShort(&portOk) : Wire::DefaultPort;
+        if (host.isEmpty() || !portOk || port == 0) {
+            qCritical("Invalid --connect entry '%s', expected host[:port]", qPrintable(entry));
+            return 1;
+        }
+        remoteHosts.append({host, port});
+    }
+
+    MainWindow w(parseCaptureOptions(parser));
+    w.setLaunchTime(launchNs);
+    for (const auto &remoteHost : remoteHosts) w.addRemoteHost(remoteHost.first, remoteHost.second);
     w.show();
     return a.exec();
 }
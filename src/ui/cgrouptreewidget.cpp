@@ -0,0 +1,124 @@
+#include "cgrouptreewidget.h"
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QSet>
+
+namespace {
+
+enum Column { NameColumn, CpuColumn, MemoryColumn, AnonColumn, FileColumn, ReadColumn, WriteColumn,
+              CpuPressureColumn, MemoryPressureColumn, IoPressureColumn, ColumnCount };
+
+// Sorts numeric columns by value instead of by text.
+class CgroupItem : public QTreeWidgetItem
+{
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+    bool operator<(const QTreeWidgetItem &other) const override
+    {
+        const int column = treeWidget() ? treeWidget()->sortColumn() : NameColumn;
+        if (column == NameColumn) return QTreeWidgetItem::operator<(other);
+        return data(column, Qt::UserRole).toDouble() < other.data(column, Qt::UserRole).toDouble();
+    }
+};
+
+void setCell(QTreeWidgetItem *item, int column, double value, const QString &text)
+{
+    item->setData(column, Qt::UserRole, value);
+    item->setText(column, text);
+}
+
+QString megabytes(quint64 bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+}
+
+CgroupTreeWidget::CgroupTreeWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    m_summaryLabel = new QLabel("No cgroup v2 hierarchy found.", this);
+    layout->addWidget(m_summaryLabel);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setColumnCount(ColumnCount);
+    m_tree->setHeaderLabels({"Cgroup", "CPU", "Memory", "Anon", "File", "Disk Read", "Disk Write",
+                             "CPU Pressure", "Mem Pressure", "IO Pressure"});
+    m_tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_tree->header()->setSectionResizeMode(NameColumn, QHeaderView::Stretch);
+    m_tree->setSortingEnabled(true);
+    m_tree->sortByColumn(CpuColumn, Qt::DescendingOrder);
+    layout->addWidget(m_tree);
+}
+
+void CgroupTreeWidget::updateCgroups(const QList<CgroupData> &cgroups)
+{
+    m_pending = cgroups;
+    if (isVisible()) apply();
+}
+
+void CgroupTreeWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    apply();
+}
+
+void CgroupTreeWidget::apply()
+{
+    // Empty when the hierarchy is gone or a replay started; drop what was shown.
+    if (m_pending.isEmpty()) {
+        m_tree->clear();
+        m_items.clear();
+        m_summaryLabel->setText("No cgroup v2 hierarchy found.");
+        return;
+    }
+    m_tree->setSortingEnabled(false);
+
+    QSet<QString> seen;
+    QVector<QTreeWidgetItem *> items(m_pending.size(), nullptr);
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const CgroupData &cgroup = m_pending[i];
+        seen.insert(cgroup.path);
+        QTreeWidgetItem *item = m_items.value(cgroup.path);
+        if (!item) {
+            QTreeWidgetItem *parentItem = cgroup.parent >= 0 ? items[cgroup.parent] : nullptr;
+            item = parentItem ? new CgroupItem(parentItem) : new CgroupItem(m_tree);
+            const int slash = cgroup.path.lastIndexOf('/');
+            item->setText(NameColumn, cgroup.parent < 0 ? cgroup.path : cgroup.path.mid(slash + 1));
+            item->setToolTip(NameColumn, cgroup.path);
+            if (cgroup.parent < 0) item->setExpanded(true);
+            m_items.insert(cgroup.path, item);
+        }
+        items[i] = item;
+        setCell(item, CpuColumn, cgroup.cpuPercentage, QString::number(cgroup.cpuPercentage, 'f', 1) + "%");
+        setCell(item, MemoryColumn, cgroup.memoryBytes, megabytes(cgroup.memoryBytes));
+        setCell(item, AnonColumn, cgroup.anonBytes, megabytes(cgroup.anonBytes));
+        setCell(item, FileColumn, cgroup.fileBytes, megabytes(cgroup.fileBytes));
+        setCell(item, ReadColumn, cgroup.ioReadKBps, QString::number(cgroup.ioReadKBps, 'f', 1) + " KB/s");
+        setCell(item, WriteColumn, cgroup.ioWriteKBps, QString::number(cgroup.ioWriteKBps, 'f', 1) + " KB/s");
+        setCell(item, CpuPressureColumn, cgroup.cpuPressure, QString::number(cgroup.cpuPressure, 'f', 2) + "%");
+        setCell(item, MemoryPressureColumn, cgroup.memoryPressure, QString::number(cgroup.memoryPressure, 'f', 2) + "%");
+        setCell(item, IoPressureColumn, cgroup.ioPressure, QString::number(cgroup.ioPressure, 'f', 2) + "%");
+    }
+
+    // Deleting an item deletes its children, so only delete the topmost
+    // stale item of each removed subtree.
+    QList<QTreeWidgetItem *> stale;
+    for (auto it = m_items.begin(); it != m_items.end();) {
+        if (seen.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        stale.append(it.value());
+        it = m_items.erase(it);
+    }
+    const QSet<QTreeWidgetItem *> staleSet(stale.begin(), stale.end());
+    for (QTreeWidgetItem *item : stale) {
+        if (!staleSet.contains(item->parent())) delete item;
+    }
+
+    m_tree->setSortingEnabled(true);
+    m_summaryLabel->setText(QString("%1 cgroups").arg(m_pending.size()));
+}
@@ -0,0 +1,35 @@
+#ifndef CGROUPTREEWIDGET_H
+#define CGROUPTREEWIDGET_H
+
+#include <QWidget>
+#include <QHash>
+#include <QLabel>
+#include <QTreeWidget>
+#include "common/systemdata.h"
+
+// The cgroup v2 hierarchy with per-group CPU, memory, I/O and pressure.
+// Items are kept across updates so expansion, selection and sort order
+// survive; nothing is touched while the tab is hidden.
+class CgroupTreeWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CgroupTreeWidget(QWidget *parent = nullptr);
+
+public slots:
+    void updateCgroups(const QList<CgroupData> &cgroups);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void apply();
+
+    QLabel *m_summaryLabel;
+    QTreeWidget *m_tree;
+    QHash<QString, QTreeWidgetItem *> m_items;
+    QList<CgroupData> m_pending;
+};
+
+#endif // CGROUPTREEWIDGET_H
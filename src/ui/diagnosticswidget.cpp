@@ -0,0 +1,105 @@
+#include "diagnosticswidget.h"
+#include "core/selfprofiler.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMessageBox>
+
+DiagnosticsWidget::DiagnosticsWidget(QWidget *parent)
+    : QWidget(parent),
+      m_refreshTimer(new QTimer(this))
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    m_summaryLabel = new QLabel(this);
+    layout->addWidget(m_summaryLabel);
+
+    m_table = new QTableWidget(0, 7, this);
+    m_table->setHorizontalHeaderLabels({"Probe", "Count", "p50 (us)", "p99 (us)", "Max (us)", "Total (ms)", "% Wall"});
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    layout->addWidget(m_table);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    m_traceCheck = new QCheckBox("Record trace", this);
+    QPushButton *exportButton = new QPushButton("Export Chrome Trace...", this);
+    QPushButton *resetButton = new QPushButton("Reset", this);
+    buttons->addWidget(m_traceCheck);
+    buttons->addStretch();
+    buttons->addWidget(exportButton);
+    buttons->addWidget(resetButton);
+    layout->addLayout(buttons);
+
+    m_traceCheck->setChecked(SelfProfiler::isTracing());
+    connect(m_traceCheck, &QCheckBox::toggled, this, [](bool enabled) { SelfProfiler::setTracing(enabled); });
+    connect(exportButton, &QPushButton::clicked, this, &DiagnosticsWidget::onExportClicked);
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsWidget::onResetClicked);
+
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiagnosticsWidget::refresh);
+}
+
+void DiagnosticsWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    m_refreshTimer->start();
+}
+
+void DiagnosticsWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_refreshTimer->stop();
+}
+
+void DiagnosticsWidget::refresh()
+{
+    const QList<SelfProfiler::ProbeStats> stats = SelfProfiler::snapshot();
+    const double wallNs = qMax<qint64>(1, SelfProfiler::elapsedSinceReset());
+    auto us = [](quint64 ns) { return QString::number(ns / 1000.0, 'f', 1); };
+
+    m_table->setRowCount(stats.size());
+    double monitorNs = 0.0;
+    for (int row = 0; row < stats.size(); ++row) {
+        const SelfProfiler::ProbeStats &probe = stats[row];
+        const LatencyHistogram &h = probe.histogram;
+        if (probe.name == "monitor.tick" || probe.name == "monitor.anomaly" || probe.name == "monitor.rules")
+            monitorNs += probe.totalNs;
+        const QStringList cells = {probe.name, QString::number(h.count()), us(h.percentile(50)), us(h.percentile(99)),
+                                   us(h.max()), QString::number(probe.totalNs / 1e6, 'f', 2),
+                                   QString::number(100.0 * probe.totalNs / wallNs, 'f', 3)};
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+    m_summaryLabel->setText(QString("Monitor thread busy %1% of wall time over the last %2 s")
+                                .arg(100.0 * monitorNs / wallNs, 0, 'f', 3)
+                                .arg(wallNs / 1e9, 0, 'f', 0));
+}
+
+void DiagnosticsWidget::onResetClicked()
+{
+    SelfProfiler::reset();
+    refresh();
+}
+
+void DiagnosticsWidget::onExportClicked()
+{
+    const QString path = QFileDialog::getSaveFileName(this, "Export Chrome Trace", "sys-copilot-trace.json", "JSON (*.json)");
+    if (path.isEmpty()) return;
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(this, "Export Chrome Trace", "Could not write " + path);
+        return;
+    }
+    file.write(QJsonDocument(SelfProfiler::chromeTrace()).toJson(QJsonDocument::Compact));
+}
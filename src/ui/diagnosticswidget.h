@@ -0,0 +1,35 @@
+#ifndef DIAGNOSTICSWIDGET_H
+#define DIAGNOSTICSWIDGET_H
+
+#include <QWidget>
+#include <QCheckBox>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTimer>
+
+// The monitor's own overhead: SelfProfiler probes merged over all threads.
+// Refreshes only while visible.
+class DiagnosticsWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsWidget(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+    void onResetClicked();
+    void onExportClicked();
+
+private:
+    QLabel *m_summaryLabel;
+    QTableWidget *m_table;
+    QCheckBox *m_traceCheck;
+    QTimer *m_refreshTimer;
+};
+
+#endif // DIAGNOSTICSWIDGET_H
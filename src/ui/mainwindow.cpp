@@ -4,6 +4,8 @@
 #include <QHBoxLayout>
 #include <QFont>
 #include <QHeaderView>
+#include <QScrollBar>
+#include <QSet>
 #include <QMessageBox>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -11,28 +13,66 @@
 #include <QFile>
 #include <QTextStream>
 #include <QProcess>
+#include <QStatusBar>
+#include <QShortcut>
+#include <QSysInfo>
+#include "core/selfprofiler.h"
+#include "core/snapshotcache.h"
+#include <QDateTime>
+#include <QLocale>
+#include <QTimer>
+#include <QDebug>
 #include <algorithm>
 #include <signal.h>
 
+namespace {
+
+// Process events can patch the sample several times a second; the tables
+// are repainted at most this often.
+constexpr int kUiMinIntervalMs = 500;
+constexpr int kCopilotMinIntervalMs = 1000;
+constexpr int kDetailsScrollDelayMs = 100;
+
+}
+
 // Constructor
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const SystemMonitor::CaptureOptions &capture, QWidget *parent)
     : QMainWindow(parent)
 {
+    m_launchNs = SelfProfiler::now();
     m_copilot = new Copilot(this);
     setupUi();
+    m_tabWidget->installEventFilter(this);
+    // A replay shows another host, or this one in the past.
+    m_saveSnapshot = capture.replayPath.isEmpty();
+    if (m_saveSnapshot) showCachedSnapshot();
 
     m_monitorThread = new QThread(this);
+    m_monitorThread->setObjectName("monitor");
     m_monitor = new SystemMonitor();
+    QString captureError;
+    if (!m_monitor->applyCaptureOptions(capture, &captureError))
+        QMessageBox::warning(this, "Capture", captureError + "\n\nMonitoring this host live instead.");
     m_monitor->moveToThread(m_monitorThread);
+    m_detailCache = m_monitor->detailCache();
+    m_copilot->setProcessDetailCache(m_detailCache, m_monitor);
 
     connect(m_monitorThread, &QThread::started, m_monitor, &SystemMonitor::startMonitoring);
     connect(m_monitor, &SystemMonitor::finished, m_monitorThread, &QThread::quit);
     connect(m_monitorThread, &QThread::finished, m_monitor, &SystemMonitor::deleteLater);
     connect(m_monitorThread, &QThread::finished, m_monitorThread, &QThread::deleteLater);
 
-    connect(m_monitor, &SystemMonitor::dynamicDataUpdated, this, &MainWindow::onDynamicDataUpdated);
+    MetricsSubscription *uiSamples = m_monitor->metricsBus()->subscribe(MetricsBus::Processes | MetricsBus::Devices | MetricsBus::Cgroups, kUiMinIntervalMs, this);
+    connect(uiSamples, &MetricsSubscription::sampleReady, this, &MainWindow::onDynamicDataUpdated);
     connect(m_monitor, &SystemMonitor::staticDataReady, this, &MainWindow::onStaticDataReady);
-    connect(m_monitor, &SystemMonitor::dynamicDataUpdated, m_copilot, &Copilot::onSystemDataUpdated); // New connection for Copilot
+    // The copilot only reads the latest sample when a tool asks for it.
+    MetricsSubscription *copilotSamples = m_monitor->metricsBus()->subscribe(MetricsBus::AllFields, kCopilotMinIntervalMs, m_copilot);
+    connect(copilotSamples, &MetricsSubscription::sampleReady, m_copilot, &Copilot::onSystemDataUpdated);
+    connect(m_monitor, &SystemMonitor::alertsRaised, this, &MainWindow::onAlertsRaised);
+    connect(m_monitor, &SystemMonitor::alertsRaised, m_copilot, &Copilot::onAlertsRaised);
+    connect(m_monitor, &SystemMonitor::replayFinished, this, [this]() { statusBar()->showMessage("Replay finished"); });
+    connect(this, &MainWindow::threadWatchRequested, m_monitor->threadSampler(), &ThreadSampler::watch);
+    connect(m_monitor->threadSampler(), &ThreadSampler::threadsSampled, this, &MainWindow::onThreadsSampled);
 
     m_monitorThread->start();
 }
@@ -44,19 +84,30 @@ MainWindow::~MainWindow()
         m_monitorThread->quit();
         m_monitorThread->wait();
     }
+    QString error;
+    if (m_saveSnapshot && m_lastData.sampledAtNs > 0 && !SnapshotCache::save(SnapshotCache::defaultPath(), m_lastData, &error))
+        qWarning() << "Could not save the startup snapshot:" << error;
+}
+
+void MainWindow::addRemoteHost(const QString &host, quint16 port)
+{
+    m_remoteHosts->addHost(host, port);
 }
 
 void MainWindow::onExplainClicked()
 {
     auto selectedItems = m_processTableWidget->selectedItems();
     if (selectedItems.isEmpty()) return;
-    QString processName = m_processTableWidget->item(selectedItems.first()->row(), 1)->text();
+    QString processName = m_processTableWidget->item(selectedItems.first()->row(), ProcessNameColumn)->text();
     m_copilot->onExplainClicked(processName);
 }
 
 // --- Core UI and Process Management Functions ---
 void MainWindow::onDynamicDataUpdated(const SystemData &data)
 {
+    static const int hopProbe = SelfProfiler::probe("hop.monitor-to-ui");
+    if (data.sampledAtNs > 0) SelfProfiler::record(hopProbe, data.sampledAtNs, SelfProfiler::now());
+    PROFILE_SCOPE("ui.dynamicUpdate");
     m_cpuProgressBar->setValue(static_cast<int>(data.cpuPercentage));
     m_memProgressBar->setValue(static_cast<int>(data.memPercentage));
     m_diskProgressBar->setValue(static_cast<int>(data.diskPercentage));
@@ -65,14 +116,86 @@ void MainWindow::onDynamicDataUpdated(const SystemData &data)
     applyStylesheet(m_diskProgressBar, m_diskProgressBar->value());
     m_netDownValueLabel->setText(QString::number(data.netDownSpeed_KBps, 'f', 2) + " KB/s");
     m_netUpValueLabel->setText(QString::number(data.netUpSpeed_KBps, 'f', 2) + " KB/s");
-    updateProcessTable(data.processes);
+    QStringList cpuSensors;
+    if (data.cpuTemperature > 0) cpuSensors << QString("Temperature: %1 °C").arg(data.cpuTemperature, 0, 'f', 0);
+    if (data.cpuFrequencyMHz > 0) cpuSensors << QString("Clock: %1 GHz").arg(data.cpuFrequencyMHz / 1000.0, 0, 'f', 2);
+    m_cpuSensorLabel->setText(cpuSensors.join("    "));
+    m_cpuSensorLabel->setVisible(!cpuSensors.isEmpty());
+    // The cached snapshot has no sample time; the first live sample does.
+    if (m_firstLiveDataMs < 0 && data.sampledAtNs > 0) {
+        static const int firstLiveDataProbe = SelfProfiler::probe("startup.firstLiveData");
+        m_firstLiveDataMs = recordSinceLaunch(firstLiveDataProbe);
+        showStartupTimes();
+    }
+    m_lastData = data;
+    refreshCurrentTab();
 }
 
 void MainWindow::onStaticDataReady(const SystemData &data)
 {
-    m_hostnameValueLabel->setText(data.hostname);
-    m_kernelValueLabel->setText(data.kernelVersion);
-    m_cpuModelValueLabel->setText(data.cpuModel);
+    m_staticData = data;
+    showStaticData();
+}
+
+void MainWindow::showStaticData()
+{
+    if (!m_hostnameValueLabel) return;
+    m_hostnameValueLabel->setText(m_staticData.hostname);
+    m_kernelValueLabel->setText(m_staticData.kernelVersion);
+    m_cpuModelValueLabel->setText(m_staticData.cpuModel);
+    // The cached snapshot does not carry the topology.
+    QString topology = "-";
+    if (m_staticData.logicalCpus > 0) topology = QString("%1 logical, %2 physical").arg(m_staticData.logicalCpus).arg(m_staticData.physicalCores);
+    if (m_staticData.cpuMaxMHz > 0) topology += QString(", up to %1 GHz").arg(m_staticData.cpuMaxMHz / 1000.0, 0, 'f', 2);
+    m_cpuTopologyValueLabel->setText(topology);
+}
+
+// Paints the last session's sample until the monitor's first tick replaces it.
+void MainWindow::showCachedSnapshot()
+{
+    PROFILE_SCOPE("ui.cachedSnapshot");
+    SystemData snapshot;
+    QDateTime savedAt;
+    if (!SnapshotCache::load(SnapshotCache::defaultPath(), &snapshot, &savedAt)) return;
+    if (snapshot.hostname != QSysInfo::machineHostName()) return; // a cache directory shared between hosts
+    onStaticDataReady(snapshot);
+    onDynamicDataUpdated(snapshot);
+    statusBar()->showMessage(QString("Showing data from %1 until the first live sample").arg(savedAt.toString("yyyy-MM-dd hh:mm:ss")));
+}
+
+// Milliseconds since launch, also recorded under `probe` for the Diagnostics tab.
+qint64 MainWindow::recordSinceLaunch(int probe)
+{
+    const qint64 now = SelfProfiler::now();
+    SelfProfiler::record(probe, m_launchNs, now);
+    return (now - m_launchNs) / 1000000;
+}
+
+void MainWindow::showStartupTimes()
+{
+    if (m_firstFrameMs < 0 || m_firstLiveDataMs < 0) return;
+    statusBar()->showMessage(QString("Started in %1 ms, live data after %2 ms").arg(m_firstFrameMs).arg(m_firstLiveDataMs), 10000);
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_tabWidget && event->type() == QEvent::Paint && m_firstFrameMs < 0) {
+        static const int firstFrameProbe = SelfProfiler::probe("startup.firstFrame");
+        m_tabWidget->removeEventFilter(this);
+        m_firstFrameMs = recordSinceLaunch(firstFrameProbe);
+        showStartupTimes();
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::onAlertsRaised(const QList<MonitorAlert> &alerts)
+{
+    for (const MonitorAlert &alert : alerts) {
+        QString time = QDateTime::fromMSecsSinceEpoch(alert.timestampMs).toString("hh:mm:ss");
+        m_alertList->insertItem(0, QString("[%1] %2").arg(time, alert.message));
+    }
+    while (m_alertList->count() > 200) delete m_alertList->takeItem(m_alertList->count() - 1);
+    statusBar()->showMessage(alerts.last().message, 10000);
 }
 
 void MainWindow::onProcessSelectionChanged()
@@ -82,6 +205,51 @@ void MainWindow::onProcessSelectionChanged()
     m_stopButton->setEnabled(hasSelection);
     m_resumeButton->setEnabled(hasSelection);
     m_explainButton->setEnabled(hasSelection);
+    updateVisibleDetails();
+    updateThreadWatch();
+}
+
+// Samples threads only while the panel is actually on screen.
+void MainWindow::updateThreadWatch()
+{
+    const int pid = m_threadGroup && m_threadGroup->isVisible() ? qMax(getSelectedPid(), 0) : 0;
+    if (pid == m_watchedThreadPid) return;
+    m_watchedThreadPid = pid;
+    m_threadTable->setRowCount(0);
+    m_threadGroup->setTitle(pid > 0 ? QString("Threads of PID %1").arg(pid) : QString("Threads"));
+    emit threadWatchRequested(pid);
+}
+
+void MainWindow::onThreadsSampled(int pid, const QList<ThreadData> &threads)
+{
+    if (pid != m_watchedThreadPid) return; // a sample queued before the selection changed
+    PROFILE_SCOPE("ui.threadTable");
+    if (threads.isEmpty()) {
+        m_threadGroup->setTitle(QString("Threads of PID %1 (exited)").arg(pid));
+        m_threadTable->setRowCount(0);
+        return;
+    }
+    m_threadGroup->setTitle(QString("Threads of PID %1 (%2)").arg(pid).arg(threads.size()));
+    // Numeric cells hold numbers so sorting by them is numeric.
+    auto cell = [this](int row, int column) {
+        QTableWidgetItem *item = m_threadTable->item(row, column);
+        if (!item) {
+            item = new QTableWidgetItem();
+            m_threadTable->setItem(row, column, item);
+        }
+        return item;
+    };
+    m_threadTable->setSortingEnabled(false);
+    m_threadTable->setRowCount(threads.size());
+    for (int row = 0; row < threads.size(); ++row) {
+        const ThreadData &thread = threads[row];
+        cell(row, 0)->setData(Qt::DisplayRole, thread.tid);
+        cell(row, 1)->setText(thread.name);
+        cell(row, 2)->setText(QString(QChar(thread.state)));
+        cell(row, 3)->setData(Qt::DisplayRole, qRound(thread.cpuPercentage * 10) / 10.0);
+        cell(row, 4)->setData(Qt::DisplayRole, thread.processor);
+    }
+    m_threadTable->setSortingEnabled(true);
 }
 
 int MainWindow::getSelectedPid()
@@ -90,7 +258,7 @@ int MainWindow::getSelectedPid()
     if (selectedItems.isEmpty()) return -1;
     int row = selectedItems.first()->row();
     if (row >= m_processTableWidget->rowCount()) return -1;
-    return m_processTableWidget->item(row, 0)->text().toInt();
+    return m_processTableWidget->item(row, ProcessPidColumn)->text().toInt();
 }
 
 void MainWindow::onKillClicked()
@@ -113,28 +281,129 @@ void MainWindow::onResumeClicked()
 
 void MainWindow::updateProcessTable(const QList<ProcessData> &processes)
 {
+    PROFILE_SCOPE("ui.processTable");
     m_processTableWidget->setSortingEnabled(false);
     QMap<int, int> currentPids;
     for(int i = 0; i < m_processTableWidget->rowCount(); ++i) {
-        currentPids.insert(m_processTableWidget->item(i, 0)->text().toInt(), i);
+        currentPids.insert(m_processTableWidget->item(i, ProcessPidColumn)->text().toInt(), i);
     }
+    auto stateText = [](char state) { return state ? QString(QChar(state)) : QString("-"); };
+    auto updateText = [this](int row, int column, const QString &text) {
+        QTableWidgetItem *item = m_processTableWidget->item(row, column);
+        if (item->text() != text) item->setText(text);
+    };
     for(const auto &process : processes) {
         if(currentPids.contains(process.pid)) {
             int row = currentPids.value(process.pid);
-            m_processTableWidget->item(row, 2)->setText(QString::number(process.memUsageMB, 'f', 2) + " MB");
+            // An exec or setuid can change name and user under the same pid.
+            updateText(row, ProcessNameColumn, process.name);
+            updateText(row, ProcessUserColumn, process.user);
+            m_processTableWidget->item(row, ProcessStateColumn)->setText(stateText(process.state));
+            m_processTableWidget->item(row, ProcessThreadsColumn)->setData(Qt::DisplayRole, process.threads);
+            m_processTableWidget->item(row, ProcessCpuColumn)->setData(Qt::DisplayRole, qRound(process.cpuPercentage * 10) / 10.0);
+            m_processTableWidget->item(row, ProcessMemoryColumn)->setText(QString::number(process.memUsageMB, 'f', 2) + " MB");
+            setSocketCells(row, process);
+            QTableWidgetItem *commandItem = m_processTableWidget->item(row, ProcessCommandColumn);
+            if (commandItem->text() != process.commandLine) {
+                commandItem->setText(process.commandLine);
+                commandItem->setToolTip(process.commandLine);
+            }
             currentPids.remove(process.pid);
         } else {
             int newRow = m_processTableWidget->rowCount();
             m_processTableWidget->insertRow(newRow);
-            m_processTableWidget->setItem(newRow, 0, new QTableWidgetItem(QString::number(process.pid)));
-            m_processTableWidget->setItem(newRow, 1, new QTableWidgetItem(process.name));
-            m_processTableWidget->setItem(newRow, 2, new QTableWidgetItem(QString::number(process.memUsageMB, 'f', 2) + " MB"));
+            m_processTableWidget->setItem(newRow, ProcessPidColumn, new QTableWidgetItem(QString::number(process.pid)));
+            m_processTableWidget->setItem(newRow, ProcessNameColumn, new QTableWidgetItem(process.name));
+            m_processTableWidget->setItem(newRow, ProcessUserColumn, new QTableWidgetItem(process.user));
+            m_processTableWidget->setItem(newRow, ProcessStateColumn, new QTableWidgetItem(stateText(process.state)));
+            QTableWidgetItem *threadsItem = new QTableWidgetItem();
+            threadsItem->setData(Qt::DisplayRole, process.threads);
+            m_processTableWidget->setItem(newRow, ProcessThreadsColumn, threadsItem);
+            QTableWidgetItem *cpuItem = new QTableWidgetItem();
+            cpuItem->setData(Qt::DisplayRole, qRound(process.cpuPercentage * 10) / 10.0);
+            m_processTableWidget->setItem(newRow, ProcessCpuColumn, cpuItem);
+            m_processTableWidget->setItem(newRow, ProcessMemoryColumn, new QTableWidgetItem(QString::number(process.memUsageMB, 'f', 2) + " MB"));
+            for (int column = ProcessPssColumn; column < ProcessCommandColumn; ++column)
+                m_processTableWidget->setItem(newRow, column, new QTableWidgetItem("-"));
+            setSocketCells(newRow, process);
+            QTableWidgetItem *commandItem = new QTableWidgetItem(process.commandLine);
+            commandItem->setToolTip(process.commandLine);
+            m_processTableWidget->setItem(newRow, ProcessCommandColumn, commandItem);
         }
     }
     QList<int> rowsToRemove = currentPids.values();
     std::sort(rowsToRemove.begin(), rowsToRemove.end(), std::greater<int>());
     for(int row : rowsToRemove) m_processTableWidget->removeRow(row);
     m_processTableWidget->setSortingEnabled(true);
+    updateVisibleDetails();
+}
+
+// Sockets are owned by a few processes; the rest show "-".
+void MainWindow::setSocketCells(int row, const ProcessData &process)
+{
+    auto rate = [](double value) { return QString::number(value, 'f', 1) + " KB/s"; };
+    QTableWidgetItem *connections = m_processTableWidget->item(row, ProcessConnectionsColumn);
+    if (process.sockets == 0) {
+        if (connections->text() == "-") return;
+        for (int column = ProcessConnectionsColumn; column < ProcessCommandColumn; ++column)
+            m_processTableWidget->item(row, column)->setText("-");
+        return;
+    }
+    connections->setData(Qt::DisplayRole, process.connections);
+    connections->setToolTip(QString("%1 sockets open").arg(process.sockets));
+    m_processTableWidget->item(row, ProcessConnectionsColumn + 1)->setText(rate(process.netRxKBps));
+    m_processTableWidget->item(row, ProcessConnectionsColumn + 2)->setText(rate(process.netTxKBps));
+}
+
+// PSS/USS and I/O are only collected for rows on screen or selected.
+void MainWindow::updateVisibleDetails()
+{
+    if (!m_detailCache) return;
+    PROFILE_SCOPE("ui.visibleDetails");
+    const int rowCount = m_processTableWidget->rowCount();
+    QSet<int> rows;
+    if (rowCount > 0) {
+        int first = m_processTableWidget->rowAt(0);
+        int last = m_processTableWidget->rowAt(m_processTableWidget->viewport()->height() - 1);
+        if (first < 0) first = 0;
+        if (last < 0) last = rowCount - 1;
+        for (int row = first; row <= last; ++row) rows.insert(row);
+    }
+    for (const QTableWidgetItem *item : m_processTableWidget->selectedItems()) rows.insert(item->row());
+
+    // Items are collected before any is written: sorting stays on, so a
+    // write to the sort column can move rows under us.
+    struct DetailCells
+    {
+        int pid;
+        QTableWidgetItem *cells[4];
+    };
+    QVector<DetailCells> targets;
+    targets.reserve(rows.size());
+    QSet<int> pids;
+    for (int row : rows) {
+        const int pid = m_processTableWidget->item(row, ProcessPidColumn)->text().toInt();
+        pids.insert(pid);
+        DetailCells target{pid, {}};
+        for (int i = 0; i < 4; ++i) target.cells[i] = m_processTableWidget->item(row, ProcessPssColumn + i);
+        targets.append(target);
+    }
+    auto mb = [](bool valid, double value) { return valid ? QString::number(value, 'f', 2) + " MB" : QString("n/a"); };
+    auto io = [](bool valid, double kbps, quint64 bytes) {
+        if (!valid) return QString("n/a");
+        return QString("%1 KB/s (%2)").arg(kbps, 0, 'f', 1).arg(QLocale::system().formattedDataSize(static_cast<qint64>(bytes)));
+    };
+    for (const DetailCells &target : targets) {
+        ProcessDetail detail;
+        if (!m_detailCache->lookup(target.pid, &detail)) continue;
+        const QString texts[4] = {mb(detail.memoryValid, detail.pssMB), mb(detail.memoryValid, detail.ussMB),
+                                  io(detail.ioValid, detail.readKBps, detail.readBytes),
+                                  io(detail.ioValid, detail.writeKBps, detail.writeBytes)};
+        for (int i = 0; i < 4; ++i) {
+            if (target.cells[i]->text() != texts[i]) target.cells[i]->setText(texts[i]);
+        }
+    }
+    m_detailCache->setWanted(pids);
 }
 
 void MainWindow::applyStylesheet(QProgressBar* bar, int value)
@@ -148,12 +417,82 @@ void MainWindow::setupUi()
 {
     setWindowTitle("Ultimate AI System Monitor");
     resize(700, 600);
-    QTabWidget *tabWidget = new QTabWidget(this);
-    setCentralWidget(tabWidget);
-    tabWidget->addTab(createMonitorTab(), "Live Monitor");
-    tabWidget->addTab(createProcessTab(), "Processes");
-    tabWidget->addTab(createInfoTab(), "System Information");
-    tabWidget->addTab(m_copilot->createAssistantTab(), "Copilot");
+    m_tabWidget = new QTabWidget(this);
+    setCentralWidget(m_tabWidget);
+    m_tabWidget->addTab(createMonitorTab(), "Live Monitor");
+    // Only the first tab is built up front, and only the tab on screen is
+    // refreshed with each sample. The copilot and remote hosts tabs are
+    // eager: both receive content before they are ever shown.
+    m_processPage = addLazyTab("Processes", [this]() { return createProcessTab(); });
+    m_devicesPage = addLazyTab("Devices", [this]() { return createDevicesTab(); });
+    m_cgroupPage = addLazyTab("Cgroups", [this]() { return m_cgroupTree = new CgroupTreeWidget(this); });
+    addLazyTab("System Information", [this]() {
+        QWidget *infoTab = createInfoTab();
+        showStaticData();
+        return infoTab;
+    });
+    m_tabWidget->addTab(m_copilot->createAssistantTab(), "Copilot");
+    m_remoteHosts = new RemoteHostsWidget(this);
+    m_tabWidget->addTab(m_remoteHosts, "Remote Hosts");
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, &MainWindow::onCurrentTabChanged);
+
+    // Hidden unless asked for: Ctrl+Shift+D or SYS_COPILOT_DIAGNOSTICS=1.
+    QShortcut *diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &MainWindow::toggleDiagnosticsTab);
+    if (!qEnvironmentVariableIsEmpty("SYS_COPILOT_DIAGNOSTICS")) toggleDiagnosticsTab();
+}
+
+QWidget* MainWindow::addLazyTab(const QString &title, const std::function<QWidget *()> &create)
+{
+    QWidget *page = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(page);
+    layout->setContentsMargins(0, 0, 0, 0);
+    m_pendingTabs.insert(page, create);
+    m_tabWidget->addTab(page, title);
+    return page;
+}
+
+void MainWindow::onCurrentTabChanged()
+{
+    QWidget *page = m_tabWidget->currentWidget();
+    const auto pending = m_pendingTabs.find(page);
+    if (pending != m_pendingTabs.end()) {
+        PROFILE_SCOPE("ui.buildTab");
+        const std::function<QWidget *()> create = pending.value();
+        m_pendingTabs.erase(pending);
+        page->layout()->addWidget(create());
+    }
+    refreshCurrentTab();
+    updateThreadWatch();
+}
+
+// Tables on hidden tabs are left stale and caught up when shown.
+void MainWindow::refreshCurrentTab()
+{
+    QWidget *page = m_tabWidget->currentWidget();
+    // Rows take user and command line only when inserted, and the cached
+    // snapshot has neither, so the table waits for live data.
+    if (page == m_processPage && m_processTableWidget) {
+        if (m_firstLiveDataMs >= 0) updateProcessTable(m_lastData.processes);
+    }
+    else if (page == m_devicesPage && m_interfaceTable) updateDeviceTables(m_lastData);
+    else if (page == m_cgroupPage && m_cgroupTree) m_cgroupTree->updateCgroups(m_lastData.cgroups);
+}
+
+void MainWindow::toggleDiagnosticsTab()
+{
+    if (!m_diagnostics) {
+        m_diagnostics = new DiagnosticsWidget(this);
+        m_tabWidget->setCurrentIndex(m_tabWidget->addTab(m_diagnostics, "Diagnostics"));
+        return;
+    }
+    const int index = m_tabWidget->indexOf(m_diagnostics);
+    if (index >= 0) {
+        m_tabWidget->removeTab(index);
+        m_diagnostics->hide();
+    } else {
+        m_tabWidget->setCurrentIndex(m_tabWidget->addTab(m_diagnostics, "Diagnostics"));
+    }
 }
 
 QWidget* MainWindow::createProcessTab()
@@ -161,17 +500,48 @@ QWidget* MainWindow::createProcessTab()
     QWidget *processTab = new QWidget();
     QVBoxLayout *layout = new QVBoxLayout(processTab);
     m_processTableWidget = new QTableWidget(this);
-    m_processTableWidget->setColumnCount(3);
-    m_processTableWidget->setHorizontalHeaderLabels({"PID", "Name", "Memory Usage"});
+    m_processTableWidget->setColumnCount(ProcessCommandColumn + 1);
+    m_processTableWidget->setHorizontalHeaderLabels({"PID", "Name", "User", "State", "Threads", "CPU %", "Memory Usage", "PSS", "USS", "Disk Read", "Disk Write", "Connections", "Net Recv", "Net Send", "Command Line"});
     m_processTableWidget->setSortingEnabled(true);
     m_processTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    // Wide enough to tell identical worker binaries apart by their arguments.
+    m_processTableWidget->horizontalHeader()->setStretchLastSection(true);
+    m_processTableWidget->horizontalHeader()->setSectionResizeMode(ProcessCommandColumn, QHeaderView::Interactive);
+    m_processTableWidget->setColumnWidth(ProcessCommandColumn, 320);
     m_processTableWidget->verticalHeader()->setVisible(false);
     m_processTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_processTableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_processTableWidget->setSelectionMode(QAbstractItemView::SingleSelection);
     connect(m_processTableWidget, &QTableWidget::itemSelectionChanged, this, &MainWindow::onProcessSelectionChanged);
-    layout->addWidget(m_processTableWidget);
+    // Scrolling fires once per step; the details follow once it settles.
+    m_detailsTimer = new QTimer(this);
+    m_detailsTimer->setSingleShot(true);
+    m_detailsTimer->setInterval(kDetailsScrollDelayMs);
+    connect(m_detailsTimer, &QTimer::timeout, this, &MainWindow::updateVisibleDetails);
+    connect(m_processTableWidget->verticalScrollBar(), &QScrollBar::valueChanged, m_detailsTimer, qOverload<>(&QTimer::start));
+    layout->addWidget(m_processTableWidget, 3);
+    m_threadGroup = new QGroupBox("Threads", this);
+    QVBoxLayout *threadLayout = new QVBoxLayout(m_threadGroup);
+    m_threadTable = new QTableWidget(0, 5, this);
+    m_threadTable->setHorizontalHeaderLabels({"TID", "Name", "State", "CPU %", "Last CPU"});
+    m_threadTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_threadTable->verticalHeader()->setVisible(false);
+    m_threadTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_threadTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_threadTable->sortByColumn(3, Qt::DescendingOrder);
+    m_threadTable->setSortingEnabled(true);
+    threadLayout->addWidget(m_threadTable);
+    m_threadGroup->hide();
+    layout->addWidget(m_threadGroup, 2);
     QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_threadsButton = new QPushButton("Show Threads", this);
+    m_threadsButton->setCheckable(true);
+    connect(m_threadsButton, &QPushButton::toggled, this, [this](bool checked) {
+        m_threadGroup->setVisible(checked);
+        m_threadsButton->setText(checked ? "Hide Threads" : "Show Threads");
+        updateThreadWatch();
+    });
+    buttonLayout->addWidget(m_threadsButton);
     m_explainButton = new QPushButton("Explain Process (AI)", this);
     m_resumeButton = new QPushButton("Resume Process", this);
     m_stopButton = new QPushButton("Stop Process", this);
@@ -193,6 +563,78 @@ QWidget* MainWindow::createProcessTab()
     return processTab;
 }
 
+QWidget* MainWindow::createDevicesTab()
+{
+    QWidget *devicesTab = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(devicesTab);
+    auto addTable = [this, layout](const QString &title, const QStringList &headers) {
+        QGroupBox *group = new QGroupBox(title, this);
+        QVBoxLayout *groupLayout = new QVBoxLayout(group);
+        QTableWidget *table = new QTableWidget(0, headers.size(), this);
+        table->setHorizontalHeaderLabels(headers);
+        table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+        table->verticalHeader()->setVisible(false);
+        table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        groupLayout->addWidget(table);
+        layout->addWidget(group);
+        return table;
+    };
+    m_interfaceTable = addTable("Network Interfaces", {"Interface", "Down", "Up", "RX Packets", "TX Packets", "Errors (RX/TX)", "Drops (RX/TX)"});
+    m_diskTable = addTable("Block Devices", {"Device", "Read IOPS", "Write IOPS", "Read", "Write", "Read Latency", "Write Latency", "Busy"});
+    m_mountTable = addTable("Mount Points", {"Mount Point", "Device", "Type", "Size", "Free", "Used"});
+    m_sensorTable = addTable("Sensors", {"Chip", "Sensor", "Value", "Limit"});
+    return devicesTab;
+}
+
+// Rows are few and stable, so cells are rewritten in place rather than rebuilt.
+void MainWindow::updateDeviceTables(const SystemData &data)
+{
+    auto setRow = [](QTableWidget *table, int row, const QStringList &cells) {
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                table->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    };
+    auto rate = [](double kbps) { return QString::number(kbps, 'f', 1) + " KB/s"; };
+    auto gb = [](quint64 bytes) { return QString::number(bytes / (1024.0 * 1024.0 * 1024.0), 'f', 1) + " GB"; };
+
+    m_interfaceTable->setRowCount(data.interfaces.size());
+    for (int row = 0; row < data.interfaces.size(); ++row) {
+        const NetworkInterfaceData &iface = data.interfaces[row];
+        setRow(m_interfaceTable, row, {iface.name, rate(iface.rxKBps), rate(iface.txKBps),
+                                       QString::number(iface.rxPackets), QString::number(iface.txPackets),
+                                       QString("%1 / %2").arg(iface.rxErrors).arg(iface.txErrors),
+                                       QString("%1 / %2").arg(iface.rxDrops).arg(iface.txDrops)});
+    }
+    m_diskTable->setRowCount(data.disks.size());
+    for (int row = 0; row < data.disks.size(); ++row) {
+        const DiskDeviceData &disk = data.disks[row];
+        setRow(m_diskTable, row, {disk.name, QString::number(disk.readIops, 'f', 1), QString::number(disk.writeIops, 'f', 1),
+                                  rate(disk.readKBps), rate(disk.writeKBps),
+                                  QString::number(disk.readLatencyMs, 'f', 2) + " ms",
+                                  QString::number(disk.writeLatencyMs, 'f', 2) + " ms",
+                                  QString::number(disk.busyPercentage, 'f', 1) + "%"});
+    }
+    m_mountTable->setRowCount(data.mounts.size());
+    for (int row = 0; row < data.mounts.size(); ++row) {
+        const MountData &mount = data.mounts[row];
+        setRow(m_mountTable, row, {mount.mountPoint, mount.device, mount.fsType, gb(mount.totalBytes), gb(mount.freeBytes),
+                                   QString::number(mount.usedPercentage, 'f', 1) + "%"});
+    }
+    m_sensorTable->setRowCount(data.sensors.size());
+    for (int row = 0; row < data.sensors.size(); ++row) {
+        const SensorData &sensor = data.sensors[row];
+        const bool temperature = sensor.kind == SensorData::Temperature;
+        setRow(m_sensorTable, row, {sensor.chip, sensor.label,
+                                    temperature ? QString::number(sensor.value, 'f', 1) + " °C" : QString::number(sensor.value, 'f', 0) + " RPM",
+                                    sensor.critical > 0 ? QString::number(sensor.critical, 'f', 0) + " °C" : QString("-")});
+    }
+}
+
 QWidget* MainWindow::createMonitorTab()
 {
     QWidget *monitorTab = new QWidget();
@@ -202,6 +644,9 @@ QWidget* MainWindow::createMonitorTab()
     m_cpuProgressBar = new QProgressBar(this);
     m_cpuProgressBar->setRange(0, 100); m_cpuProgressBar->setFormat("%p%");
     cpuLayout->addWidget(m_cpuProgressBar);
+    m_cpuSensorLabel = new QLabel(this);
+    m_cpuSensorLabel->hide(); // only on hosts that expose sensors or cpufreq
+    cpuLayout->addWidget(m_cpuSensorLabel);
     mainLayout->addWidget(cpuGroup);
     QGroupBox *memGroup = new QGroupBox("Memory Usage", this);
     QGridLayout *memLayout = new QGridLayout(memGroup);
@@ -224,6 +669,11 @@ QWidget* MainWindow::createMonitorTab()
     m_netUpValueLabel = new QLabel("- KB/s", this);
     netLayout->addWidget(m_netUpValueLabel, 1, 1);
     mainLayout->addWidget(netGroup);
+    QGroupBox *alertGroup = new QGroupBox("Alerts", this);
+    QVBoxLayout *alertLayout = new QVBoxLayout(alertGroup);
+    m_alertList = new QListWidget(this);
+    alertLayout->addWidget(m_alertList);
+    mainLayout->addWidget(alertGroup);
     return monitorTab;
 }
 
@@ -242,7 +692,10 @@ QWidget* MainWindow::createInfoTab()
     m_cpuModelValueLabel = new QLabel("-", this);
     m_cpuModelValueLabel->setWordWrap(true);
     layout->addWidget(m_cpuModelValueLabel, 2, 1);
+    layout->addWidget(new QLabel("CPUs:", this), 3, 0);
+    m_cpuTopologyValueLabel = new QLabel("-", this);
+    layout->addWidget(m_cpuTopologyValueLabel, 3, 1);
     layout->setColumnStretch(1, 1);
-    layout->setRowStretch(3, 1);
+    layout->setRowStretch(4, 1);
     return infoTab;
 }
\ No newline at end of file
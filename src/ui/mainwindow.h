@@ -14,24 +14,35 @@
 #include <QLineEdit>
 #include <QTextEdit>
 #include <QJsonArray>
+#include <QListWidget>
+#include <QHash>
+#include <functional>
 #include "core/systemmonitor.h"
 #include "common/systemdata.h"
 #include "copilot/copilot.h"
+#include "remotehostswidget.h"
+#include "diagnosticswidget.h"
+#include "cgrouptreewidget.h"
 
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const SystemMonitor::CaptureOptions &capture = {}, QWidget *parent = nullptr);
     ~MainWindow();
+    void addRemoteHost(const QString &host, quint16 port);
+    // SelfProfiler::now() at process start; startup times are measured from it.
+    void setLaunchTime(qint64 launchNs) { m_launchNs = launchNs; }
 
 public slots:
     void onDynamicDataUpdated(const SystemData &data);
     void onStaticDataReady(const SystemData &data);
+    void onAlertsRaised(const QList<MonitorAlert> &alerts);
 
 signals:
     void systemDataUpdated(const SystemData &data);
+    void threadWatchRequested(int pid);
 
 private slots:
     void onProcessSelectionChanged();
@@ -39,39 +50,96 @@ private slots:
     void onStopClicked();
     void onResumeClicked();
     void onExplainClicked();
+    void onThreadsSampled(int pid, const QList<ThreadData> &threads);
+    void updateThreadWatch();
+    void onCurrentTabChanged();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
+    enum {
+        ProcessPidColumn = 0, ProcessNameColumn = 1, ProcessUserColumn = 2, ProcessStateColumn = 3, ProcessThreadsColumn = 4,
+        ProcessCpuColumn = 5, ProcessMemoryColumn = 6, ProcessPssColumn = 7, ProcessConnectionsColumn = 11, ProcessCommandColumn = 14
+    };
+
     void setupUi();
     QWidget* createMonitorTab();
     QWidget* createInfoTab();
     QWidget* createProcessTab();
+    QWidget* createDevicesTab();
+    // A placeholder page whose content `create` builds when it is first shown.
+    QWidget* addLazyTab(const QString &title, const std::function<QWidget *()> &create);
+    void refreshCurrentTab();
+    void showStaticData();
+    void showCachedSnapshot();
+    qint64 recordSinceLaunch(int probe);
+    void showStartupTimes();
+    void updateDeviceTables(const SystemData &data);
     void updateProcessTable(const QList<ProcessData> &processes);
+    void updateVisibleDetails();
+    void setSocketCells(int row, const ProcessData &process);
+    void toggleDiagnosticsTab();
     void applyStylesheet(QProgressBar* bar, int value);
     int getSelectedPid();
 
     SystemMonitor *m_monitor;
+    ProcessDetailCache *m_detailCache = nullptr;
     QThread *m_monitorThread;
     Copilot *m_copilot;
+    QTabWidget *m_tabWidget;
+    DiagnosticsWidget *m_diagnostics = nullptr;
+    QHash<QWidget *, std::function<QWidget *()>> m_pendingTabs;
+    QWidget *m_processPage = nullptr;
+    QWidget *m_devicesPage = nullptr;
+    QWidget *m_cgroupPage = nullptr;
+    SystemData m_staticData;
+    SystemData m_lastData;
+    // Set unless replaying, so the next launch has something to show.
+    bool m_saveSnapshot = false;
+    qint64 m_launchNs = 0;
+    qint64 m_firstFrameMs = -1;
+    qint64 m_firstLiveDataMs = -1;
 
     // --- Widgets ---
     // Monitor Tab
     QProgressBar *m_cpuProgressBar;
+    QLabel *m_cpuSensorLabel;
     QProgressBar *m_memProgressBar;
     QProgressBar *m_diskProgressBar;
     QLabel *m_netDownValueLabel;
     QLabel *m_netUpValueLabel;
+    QListWidget *m_alertList;
+
+    // Devices Tab (null until first shown, like the cgroup, info and process tabs)
+    QTableWidget *m_interfaceTable = nullptr;
+    QTableWidget *m_diskTable = nullptr;
+    QTableWidget *m_mountTable = nullptr;
+    QTableWidget *m_sensorTable = nullptr;
+
+    // Cgroups Tab
+    CgroupTreeWidget *m_cgroupTree = nullptr;
 
     // Info Tab
-    QLabel *m_hostnameValueLabel;
-    QLabel *m_kernelValueLabel;
-    QLabel *m_cpuModelValueLabel;
+    QLabel *m_hostnameValueLabel = nullptr;
+    QLabel *m_kernelValueLabel = nullptr;
+    QLabel *m_cpuModelValueLabel = nullptr;
+    QLabel *m_cpuTopologyValueLabel = nullptr;
 
     // Process Tab
-    QTableWidget *m_processTableWidget;
-    QPushButton *m_killButton;
-    QPushButton *m_stopButton;
-    QPushButton *m_resumeButton;
-    QPushButton *m_explainButton;
+    QTableWidget *m_processTableWidget = nullptr;
+    QPushButton *m_killButton = nullptr;
+    QPushButton *m_stopButton = nullptr;
+    QPushButton *m_resumeButton = nullptr;
+    QPushButton *m_explainButton = nullptr;
+    QPushButton *m_threadsButton = nullptr;
+    QGroupBox *m_threadGroup = nullptr;
+    QTableWidget *m_threadTable = nullptr;
+    QTimer *m_detailsTimer = nullptr;
+    int m_watchedThreadPid = 0;
+
+    // Remote Hosts Tab
+    RemoteHostsWidget *m_remoteHosts;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,183 @@
+#include "remotehostswidget.h"
+#include <QVBoxLayout>
+#include <QGridLayout>
+#include <QPushButton>
+#include <QScrollArea>
+#include <QHeaderView>
+
+RemoteHostPanel::RemoteHostPanel(const QString &host, quint16 port, QWidget *parent)
+    : QGroupBox(QString("%1:%2").arg(host).arg(port), parent),
+      m_host(host),
+      m_port(port),
+      m_socket(new QTcpSocket(this)),
+      m_reconnectTimer(new QTimer(this))
+{
+    setMinimumWidth(280);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    QHBoxLayout *header = new QHBoxLayout();
+    m_statusLabel = new QLabel("Connecting...", this);
+    QPushButton *closeButton = new QPushButton("Remove", this);
+    header->addWidget(m_statusLabel, 1);
+    header->addWidget(closeButton);
+    layout->addLayout(header);
+
+    QGridLayout *grid = new QGridLayout();
+    auto addBar = [this, grid](const QString &label, int row) {
+        QProgressBar *bar = new QProgressBar(this);
+        bar->setRange(0, 100);
+        bar->setFormat("%p%");
+        grid->addWidget(new QLabel(label, this), row, 0);
+        grid->addWidget(bar, row, 1);
+        return bar;
+    };
+    m_cpuBar = addBar("CPU", 0);
+    m_memBar = addBar("Memory", 1);
+    m_diskBar = addBar("Disk", 2);
+    grid->addWidget(new QLabel("Network", this), 3, 0);
+    m_netLabel = new QLabel("-", this);
+    grid->addWidget(m_netLabel, 3, 1);
+    layout->addLayout(grid);
+
+    m_topTable = new QTableWidget(0, 3, this);
+    m_topTable->setHorizontalHeaderLabels({"PID", "Name", "Memory"});
+    m_topTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_topTable->verticalHeader()->setVisible(false);
+    m_topTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    layout->addWidget(m_topTable);
+
+    m_reconnectTimer->setSingleShot(true);
+    m_reconnectTimer->setInterval(3000);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &RemoteHostPanel::reconnect);
+    connect(m_socket, &QTcpSocket::connected, this, &RemoteHostPanel::onConnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &RemoteHostPanel::onReadyRead);
+    connect(m_socket, &QTcpSocket::disconnected, this, &RemoteHostPanel::onDisconnected);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, [this]() {
+        setStatus("Error: " + m_socket->errorString());
+        if (m_socket->state() == QAbstractSocket::UnconnectedState) m_reconnectTimer->start();
+    });
+    connect(closeButton, &QPushButton::clicked, this, [this]() { emit removeRequested(this); });
+
+    reconnect();
+}
+
+void RemoteHostPanel::reconnect()
+{
+    m_decoder.reset();
+    m_socket->abort();
+    m_socket->connectToHost(m_host, m_port);
+}
+
+void RemoteHostPanel::onConnected()
+{
+    setStatus("Connected");
+}
+
+void RemoteHostPanel::onDisconnected()
+{
+    setStatus("Disconnected");
+    m_reconnectTimer->start();
+}
+
+void RemoteHostPanel::setStatus(const QString &status)
+{
+    m_statusLabel->setText(status);
+}
+
+void RemoteHostPanel::onReadyRead()
+{
+    const QByteArray bytes = m_socket->readAll();
+    m_bytesSinceSample += bytes.size();
+    m_decoder.append(bytes);
+
+    bool haveSample = false;
+    for (;;) {
+        const WireDecoder::Result result = m_decoder.next();
+        if (result == WireDecoder::NeedMoreData) break;
+        if (result == WireDecoder::ProtocolError) {
+            setStatus("Protocol error: " + m_decoder.errorString());
+            m_socket->abort();
+            m_reconnectTimer->start();
+            return;
+        }
+        if (result == WireDecoder::HelloFrame) {
+            const SystemData &data = m_decoder.data();
+            setTitle(QString("%1 (%2:%3)").arg(data.hostname, m_host).arg(m_port));
+            setToolTip(data.cpuModel + "\n" + data.kernelVersion);
+        } else {
+            haveSample = true;
+        }
+    }
+    if (haveSample) {
+        showSample(m_decoder.data());
+        setStatus(QString("Connected - %1 B last update").arg(m_bytesSinceSample));
+        m_bytesSinceSample = 0;
+    }
+}
+
+void RemoteHostPanel::showSample(const SystemData &data)
+{
+    m_cpuBar->setValue(static_cast<int>(data.cpuPercentage));
+    m_memBar->setValue(static_cast<int>(data.memPercentage));
+    m_diskBar->setValue(static_cast<int>(data.diskPercentage));
+    m_netLabel->setText(QString("%1 KB/s down, %2 KB/s up").arg(data.netDownSpeed_KBps, 0, 'f', 1).arg(data.netUpSpeed_KBps, 0, 'f', 1));
+
+    const QVector<ProcessRanking::Entry> top = data.ranking.top(ProcessRanking::Memory, 10);
+    m_topTable->setRowCount(top.size());
+    for (int row = 0; row < top.size(); ++row) {
+        const ProcessData *process = ProcessRanking::find(data.processes, top[row].pid);
+        if (!process) continue;
+        const QStringList cells = {QString::number(process->pid), process->name, QString::number(process->memUsageMB, 'f', 1) + " MB"};
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = m_topTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_topTable->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+}
+
+RemoteHostsWidget::RemoteHostsWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    QHBoxLayout *inputLayout = new QHBoxLayout();
+    m_hostInput = new QLineEdit(this);
+    m_hostInput->setPlaceholderText(QString("host[:port], ... (default port %1)").arg(Wire::DefaultPort));
+    QPushButton *addButton = new QPushButton("Add Host", this);
+    inputLayout->addWidget(m_hostInput);
+    inputLayout->addWidget(addButton);
+    layout->addLayout(inputLayout);
+    connect(addButton, &QPushButton::clicked, this, &RemoteHostsWidget::onAddClicked);
+    connect(m_hostInput, &QLineEdit::returnPressed, this, &RemoteHostsWidget::onAddClicked);
+
+    QScrollArea *scrollArea = new QScrollArea(this);
+    scrollArea->setWidgetResizable(true);
+    QWidget *panels = new QWidget(scrollArea);
+    m_panelLayout = new QHBoxLayout(panels);
+    m_panelLayout->addStretch();
+    scrollArea->setWidget(panels);
+    layout->addWidget(scrollArea);
+}
+
+void RemoteHostsWidget::addHost(const QString &host, quint16 port)
+{
+    RemoteHostPanel *panel = new RemoteHostPanel(host, port, this);
+    connect(panel, &RemoteHostPanel::removeRequested, this, [](RemoteHostPanel *p) { p->deleteLater(); });
+    m_panelLayout->insertWidget(m_panelLayout->count() - 1, panel);
+}
+
+void RemoteHostsWidget::onAddClicked()
+{
+    const QStringList entries = m_hostInput->text().split(',', Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        const QString trimmed = entry.trimmed();
+        const int colon = trimmed.lastIndexOf(':');
+        bool ok = true;
+        const quint16 port = colon > 0 ? trimmed.mid(colon + 1).toUShort(&ok) : Wire::DefaultPort;
+        if (!ok || trimmed.isEmpty()) continue;
+        addHost(colon > 0 ? trimmed.left(colon) : trimmed, port);
+    }
+    m_hostInput->clear();
+}
@@ -0,0 +1,70 @@
+#ifndef REMOTEHOSTSWIDGET_H
+#define REMOTEHOSTSWIDGET_H
+
+#include <QWidget>
+#include <QGroupBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QTableWidget>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHBoxLayout>
+#include "common/wireprotocol.h"
+
+// One subscribed agent: keeps its own socket and decoder and reconnects on
+// failure.
+class RemoteHostPanel : public QGroupBox
+{
+    Q_OBJECT
+
+public:
+    RemoteHostPanel(const QString &host, quint16 port, QWidget *parent = nullptr);
+
+signals:
+    void removeRequested(RemoteHostPanel *panel);
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+    void reconnect();
+
+private:
+    void showSample(const SystemData &data);
+    void setStatus(const QString &status);
+
+    QString m_host;
+    quint16 m_port;
+    QTcpSocket *m_socket;
+    QTimer *m_reconnectTimer;
+    WireDecoder m_decoder;
+    qint64 m_bytesSinceSample = 0;
+
+    QLabel *m_statusLabel;
+    QProgressBar *m_cpuBar;
+    QProgressBar *m_memBar;
+    QProgressBar *m_diskBar;
+    QLabel *m_netLabel;
+    QTableWidget *m_topTable;
+};
+
+// Side-by-side view of any number of remote agents.
+class RemoteHostsWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit RemoteHostsWidget(QWidget *parent = nullptr);
+    void addHost(const QString &host, quint16 port);
+
+private slots:
+    void onAddClicked();
+
+private:
+    QLineEdit *m_hostInput;
+    QHBoxLayout *m_panelLayout;
+};
+
+#endif // REMOTEHOSTSWIDGET_H